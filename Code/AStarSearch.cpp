@@ -0,0 +1,193 @@
+//
+//  AStarSearch.cpp
+//  TraffikTrak
+//
+//  Created by Matt Lovick on 2026-10-19.
+//  Copyright © 2026 Matt Lovick. All rights reserved.
+//
+
+#include <vector>
+#include <unordered_map>
+#include <utility>
+#include <algorithm>
+#include <cmath>
+#include "AStarSearch.hpp"
+#include "Intersection.hpp"
+#include "IntersectionID.h"
+#include "RoadGraph.hpp"
+
+using namespace std;
+using namespace traffictrack;
+
+
+/** @class HospitalGrid
+ *  @brief the hospitals sorted into square cells, so the nearest one to a point is found by looking at the cells around
+ *      it instead of at every hospital
+ */
+class HospitalGrid {
+
+    float minX_;
+    float minY_;
+    float cell_;
+    int columns_;
+    int rows_;
+    vector<int> cellStart_; /**< index in positions_ of the first hospital of each cell, one more entry at the end */
+    vector<pair<float, float>> positions_;
+
+    int column(float x) const {
+        return static_cast<int>(min(max((x - minX_) / cell_, 0.0f), static_cast<float>(columns_ - 1)));
+    }
+
+    int row(float y) const {
+        return static_cast<int>(min(max((y - minY_) / cell_, 0.0f), static_cast<float>(rows_ - 1)));
+    }
+
+public:
+
+    /**
+     *  \brief sorts the hospitals into cells holding about one hospital each
+     */
+    HospitalGrid(const vector<pair<float, float>>& hospitals) {
+
+        float maxX = hospitals[0].first;
+        float maxY = hospitals[0].second;
+        minX_ = maxX;
+        minY_ = maxY;
+        for (const pair<float, float>& h : hospitals) {
+            minX_ = min(minX_, h.first);
+            minY_ = min(minY_, h.second);
+            maxX = max(maxX, h.first);
+            maxY = max(maxY, h.second);
+        }
+
+        //about as many cells as hospitals, a row of hospitals gets a row of cells
+        float width = maxX - minX_;
+        float height = maxY - minY_;
+        const float count = static_cast<float>(hospitals.size());
+        cell_ = width > 0 && height > 0 ? sqrt(width * height / count) : max(width, height) / count;
+        if (!(cell_ > 0)) {
+            cell_ = 1;
+        }
+        columns_ = static_cast<int>(min(width / cell_ + 1, count));
+        rows_ = static_cast<int>(min(height / cell_ + 1, count));
+
+        cellStart_.assign(columns_ * rows_ + 1, 0);
+        for (const pair<float, float>& h : hospitals) {
+            cellStart_[row(h.second) * columns_ + column(h.first) + 1]++;
+        }
+        for (size_t c = 1; c < cellStart_.size(); c++) {
+            cellStart_[c] += cellStart_[c - 1];
+        }
+        vector<int> next(cellStart_.begin(), cellStart_.end() - 1);
+        positions_.resize(hospitals.size());
+        for (const pair<float, float>& h : hospitals) {
+            positions_[next[row(h.second) * columns_ + column(h.first)]++] = h;
+        }
+
+    }
+
+    /**
+     *  \brief straight-line distance from a point to the nearest hospital
+     *
+     *  the cells are visited in rings around the point's cell. every hospital outside ring r is at least r cells away,
+     *  so the search stops once the nearest hospital found is closer than that
+     */
+    float nearest(pair<float, float> point) const {
+
+        const int x = column(point.first);
+        const int y = row(point.second);
+        const int rings = max(columns_, rows_);
+        float best = -1;
+
+        for (int r = 0; r < rings; r++) {
+
+            for (int cy = max(y - r, 0); cy <= min(y + r, rows_ - 1); cy++) {
+                //the rows in between only have the two cells at the ends of the ring
+                const int step = (cy == y - r || cy == y + r) ? 1 : 2 * r;
+                for (int cx = x - r; cx <= x + r; cx += step) {
+                    if (cx < 0 || cx >= columns_) {
+                        continue;
+                    }
+                    const int c = cy * columns_ + cx;
+                    for (int h = cellStart_[c]; h < cellStart_[c + 1]; h++) {
+                        float straight = hypot(positions_[h].first - point.first, positions_[h].second - point.second);
+                        if (best < 0 || straight < best) {
+                            best = straight;
+                        }
+                    }
+                }
+            }
+
+            if (best >= 0 && best <= r * cell_) {
+                break;
+            }
+
+        }
+        return best;
+
+    }
+
+};
+
+
+/** @fn ~AStarSearch()
+ *  @brief destructor that does nothing
+ */
+AStarSearch::~AStarSearch() { }
+
+
+/** @fn prepare(std::unordered_map<traffictrack::IntersectionID, Intersection*>& intersections)
+ *  @brief takes the snapshot of the map and works out the estimate of every intersection
+ *  @param intersections the map
+ */
+void AStarSearch::prepare(std::unordered_map<traffictrack::IntersectionID, Intersection*>& intersections) {
+    
+    UniformCostSearch::prepare(intersections);
+    estimates_.clear();
+    
+    const int size = graph_.size();
+    vector<pair<float, float>> positions(size);
+    vector<pair<float, float>> hospitals;
+    
+    for (int i = 0; i < size; i++) {
+        if (!graph_.intersection(i)->located()) {
+            return;
+        }
+        positions[i] = graph_.intersection(i)->position();
+        if (graph_.hospital(i)) {
+            hospitals.push_back(positions[i]);
+        }
+    }
+    
+    //the fastest any road gets closer to where it is going, a road of length 0 between two places allows no estimate at all
+    float speed = 0;
+    for (int i = 0; i < size; i++) {
+        for (int road = graph_.firstRoad(i); road < graph_.endRoad(i); road++) {
+            
+            pair<float, float> to = positions[graph_.target(road)];
+            float straight = hypot(to.first - positions[i].first, to.second - positions[i].second);
+            
+            if (graph_.length(road) > 0) {
+                speed = max(speed, straight / graph_.length(road));
+            }
+            else if (straight > 0) {
+                return;
+            }
+            
+        }
+    }
+    
+    if (speed <= 0 || hospitals.empty()) {
+        return;
+    }
+    
+    //a little under the bound, so rounding in the sums cannot make an estimate more than the real distance
+    const float scale = 0.999f / speed;
+    estimates_.resize(size);
+    
+    HospitalGrid grid(hospitals);
+    for (int i = 0; i < size; i++) {
+        estimates_[i] = grid.nearest(positions[i]) * scale;
+    }
+    
+}
@@ -0,0 +1,38 @@
+//
+//  AStarSearch.hpp
+//  TraffikTrak
+//
+//  Created by Matt Lovick on 2026-10-19.
+//  Copyright © 2026 Matt Lovick. All rights reserved.
+//
+
+#ifndef AStarSearch_hpp
+#define AStarSearch_hpp
+
+#include <vector>
+#include <unordered_map>
+#include "Intersection.hpp"
+#include "IntersectionID.h"
+#include "UniformCostSearch.hpp"
+
+
+/** @class AStarSearch
+ *  @brief implements the AbstractPathFinder with an A* search towards the nearest hospital, using the positions of the
+ *      intersections from the map file
+ *
+ *  the estimate for an intersection is the straight-line distance to the nearest hospital divided by the highest "speed"
+ *  of any road, its straight-line length over its length. no road covers ground faster than that, so the estimate is
+ *  never more than the real distance and the search still finds the nearest hospital. the nearest hospital to each
+ *  intersection is looked up in a grid of the hospitals, so preparing does not compare every pair. if an intersection
+ *  has no position the estimates are left out and it is a plain uniform cost search
+ *  @author Matthew Lovick
+ */
+class AStarSearch : public UniformCostSearch {
+    
+public:
+    virtual ~AStarSearch();
+    virtual void prepare(std::unordered_map<traffictrack::IntersectionID, Intersection*>& intersections);
+    
+};
+
+#endif /* AStarSearch_hpp */
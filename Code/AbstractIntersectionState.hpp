@@ -15,6 +15,9 @@ class Intersection;
 
 /** @class AbstractIntersectionState
  *  @brief abstract class for IntersectionState class which will have interval times and the ability to change lights based on a calculated traffic ratio
+ *
+ *  a change of the lights takes two steps that return right away: beginChange() turns the green lights yellow and
+ *  finishChange() turns them red and the others green, the caller waits GreenLight::yellowTime() between them on a timer
  *  @author Matthew Lovick
  */
 class AbstractIntersectionState {
@@ -26,7 +29,8 @@ public:
     AbstractIntersectionState(std::chrono::seconds intervalTime);
     virtual ~AbstractIntersectionState();
     virtual std::chrono::seconds intervalTime() const;
-    virtual void changeLights(Intersection* intersection) = 0;
+    virtual void beginChange(Intersection* intersection) = 0;
+    virtual void finishChange(Intersection* intersection) = 0;
     virtual float trafficRatio(int northSouthTraffic, int eastWestTraffic) = 0;
     
 };
@@ -0,0 +1,177 @@
+//
+//  AbstractMapFileParser.cpp
+//  TraffikTrak
+//
+//  Created by Matt Lovick on 2026-10-19.
+//  Copyright © 2026 Matt Lovick. All rights reserved.
+//
+
+#include <string>
+#include <cstring>
+#include <unordered_map>
+#include <cctype>
+#include "AbstractMapFileParser.hpp"
+#include "MapFileReader.hpp"
+#include "FormatException.hpp"
+#include "IntersectionID.h"
+#include "Intersection.hpp"
+#include "Direction.h"
+
+using namespace std;
+using namespace traffictrack;
+
+
+/** @fn sectionName(MapFileReader& reader)
+ *  @brief the name of the section the current line starts, case is ignored. the line is read again from its start after
+ *  @param reader the map file
+ *  @return const char* "coordinates" or "hospitals", nullptr if the line does not start a section
+ */
+static const char* sectionName(MapFileReader& reader) {
+    
+    static const char* names[] = { "coordinates", "hospitals" };
+    
+    const char* word = nullptr;
+    size_t length = 0;
+    const char* name = nullptr;
+    
+    if (reader.readWord(word, length) && reader.blank()) {
+        for (const char* candidate : names) {
+            if (length == strlen(candidate)) {
+                size_t i = 0;
+                while (i < length && tolower(static_cast<unsigned char>(word[i])) == candidate[i]) {
+                    i++;
+                }
+                name = i == length ? candidate : name;
+            }
+        }
+    }
+    
+    reader.rewindLine();
+    return name;
+    
+}
+
+
+/** @fn sectionHeader(MapFileReader& reader)
+ *  @brief whether the current line starts one of the sections after the roads
+ *  @param reader the map file
+ *  @return bool
+ */
+bool AbstractMapFileParser::sectionHeader(MapFileReader& reader) {
+    return sectionName(reader) != nullptr;
+}
+
+
+/** @fn parseRoads(MapFileReader& reader, std::unordered_map<traffictrack::IntersectionID, Intersection*>& intersections)
+ *  @brief reads the rest of the map file as "first second distance direction" road lines, each adding the road both ways,
+ *      and then the sections. only the first letter of the direction counts and blank lines are skipped
+ *  @param reader the map file, on the line before the first road
+ *  @param intersections the intersections the roads join
+ */
+void AbstractMapFileParser::parseRoads(MapFileReader& reader, std::unordered_map<traffictrack::IntersectionID, Intersection*>& intersections) {
+    
+    int first = -1, second = -1;
+    float distance = -1;
+    const char* word = nullptr;
+    size_t length = 0;
+    Direction direction = Direction::DEFAULT;
+    
+    while (reader.nextLine()) {
+        
+        if (reader.blank()) {
+            continue;
+        }
+        
+        //the roads can be followed by the positions of the intersections, which AStarSearch uses, and the hospitals
+        if (sectionHeader(reader)) {
+            parseSections(reader, intersections);
+            break;
+        }
+        
+        if (!reader.readInt(first) || !reader.readInt(second) || !reader.readFloat(distance) || !reader.readWord(word, length)) {
+            throw FormatException("improper file format in " + reader.where());
+        }
+        
+        switch (tolower(static_cast<unsigned char>(word[0]))) {
+            case 'n':
+                direction = Direction::NORTH;
+                break;
+            case 'e':
+                direction = Direction::EAST;
+                break;
+            case 's':
+                direction = Direction::SOUTH;
+                break;
+            case 'w':
+                direction = Direction::WEST;
+                break;
+            default:
+                direction = Direction::DEFAULT;
+        }
+        
+        auto from = intersections.find(IntersectionID(first));
+        auto to = intersections.find(IntersectionID(second));
+        
+        if (from == intersections.end() || to == intersections.end() || distance < 0 || direction == Direction::DEFAULT) {
+            throw FormatException("improper file format in " + reader.where());
+        }
+        
+        from->second->addRoad(from->second, to->second, distance, direction);
+        to->second->addRoad(to->second, from->second, distance, static_cast<Direction>((direction + 2) % 4));
+        
+    }
+    
+}
+
+
+/** @fn parseSections(MapFileReader& reader, std::unordered_map<traffictrack::IntersectionID, Intersection*>& intersections)
+ *  @brief reads the rest of the map file as sections: "ID x y" lines set the position of each intersection, "ID" lines
+ *      mark the hospitals. blank lines are skipped
+ *  @param reader the map file, on the line that starts the first section
+ *  @param intersections the intersections read before the sections
+ */
+void AbstractMapFileParser::parseSections(MapFileReader& reader, std::unordered_map<traffictrack::IntersectionID, Intersection*>& intersections) {
+    
+    const char* section = sectionName(reader);
+    bool hospitalsListed = false;
+    
+    int ID = -1;
+    float x = 0, y = 0;
+    
+    do {
+        
+        const char* name = sectionName(reader);
+        if (name != nullptr) {
+            section = name;
+        }
+        
+        //the listed hospitals are the only ones, the parsers made the first intersection one
+        if (strcmp(section, "hospitals") == 0 && !hospitalsListed) {
+            for (auto it = intersections.begin(); it != intersections.end(); ++it) {
+                it->second->setHospital(false);
+            }
+            hospitalsListed = true;
+        }
+        
+        if (name != nullptr || reader.blank()) {
+            continue;
+        }
+        
+        if (strcmp(section, "coordinates") == 0) {
+            auto it = intersections.end();
+            if (!reader.readInt(ID) || !reader.readFloat(x) || !reader.readFloat(y) || !reader.blank() || (it = intersections.find(IntersectionID(ID))) == intersections.end()) {
+                throw FormatException("improper coordinates in " + reader.where());
+            }
+            it->second->setPosition(x, y);
+        }
+        else {
+            auto it = intersections.end();
+            if (!reader.readInt(ID) || !reader.blank() || (it = intersections.find(IntersectionID(ID))) == intersections.end()) {
+                throw FormatException("improper hospitals in " + reader.where());
+            }
+            it->second->setHospital(true);
+        }
+        
+    } while (reader.nextLine());
+    
+}
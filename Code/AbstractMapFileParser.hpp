@@ -14,15 +14,34 @@
 #include "IntersectionID.h"
 
 class Intersection;
+class MapFileReader;
 
 
 /** @class AbstractMapFileParser
  *  @brief abstract class for a parser that will read from a file and generate intersections and roads from it
  *          each concrete parser would support different file formats to convey different information
+ *
+ *  the roads of every format can be followed by optional sections, each starting with a line that only has its name. the
+ *  "coordinates" section has one line per intersection with its ID and its x and y position, in the same unit as the road
+ *  lengths. the "hospitals" section has one line per hospital with its ID, and replaces the default of the first
+ *  intersection being the only hospital:
+ *
+ *      coordinates
+ *      0 0 0
+ *      1 10 0
+ *      hospitals
+ *      1
+ *
+ *  the concrete parsers read their files with a MapFileReader, and every FormatException names the line it is about
  *  @author Matthew Lovick
  */
 class AbstractMapFileParser {
     
+protected:
+    static bool sectionHeader(MapFileReader& reader);
+    static void parseRoads(MapFileReader& reader, std::unordered_map<traffictrack::IntersectionID, Intersection*>& intersections);
+    static void parseSections(MapFileReader& reader, std::unordered_map<traffictrack::IntersectionID, Intersection*>& intersections);
+    
 public:
     virtual ~AbstractMapFileParser() { };
     virtual void parse(const std::string filename, std::unordered_map<traffictrack::IntersectionID, Intersection*>& intersections) const = 0;
@@ -12,8 +12,10 @@
 #include <vector>
 #include <unordered_map>
 #include <utility>
+#include <cstddef>
 #include "Intersection.hpp"
 #include "IntersectionID.h"
+#include "DateScorePair.hpp"
 
 /** @class AbstractPathFinder
  *  @brief find shortest path based on start state and the intersections along the way
@@ -25,6 +27,36 @@ public:
     virtual ~AbstractPathFinder() { };
     virtual std::pair<std::vector<Intersection*>, float> search(Intersection* startState, std::unordered_map<traffictrack::IntersectionID, Intersection*>& intersections) = 0;
     
+    /**
+     *  \brief routes from every start and returns the paths in the same order, the map must not change meanwhile. path
+     *      finders that can search from several threads at once spread the starts over the shared TaskPool, by default
+     *      the starts are searched one after the other
+     */
+    virtual std::vector<std::pair<std::vector<Intersection*>, float>> searchBatch(const std::vector<Intersection*>& starts, std::unordered_map<traffictrack::IntersectionID, Intersection*>& intersections) {
+        std::vector<std::pair<std::vector<Intersection*>, float>> routes;
+        routes.reserve(starts.size());
+        for (Intersection* start : starts) {
+            routes.push_back(search(start, intersections));
+        }
+        return routes;
+    }
+    
+    /**
+     *  \brief called once the map is parsed, lets a path finder precompute what its searches need. does nothing by default
+     */
+    virtual void prepare(std::unordered_map<traffictrack::IntersectionID, Intersection*>& /* intersections */) { }
+    
+    /**
+     *  \brief roughly how many bytes the path finder keeps between searches, 0 if it keeps nothing
+     */
+    virtual size_t memory() const { return 0; }
+    
+    /**
+     *  \brief called with the congestion scores the intersections logged, from the thread that runs the searches. a path
+     *      finder that routes around congestion updates its costs, the others ignore it
+     */
+    virtual void updateCongestion(const std::vector<std::pair<traffictrack::IntersectionID, traffictrack::DateScorePair>>& /* scores */, std::unordered_map<traffictrack::IntersectionID, Intersection*>& /* intersections */) { }
+    
 };
 
 #endif /* AbstractPathFinder_hpp */
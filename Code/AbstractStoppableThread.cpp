@@ -25,6 +25,13 @@ bool AbstractStoppableThread::stopRequested() const {
 }
 
 
+/** @fn wakeUp()
+ *  @brief called by stop() right after the stop signal is set, before joining. threads that block on something other
+ *      than waitFor (i.e. a condition variable) override this to wake up and see the signal. does nothing by default
+ */
+void AbstractStoppableThread::wakeUp() { }
+
+
 /** @fn AbstractStoppableThread()
  *  @brief default constructor initializes members to default values
  */
@@ -57,6 +64,7 @@ void AbstractStoppableThread::stop() {
         if (futureObj_.wait_for(milliseconds(0)) == future_status::timeout) {
             
             exitSignal_.set_value();
+            wakeUp();
             
             lock_guard<mutex> threadGuard(threadMutex_);
             if (thread_ != nullptr) {
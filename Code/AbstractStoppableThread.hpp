@@ -32,6 +32,7 @@ protected:
     std::future<void> futureObj_; /**< used to test for promise signal being set */
     
     bool stopRequested() const;
+    virtual void wakeUp();
     template <typename Rep, typename Period> int waitFor(std::chrono::duration<Rep, Period> time);
     
 public:
@@ -10,6 +10,8 @@
 #define AbstractTrafficDatabase_hpp
 
 #include <unordered_map>
+#include <vector>
+#include <utility>
 #include <chrono>
 #include <ratio>
 #include <future>
@@ -17,6 +19,7 @@
 #include "IntersectionID.h"
 #include "DateScorePair.hpp"
 #include "AverageCongestionScores.hpp"
+#include "TimeBlock.h"
 
 /** @class AbstractTrafficDatabase
  *  @brief abstract class for the database which calculate averages based on the intersections and corresponding date score pairs
@@ -29,9 +32,13 @@ protected:
     
 public:
     typedef std::chrono::duration<double, std::ratio<1,1>> l_seconds;
+    typedef std::pair<traffictrack::IntersectionID, traffictrack::DateScorePair> LogRecord;
     virtual ~AbstractTrafficDatabase() { };
     virtual bool log(traffictrack::IntersectionID intersection, traffictrack::DateScorePair date_score_pair) = 0;
+    virtual int logBatch(const std::vector<LogRecord>& records) = 0;
     virtual const std::unordered_map<traffictrack::IntersectionID, traffictrack::AverageCongestionScores> calculateAverages() = 0;
+    virtual const std::unordered_map<traffictrack::IntersectionID, traffictrack::AverageCongestionScores> calculateChangedAverages() = 0;
+    virtual traffictrack::TimeBlock numberOfTimeBlocks() const = 0;
     virtual void close() = 0;
     
     //from AbstractStoppableThread
@@ -13,6 +13,9 @@ class TrafficLight;
 
 /** @class AbstractTrafficLightState
  *  @brief abstract class to change light based on traffic light state
+ *
+ *  changeLight() does the whole change and may block (a green light stays yellow for a while). beginChange() and
+ *  finishChange() split the same change into two halves that return right away, for callers that wait between them on a timer
  *  @author Matthew Lovick
  */
 class AbstractTrafficLightState {
@@ -20,6 +23,8 @@ class AbstractTrafficLightState {
 public:
     virtual ~AbstractTrafficLightState() { };
     virtual void changeLight(TrafficLight* light) = 0;
+    virtual void beginChange(TrafficLight* light) = 0;
+    virtual void finishChange(TrafficLight* light) = 0;
 
 };
 
@@ -76,11 +76,11 @@ ArgumentInterpreter::ArgumentInterpreter() {
     };
     
     validMapFileParsers_ = {
-        "QuickMapFileParser", "ExplicitMapFileParer"
+        "QuickMapFileParser", "ExplicitMapFileParser"
     };
     
     validSearchAlgorithms_ = {
-        "UniformCostSearch"
+        "UniformCostSearch", "HospitalRouteTree", "AStarSearch", "ContractionHierarchySearch"
     };
     
     validArgFlags_ = {
@@ -34,6 +34,7 @@ BaseException::~BaseException() { }
  */
 const char* BaseException::what() throw() {
     
-    return (exceptionType_ + ": " + message_).c_str();
+    description_ = exceptionType_ + ": " + message_;
+    return description_.c_str();
     
 }
@@ -21,6 +21,7 @@ class BaseException : public std::exception {
 protected:
     const std::string exceptionType_;
     const std::string message_;
+    std::string description_; /**< what what() returns, kept here so the pointer outlives the call */
     
 public:
     BaseException();
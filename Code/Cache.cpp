@@ -10,6 +10,7 @@
 #include <fstream>
 #include <ctime>
 #include <exception>
+#include <utility>
 #include "Cache.hpp"
 #include "CongestionScore.hpp"
 
@@ -30,7 +31,7 @@ Cache::~Cache() { }
  */
 void Cache::add(traffictrack::DateScorePair date_score_pair, bool cached) {
     
-    data_.push_back(std::pair<traffictrack::DateScorePair, bool>(date_score_pair, cached));
+    data_.push_back(std::pair<traffictrack::DateScorePair, bool>(std::move(date_score_pair), cached));
 
 }
 
@@ -10,6 +10,7 @@
 #include "Camera.hpp"
 #include "AbstractPhotoTaker.hpp"
 #include "RandomPhotoTaker.hpp"
+#include "FrameQualityGate.hpp"
 
 
 /** @fn Camera()
@@ -19,6 +20,7 @@ Camera::Camera() {
     
     streamIsOpen_ = false;
     photoTaker_ = new RandomPhotoTaker();
+    qualityGate_ = new FrameQualityGate();
     
 }
 
@@ -31,6 +33,9 @@ Camera::~Camera() {
     if (photoTaker_ != nullptr) {
         delete photoTaker_;
     }
+    if (qualityGate_ != nullptr) {
+        delete qualityGate_;
+    }
     
 }
 
@@ -70,3 +75,10 @@ std::string Camera::takePhoto() {
 }
 
 
+/** @fn qualityGate()
+ *  @brief getter for the quality gate that checks this camera's frames
+ *  @return FrameQualityGate*
+ */
+FrameQualityGate* Camera::qualityGate() {
+    return qualityGate_;
+}
@@ -15,6 +15,7 @@
 
 
 class AbstractPhotoTaker;
+class FrameQualityGate;
 
 /** @class Camera
  *  @brief opens a video stream, takes a photo using abstract photo taker
@@ -25,6 +26,7 @@ class Camera {
 protected:
     bool streamIsOpen_;
     AbstractPhotoTaker* photoTaker_;
+    FrameQualityGate* qualityGate_; /**< checks this camera's frames before inference and counts the ones skipped */
     
 public:
     Camera();
@@ -33,6 +35,7 @@ public:
     virtual bool openVideoStream();
     virtual bool closeVideoStream();
     virtual cv::String takePhoto();
+    FrameQualityGate* qualityGate();
     
 };
 
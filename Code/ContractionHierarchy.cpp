@@ -0,0 +1,736 @@
+//
+//  ContractionHierarchy.cpp
+//  TraffikTrak
+//
+//  Created by Matt Lovick on 2026-10-19.
+//  Copyright © 2026 Matt Lovick. All rights reserved.
+//
+
+#include <vector>
+#include <string>
+#include <fstream>
+#include <algorithm>
+#include <functional>
+#include <utility>
+#include <cstring>
+#include <cstdint>
+#include <cstdlib>
+#include "ContractionHierarchy.hpp"
+#include "RoadGraph.hpp"
+#include "TaskPool.hpp"
+
+using namespace std;
+
+
+/** @class ContractionBuilder
+ *  @brief the state of the contraction while a ContractionHierarchy is built, the remaining intersections and the roads
+ *      and shortcuts between them
+ */
+class ContractionBuilder {
+
+public:
+
+    /** @struct Shortcut
+     *  @brief a shortcut that contracting an intersection needs, over the edges first and second
+     */
+    struct Shortcut {
+        int from;
+        int to;
+        float length;
+        int first;
+        int second;
+    };
+
+    /** @struct Workspace
+     *  @brief the arrays of one witness search, one per worker so the searches of a round do not allocate
+     */
+    struct Workspace {
+        vector<float> distance; /**< -1 for intersections the search has not reached */
+        vector<unsigned char> hops; /**< roads on the path to each reached intersection */
+        vector<int> touched; /**< the intersections whose distance has to be reset after the search */
+        vector<float> through; /**< for the neighbors the search still looks for a witness to, the length of the shortcut, -1 for the others */
+        vector<pair<float, int>> heap; /**< the queue of the search, kept so it does not allocate */
+        vector<Shortcut> shortcuts;
+    };
+
+    static const int witnessLimit = 1000; /**< intersections a witness search settles at most, more shortcuts are added if it gives up early */
+    static const int witnessHops = 10; /**< roads a witness path has at most */
+    static const int estimateLimit = 20; /**< the same while only the priority is worked out, which needs to be less exact */
+    static const int estimateHops = 2;
+    static const int reestimateChange = 10; /**< percent the roads of an intersection change by before its shortcuts are counted again */
+
+    ContractionHierarchy& hierarchy_;
+    const int size_;
+    vector<vector<ContractionHierarchy::Arc>> out_; /**< roads and shortcuts between the remaining intersections, by the intersection at the other end */
+    vector<vector<ContractionHierarchy::Arc>> in_; /**< the same arriving at each intersection, also by the intersection at the other end */
+    bool symmetric_; /**< every arc has one back of the same length, so out_[i] and in_[i] list the same intersections in the same order */
+    vector<vector<ContractionHierarchy::Arc>> up_; /**< out_ of each intersection when it was contracted */
+    vector<vector<ContractionHierarchy::Arc>> down_; /**< in_ of each intersection when it was contracted */
+    vector<char> contracted_;
+    vector<char> contracting_; /**< part of the current round, witness paths must not pass through them */
+    vector<int> contractedNeighbors_;
+    vector<int> priority_;
+    vector<int> estimate_; /**< shortcuts contracting each intersection would add when they were last counted */
+    vector<int> estimatedDegree_; /**< its roads in and out at that time, -1 before they were first counted */
+    vector<int> level_; /**< one more than the highest level of a contracted neighbor */
+    vector<Workspace> workspaces_; /**< one per worker of the shared TaskPool, and one for the calling thread */
+
+
+    /** @fn ContractionBuilder(ContractionHierarchy& hierarchy, const RoadGraph& graph)
+     *  @brief copies the roads of the graph, a road that is longer than another road between the same intersections is left out
+     */
+    ContractionBuilder(ContractionHierarchy& hierarchy, const RoadGraph& graph) : hierarchy_(hierarchy), size_(graph.size()), out_(size_), in_(size_), up_(size_), down_(size_),
+        contracted_(size_, false), contracting_(size_, false), contractedNeighbors_(size_, 0), priority_(size_, 0), estimate_(size_, 0), estimatedDegree_(size_, -1), level_(size_, 0), workspaces_(TaskPool::shared()->size() + 1) {
+
+        for (Workspace& workspace : workspaces_) {
+            workspace.distance.assign(size_, -1);
+            workspace.hops.assign(size_, 0);
+            workspace.through.assign(size_, -1);
+        }
+
+        for (int i = 0; i < size_; i++) {
+            for (int road = graph.firstRoad(i); road < graph.endRoad(i); road++) {
+                if (graph.target(road) != i) {
+                    addArc(i, graph.target(road), graph.length(road), -1, -1);
+                }
+            }
+        }
+
+        //the map files add every road both ways. shortcuts are then added in pairs too, so this stays true
+        symmetric_ = true;
+        for (int i = 0; i < size_ && symmetric_; i++) {
+            symmetric_ = out_[i].size() == in_[i].size();
+            for (size_t k = 0; k < out_[i].size() && symmetric_; k++) {
+                symmetric_ = out_[i][k].node == in_[i][k].node && out_[i][k].length == in_[i][k].length;
+            }
+        }
+
+    }
+
+
+    /** @fn findArc(std::vector<ContractionHierarchy::Arc>& arcs, int node)
+     *  @brief where the arc to or from an intersection is, or would go, in a list ordered by the intersection at the other end
+     */
+    static vector<ContractionHierarchy::Arc>::iterator findArc(vector<ContractionHierarchy::Arc>& arcs, int node) {
+
+        return lower_bound(arcs.begin(), arcs.end(), node, [](const ContractionHierarchy::Arc& arc, int value) { return arc.node < value; });
+
+    }
+
+
+    /** @fn addArc(int from, int to, float length, int first, int second)
+     *  @brief adds a road or shortcut between two remaining intersections, or shortens the one that is already there
+     */
+    void addArc(int from, int to, float length, int first, int second) {
+
+        auto forward = findArc(out_[from], to);
+        auto backward = findArc(in_[to], from);
+
+        if (forward != out_[from].end() && forward->node == to) {
+            if (forward->length <= length) {
+                return;
+            }
+            int edge = newEdge(from, to, first, second);
+            forward->length = backward->length = length;
+            forward->edge = backward->edge = edge;
+            return;
+        }
+
+        int edge = newEdge(from, to, first, second);
+        ContractionHierarchy::Arc outgoing = { to, length, edge };
+        ContractionHierarchy::Arc incoming = { from, length, edge };
+        out_[from].insert(forward, outgoing);
+        in_[to].insert(backward, incoming);
+
+    }
+
+
+    /** @fn newEdge(int from, int to, int first, int second)
+     *  @brief stores the edge for unpacking
+     *  @return int its number
+     */
+    int newEdge(int from, int to, int first, int second) {
+
+        ContractionHierarchy::Edge edge = { from, to, first, second };
+        hierarchy_.edges_.push_back(edge);
+        if (first >= 0) {
+            hierarchy_.shortcuts_++;
+        }
+        return static_cast<int>(hierarchy_.edges_.size()) - 1;
+
+    }
+
+
+    /** @fn shortcuts(int node, int settleLimit, int hopLimit, Workspace& workspace)
+     *  @brief finds the shortcuts that contracting an intersection needs and leaves them in workspace.shortcuts. for every
+     *      road arriving at the intersection, a search from its start looks for a path to the intersection's other
+     *      neighbors that avoids it and is no longer than going through it (a witness). the search gives up after
+     *      settleLimit intersections, on paths of more than hopLimit roads and beyond the longest shortcut it could replace
+     */
+    void shortcuts(int node, int settleLimit, int hopLimit, Workspace& workspace) const {
+
+        typedef pair<float, int> entry;
+
+        const vector<ContractionHierarchy::Arc>& in = in_[node];
+        const vector<ContractionHierarchy::Arc>& out = out_[node];
+        workspace.shortcuts.clear();
+
+        for (size_t i = 0; i < in.size(); i++) {
+
+            const ContractionHierarchy::Arc& incoming = in[i];
+            const int from = incoming.node;
+
+            //when every arc has one back, a witness from one neighbor to another also is one the other way, so each pair
+            //of neighbors is searched once and gets both its shortcuts
+            const size_t firstTarget = symmetric_ ? i + 1 : 0;
+
+            float longest = -1;
+            int targets = 0;
+            for (size_t j = firstTarget; j < out.size(); j++) {
+                if (out[j].node != from) {
+                    longest = max(longest, out[j].length);
+                    workspace.through[out[j].node] = incoming.length + out[j].length;
+                    targets++;
+                }
+            }
+            if (longest < 0) {
+                continue;
+            }
+            const float limit = incoming.length + longest;
+
+            vector<entry>& heap = workspace.heap;
+            heap.clear();
+            workspace.distance[from] = 0;
+            workspace.hops[from] = 0;
+            workspace.touched.push_back(from);
+            heap.push_back(entry(0, from));
+            int settled = 0;
+
+            while (!heap.empty() && settled < settleLimit && targets > 0) {
+
+                pop_heap(heap.begin(), heap.end(), std::greater<entry>());
+                entry current = heap.back();
+                heap.pop_back();
+                if (current.first > workspace.distance[current.second]) {
+                    continue;
+                }
+                if (current.first > limit) {
+                    break;
+                }
+                settled++;
+                
+                //the distances of the other neighbors are final once they are settled
+                if (workspace.through[current.second] >= 0) {
+                    workspace.through[current.second] = -1;
+                    if (--targets == 0) {
+                        break;
+                    }
+                }
+
+                const int hops = workspace.hops[current.second] + 1;
+                if (hops > hopLimit) {
+                    continue;
+                }
+
+                for (const ContractionHierarchy::Arc& arc : out_[current.second]) {
+
+                    if (arc.node == node || contracting_[arc.node]) {
+                        continue;
+                    }
+
+                    //a path longer than the longest shortcut cannot be a witness
+                    float distance = current.first + arc.length;
+                    if (distance > limit) {
+                        continue;
+                    }
+                    float& known = workspace.distance[arc.node];
+                    if (known < 0 || distance < known) {
+                        if (known < 0) {
+                            workspace.touched.push_back(arc.node);
+                        }
+                        known = distance;
+                        workspace.hops[arc.node] = static_cast<unsigned char>(hops);
+                        heap.push_back(entry(distance, arc.node));
+                        push_heap(heap.begin(), heap.end(), std::greater<entry>());
+
+                        //a path no longer than the shortcut already is a witness, the search can stop once every
+                        //neighbor has one
+                        float& through = workspace.through[arc.node];
+                        if (through >= 0 && distance <= through) {
+                            through = -1;
+                            if (--targets == 0) {
+                                break;
+                            }
+                        }
+                    }
+
+                }
+
+            }
+
+            //any distance the search reached is the length of a real path, settled or not
+            for (size_t j = firstTarget; j < out.size(); j++) {
+
+                const ContractionHierarchy::Arc& outgoing = out[j];
+                if (outgoing.node == from) {
+                    continue;
+                }
+                workspace.through[outgoing.node] = -1;
+
+                float through = incoming.length + outgoing.length;
+                float witness = workspace.distance[outgoing.node];
+                if (witness < 0 || witness > through) {
+                    Shortcut shortcut = { from, outgoing.node, through, incoming.edge, outgoing.edge };
+                    workspace.shortcuts.push_back(shortcut);
+                    if (symmetric_) {
+                        Shortcut back = { outgoing.node, from, through, in[j].edge, out[i].edge };
+                        workspace.shortcuts.push_back(back);
+                    }
+                }
+
+            }
+
+            for (int touched : workspace.touched) {
+                workspace.distance[touched] = -1;
+            }
+            workspace.touched.clear();
+
+        }
+
+    }
+
+
+    /** @fn key(int node) const
+     *  @brief the order in which intersections are contracted, ties are broken by a hash so that the intersections of a
+     *      round are spread over the whole map
+     */
+    pair<int, uint32_t> key(int node) const {
+        return make_pair(priority_[node], static_cast<uint32_t>(node) * 2654435761u);
+    }
+
+
+    /** @fn parallel(const std::vector<int>& nodes, F work)
+     *  @brief calls work(node, workspace) for every node, split over the shared TaskPool. runs on the calling thread when
+     *      it is one of the pool's workers, since a task must not wait for other tasks
+     */
+    template <typename F>
+    void parallel(const vector<int>& nodes, F work) {
+
+        TaskPool::shared()->forEach(nodes.size(), 64, [this, &nodes, &work](size_t begin, size_t end, int slot) {
+            Workspace& workspace = workspaces_[slot];
+            for (size_t i = begin; i < end; i++) {
+                work(nodes[i], workspace);
+            }
+        });
+
+    }
+
+
+    /** @fn build()
+     *  @brief contracts every intersection and stores the result in the hierarchy
+     */
+    void build() {
+
+        vector<int> remaining(size_);
+        for (int i = 0; i < size_; i++) {
+            remaining[i] = i;
+        }
+        vector<int> changed = remaining;
+        vector<char> changedFlag(size_, false);
+        vector<int> round;
+        vector<vector<Shortcut>> found;
+
+        while (!remaining.empty()) {
+
+            //twice the roads contracting an intersection would add less the roads it removes, plus how many of its neighbors
+            //are gone and how high up it is, which spreads the contraction evenly over the map. it is only worked out again
+            //for the intersections whose neighbors changed, and the shortcuts are only counted again once their roads changed
+            //by more than reestimateChange percent since they were last counted, which in the dense core near the end would
+            //otherwise take most of the build
+            parallel(changed, [this](int node, Workspace& workspace) {
+                const int degree = static_cast<int>(in_[node].size() + out_[node].size());
+                if (estimatedDegree_[node] < 0 || abs(degree - estimatedDegree_[node])*100 > estimatedDegree_[node]*reestimateChange) {
+                    shortcuts(node, estimateLimit, estimateHops, workspace);
+                    estimate_[node] = static_cast<int>(workspace.shortcuts.size());
+                    estimatedDegree_[node] = degree;
+                }
+                int difference = estimate_[node] - degree;
+                priority_[node] = 2*difference + contractedNeighbors_[node] + level_[node];
+            });
+            changed.clear();
+
+            //the intersections that come before all their neighbors can be contracted together. witness paths have to avoid
+            //all of them, or two of them could each count on a path through the other and both leave out the shortcut
+            round.clear();
+            for (int node : remaining) {
+
+                bool first = true;
+                for (const ContractionHierarchy::Arc& arc : out_[node]) {
+                    first = first && key(node) < key(arc.node);
+                }
+                for (const ContractionHierarchy::Arc& arc : in_[node]) {
+                    first = first && key(node) < key(arc.node);
+                }
+                if (first) {
+                    round.push_back(node);
+                    contracting_[node] = true;
+                }
+
+            }
+
+            found.assign(round.size(), vector<Shortcut>());
+            vector<int> positions(round.size());
+            for (size_t i = 0; i < round.size(); i++) {
+                positions[i] = static_cast<int>(i);
+            }
+            parallel(positions, [this, &round, &found](int position, Workspace& workspace) {
+                shortcuts(round[position], witnessLimit, witnessHops, workspace);
+                found[position] = workspace.shortcuts;
+            });
+
+            for (size_t i = 0; i < round.size(); i++) {
+
+                const int node = round[i];
+                up_[node] = out_[node];
+                down_[node] = in_[node];
+                contracted_[node] = true;
+                contracting_[node] = false;
+
+                for (const ContractionHierarchy::Arc& arc : out_[node]) {
+                    removeArc(in_[arc.node], node);
+                    touch(arc.node, level_[node], changed, changedFlag);
+                }
+                for (const ContractionHierarchy::Arc& arc : in_[node]) {
+                    removeArc(out_[arc.node], node);
+                    touch(arc.node, level_[node], changed, changedFlag);
+                }
+                out_[node].clear();
+                out_[node].shrink_to_fit();
+                in_[node].clear();
+                in_[node].shrink_to_fit();
+
+                for (const Shortcut& shortcut : found[i]) {
+                    addArc(shortcut.from, shortcut.to, shortcut.length, shortcut.first, shortcut.second);
+                }
+
+            }
+
+            for (int node : changed) {
+                changedFlag[node] = false;
+            }
+
+            remaining.erase(remove_if(remaining.begin(), remaining.end(), [this](int node) { return contracted_[node] != 0; }), remaining.end());
+
+        }
+
+        flatten(up_, hierarchy_.upOffsets_, hierarchy_.up_);
+        flatten(down_, hierarchy_.downOffsets_, hierarchy_.down_);
+
+    }
+
+
+    /** @fn removeArc(std::vector<ContractionHierarchy::Arc>& arcs, int node)
+     *  @brief removes the arc to or from a contracted intersection
+     */
+    static void removeArc(vector<ContractionHierarchy::Arc>& arcs, int node) {
+
+        auto arc = findArc(arcs, node);
+        if (arc != arcs.end() && arc->node == node) {
+            arcs.erase(arc);
+        }
+
+    }
+
+
+    /** @fn touch(int node, int level, std::vector<int>& changed, std::vector<char>& changedFlag)
+     *  @brief records that a neighbor of the intersection, at the given level, was contracted
+     */
+    void touch(int node, int level, vector<int>& changed, vector<char>& changedFlag) {
+
+        contractedNeighbors_[node]++;
+        level_[node] = max(level_[node], level + 1);
+        if (!changedFlag[node]) {
+            changedFlag[node] = true;
+            changed.push_back(node);
+        }
+
+    }
+
+
+    /** @fn flatten(const std::vector<std::vector<ContractionHierarchy::Arc>>& lists, std::vector<int>& offsets, std::vector<ContractionHierarchy::Arc>& arcs)
+     *  @brief turns a list of arcs per intersection into compressed sparse row form
+     */
+    static void flatten(const vector<vector<ContractionHierarchy::Arc>>& lists, vector<int>& offsets, vector<ContractionHierarchy::Arc>& arcs) {
+
+        offsets.assign(1, 0);
+        arcs.clear();
+        for (const vector<ContractionHierarchy::Arc>& list : lists) {
+            arcs.insert(arcs.end(), list.begin(), list.end());
+            offsets.push_back(static_cast<int>(arcs.size()));
+        }
+        arcs.shrink_to_fit();
+
+    }
+
+};
+
+
+/** @fn ContractionHierarchy()
+ *  @brief constructor for an empty hierarchy, it matches no map
+ */
+ContractionHierarchy::ContractionHierarchy() : upOffsets_(1, 0), downOffsets_(1, 0), fingerprint_(0), shortcuts_(0) { }
+
+
+/** @fn ContractionHierarchy(const RoadGraph& graph)
+ *  @brief contracts the graph, using the shared TaskPool
+ *  @param graph the map
+ */
+ContractionHierarchy::ContractionHierarchy(const RoadGraph& graph) : fingerprint_(fingerprint(graph)), shortcuts_(0) {
+
+    ContractionBuilder builder(*this, graph);
+    builder.build();
+    edges_.shrink_to_fit();
+
+}
+
+
+/** @fn ~ContractionHierarchy()
+ *  @brief destructor that does nothing
+ */
+ContractionHierarchy::~ContractionHierarchy() { }
+
+
+/** @fn fingerprint(const RoadGraph& graph)
+ *  @brief a hash of the intersections and roads of a map, the hospitals are left out since the hierarchy does not depend on them
+ *  @param graph the map
+ *  @return unsigned long long never 0
+ */
+unsigned long long ContractionHierarchy::fingerprint(const RoadGraph& graph) {
+
+    //FNV-1a
+    unsigned long long hash = 14695981039346656037ULL;
+    auto mix = [&hash](uint32_t value) {
+        for (int i = 0; i < 4; i++) {
+            hash ^= (value >> (8*i)) & 0xff;
+            hash *= 1099511628211ULL;
+        }
+    };
+
+    mix(static_cast<uint32_t>(graph.size()));
+    for (int i = 0; i < graph.size(); i++) {
+
+        mix(static_cast<uint32_t>(static_cast<int>(graph.intersection(i)->ID())));
+        mix(static_cast<uint32_t>(graph.endRoad(i) - graph.firstRoad(i)));
+
+        for (int road = graph.firstRoad(i); road < graph.endRoad(i); road++) {
+            float length = graph.length(road);
+            uint32_t bits = 0;
+            memcpy(&bits, &length, sizeof(bits));
+            mix(static_cast<uint32_t>(graph.target(road)));
+            mix(bits);
+        }
+
+    }
+
+    return hash != 0 ? hash : 1;
+
+}
+
+
+/** @fn fingerprint() const
+ *  @brief the fingerprint of the map the hierarchy was built from
+ *  @return unsigned long long 0 for an empty hierarchy
+ */
+unsigned long long ContractionHierarchy::fingerprint() const {
+    return fingerprint_;
+}
+
+
+namespace {
+
+    const char fileMagic[4] = { 'T', 'T', 'C', 'H' };
+    const uint32_t fileVersion = 1;
+
+    template <typename T>
+    void writeArray(ofstream& out, const vector<T>& values) {
+        uint64_t count = values.size();
+        out.write(reinterpret_cast<const char*>(&count), sizeof(count));
+        out.write(reinterpret_cast<const char*>(values.data()), static_cast<streamsize>(values.size() * sizeof(T)));
+    }
+
+    template <typename T>
+    bool readArray(ifstream& in, vector<T>& values, uint64_t maximum) {
+        uint64_t count = 0;
+        if (!in.read(reinterpret_cast<char*>(&count), sizeof(count)) || count > maximum) {
+            return false;
+        }
+        values.resize(static_cast<size_t>(count));
+        return static_cast<bool>(in.read(reinterpret_cast<char*>(values.data()), static_cast<streamsize>(values.size() * sizeof(T))));
+    }
+
+}
+
+
+/** @fn save(const std::string& filename) const
+ *  @brief writes the hierarchy to a binary file, which can only be read back on a machine of the same byte order
+ *  @param filename the file
+ *  @return bool false if the file could not be written
+ */
+bool ContractionHierarchy::save(const std::string& filename) const {
+
+    ofstream out(filename, ios::binary | ios::trunc);
+    if (!out.is_open()) {
+        return false;
+    }
+
+    out.write(fileMagic, sizeof(fileMagic));
+    out.write(reinterpret_cast<const char*>(&fileVersion), sizeof(fileVersion));
+    out.write(reinterpret_cast<const char*>(&fingerprint_), sizeof(fingerprint_));
+    writeArray(out, upOffsets_);
+    writeArray(out, up_);
+    writeArray(out, downOffsets_);
+    writeArray(out, down_);
+    writeArray(out, edges_);
+
+    return out.good();
+
+}
+
+
+/** @fn load(const std::string& filename, const RoadGraph& graph)
+ *  @brief reads a hierarchy written by save(), if it was built from the same roads as the graph. the hierarchy is left as
+ *      it was if the file is missing, damaged or for another map
+ *  @param filename the file
+ *  @param graph the map the hierarchy has to match
+ *  @return bool whether the hierarchy was loaded
+ */
+bool ContractionHierarchy::load(const std::string& filename, const RoadGraph& graph) {
+
+    ifstream in(filename, ios::binary);
+    if (!in.is_open()) {
+        return false;
+    }
+
+    char magic[4];
+    uint32_t version = 0;
+    unsigned long long fingerprint = 0;
+    if (!in.read(magic, sizeof(magic)) || memcmp(magic, fileMagic, sizeof(magic)) != 0
+        || !in.read(reinterpret_cast<char*>(&version), sizeof(version)) || version != fileVersion
+        || !in.read(reinterpret_cast<char*>(&fingerprint), sizeof(fingerprint)) || fingerprint != ContractionHierarchy::fingerprint(graph)) {
+        return false;
+    }
+
+    //the sizes are checked against the file size before anything is allocated
+    in.seekg(0, ios::end);
+    const uint64_t bytes = static_cast<uint64_t>(in.tellg());
+    in.seekg(sizeof(magic) + sizeof(version) + sizeof(fingerprint), ios::beg);
+
+    ContractionHierarchy loaded;
+    if (!readArray(in, loaded.upOffsets_, bytes / sizeof(int)) || !readArray(in, loaded.up_, bytes / sizeof(Arc))
+        || !readArray(in, loaded.downOffsets_, bytes / sizeof(int)) || !readArray(in, loaded.down_, bytes / sizeof(Arc))
+        || !readArray(in, loaded.edges_, bytes / sizeof(Edge))) {
+        return false;
+    }
+
+    //a damaged file must not send a search out of bounds
+    const int size = graph.size();
+    const int edges = static_cast<int>(loaded.edges_.size());
+    auto validOffsets = [](const vector<int>& offsets, size_t arcs, int size) {
+        if (offsets.size() != static_cast<size_t>(size) + 1 || offsets.front() != 0 || offsets.back() != static_cast<int>(arcs)) {
+            return false;
+        }
+        for (int i = 0; i < size; i++) {
+            if (offsets[i] > offsets[i + 1]) {
+                return false;
+            }
+        }
+        return true;
+    };
+    auto validArcs = [size, edges](const vector<Arc>& arcs) {
+        for (const Arc& arc : arcs) {
+            if (arc.node < 0 || arc.node >= size || arc.edge < 0 || arc.edge >= edges || !(arc.length >= 0)) {
+                return false;
+            }
+        }
+        return true;
+    };
+
+    if (!validOffsets(loaded.upOffsets_, loaded.up_.size(), size) || !validOffsets(loaded.downOffsets_, loaded.down_.size(), size)
+        || !validArcs(loaded.up_) || !validArcs(loaded.down_)) {
+        return false;
+    }
+
+    //the halves of a shortcut are always older than the shortcut, so unpack() cannot loop
+    for (int i = 0; i < edges; i++) {
+        const Edge& edge = loaded.edges_[i];
+        if (edge.from < 0 || edge.from >= size || edge.to < 0 || edge.to >= size
+            || (edge.first >= 0) != (edge.second >= 0) || edge.first >= i || edge.second >= i) {
+            return false;
+        }
+        if (edge.first >= 0) {
+            loaded.shortcuts_++;
+        }
+    }
+
+    loaded.fingerprint_ = fingerprint;
+    *this = std::move(loaded);
+    return true;
+
+}
+
+
+/** @fn size() const
+ *  @brief the number of intersections
+ *  @return int
+ */
+int ContractionHierarchy::size() const {
+    return static_cast<int>(upOffsets_.size()) - 1;
+}
+
+
+/** @fn shortcuts() const
+ *  @brief the number of shortcuts the contraction added
+ *  @return int
+ */
+int ContractionHierarchy::shortcuts() const {
+    return shortcuts_;
+}
+
+
+/** @fn memory() const
+ *  @brief roughly how many bytes the hierarchy takes
+ *  @return size_t
+ */
+size_t ContractionHierarchy::memory() const {
+
+    return (upOffsets_.capacity() + downOffsets_.capacity())*sizeof(int) + (up_.capacity() + down_.capacity())*sizeof(Arc)
+        + edges_.capacity()*sizeof(Edge);
+
+}
+
+
+/** @fn unpack(int edge, std::vector<int>& nodes) const
+ *  @brief appends the intersections a road or shortcut passes, after its start and up to its end
+ *  @param edge the road or shortcut, Arc::edge
+ *  @param nodes the intersections of the path so far
+ */
+void ContractionHierarchy::unpack(int edge, std::vector<int>& nodes) const {
+
+    vector<int> pending(1, edge);
+
+    while (!pending.empty()) {
+
+        const Edge& current = edges_[pending.back()];
+        pending.pop_back();
+
+        if (current.first < 0) {
+            nodes.push_back(current.to);
+        }
+        else {
+            pending.push_back(current.second);
+            pending.push_back(current.first);
+        }
+
+    }
+
+}
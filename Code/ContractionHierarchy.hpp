@@ -0,0 +1,91 @@
+//
+//  ContractionHierarchy.hpp
+//  TraffikTrak
+//
+//  Created by Matt Lovick on 2026-10-19.
+//  Copyright © 2026 Matt Lovick. All rights reserved.
+//
+
+#ifndef ContractionHierarchy_hpp
+#define ContractionHierarchy_hpp
+
+#include <vector>
+#include <string>
+#include <cstddef>
+#include "RoadGraph.hpp"
+
+
+/** @class ContractionHierarchy
+ *  @brief the preprocessed form of a RoadGraph that ContractionHierarchySearch answers its searches with
+ *
+ *  the intersections are removed ("contracted") one after the other, least important first. whenever removing one would
+ *  make a shortest path longer, a shortcut with the length of the two roads it replaces is added between its neighbors.
+ *  afterwards, the shortest path between any two intersections first only climbs to more important intersections and
+ *  then only descends, so a search only has to follow the upward roads and shortcuts, which are few. up(i) are the roads
+ *  and shortcuts leaving intersection i towards more important ones, down(i) the ones arriving at i from more important
+ *  ones. unpack() turns a shortcut back into the intersections it passes.
+ *
+ *  the contraction runs in rounds on the shared TaskPool: every round picks intersections that are less important than
+ *  all their neighbors, so no two of them are neighbors, and contracts them in parallel. the hierarchy does not depend on
+ *  the hospitals, and save() and load() keep it on disk together with a fingerprint() of the roads it was built from
+ *  @author Matthew Lovick
+ */
+class ContractionHierarchy {
+
+public:
+
+    /** @struct Arc
+     *  @brief a road or shortcut of the hierarchy seen from one of its ends
+     */
+    struct Arc {
+        int node; /**< the intersection at the other end */
+        float length;
+        int edge; /**< the road or shortcut, for unpack() */
+    };
+
+protected:
+
+    /** @struct Edge
+     *  @brief a road of the map, or a shortcut made of two other edges
+     */
+    struct Edge {
+        int from;
+        int to;
+        int first; /**< first half of a shortcut, -1 for a road */
+        int second; /**< second half of a shortcut, -1 for a road */
+    };
+
+    std::vector<int> upOffsets_; /**< size()+1 entries, the arcs leaving intersection i upwards start at upOffsets_[i] */
+    std::vector<Arc> up_;
+    std::vector<int> downOffsets_; /**< size()+1 entries, the arcs arriving at intersection i from above start at downOffsets_[i] */
+    std::vector<Arc> down_;
+    std::vector<Edge> edges_;
+    unsigned long long fingerprint_; /**< fingerprint() of the roads the hierarchy was built from, 0 for an empty hierarchy */
+    int shortcuts_;
+
+    friend class ContractionBuilder;
+
+public:
+    ContractionHierarchy();
+    ContractionHierarchy(const RoadGraph& graph);
+    virtual ~ContractionHierarchy();
+    static unsigned long long fingerprint(const RoadGraph& graph);
+    unsigned long long fingerprint() const;
+    bool save(const std::string& filename) const;
+    bool load(const std::string& filename, const RoadGraph& graph);
+    int size() const;
+    int shortcuts() const;
+    size_t memory() const;
+    void unpack(int edge, std::vector<int>& nodes) const;
+    int firstUp(int node) const { return upOffsets_[node]; }
+    int endUp(int node) const { return upOffsets_[node + 1]; }
+    const Arc& up(int arc) const { return up_[arc]; }
+    int firstDown(int node) const { return downOffsets_[node]; }
+    int endDown(int node) const { return downOffsets_[node + 1]; }
+    const Arc& down(int arc) const { return down_[arc]; }
+    int from(int edge) const { return edges_[edge].from; }
+    int to(int edge) const { return edges_[edge].to; }
+
+};
+
+#endif /* ContractionHierarchy_hpp */
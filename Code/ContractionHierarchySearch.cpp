@@ -0,0 +1,293 @@
+//
+//  ContractionHierarchySearch.cpp
+//  TraffikTrak
+//
+//  Created by Matt Lovick on 2026-10-19.
+//  Copyright © 2026 Matt Lovick. All rights reserved.
+//
+
+#include <vector>
+#include <unordered_map>
+#include <queue>
+#include <algorithm>
+#include <functional>
+#include <utility>
+#include <string>
+#include "ContractionHierarchySearch.hpp"
+#include "ContractionHierarchy.hpp"
+#include "Intersection.hpp"
+#include "IntersectionID.h"
+#include "RoadGraph.hpp"
+#include "TaskPool.hpp"
+
+using namespace std;
+using namespace traffictrack;
+
+
+/** @fn ContractionHierarchySearch(const std::string& cacheFile)
+ *  @brief constructor, the hierarchy is built or loaded by prepare() or by the first search
+ *  @param cacheFile where the hierarchy is kept between runs, empty to always build it
+ */
+ContractionHierarchySearch::ContractionHierarchySearch(const std::string& cacheFile) : cacheFile_(cacheFile), workspaces_(1) { }
+
+
+/** @fn ~ContractionHierarchySearch()
+ *  @brief destructor that does nothing
+ */
+ContractionHierarchySearch::~ContractionHierarchySearch() { }
+
+
+/** @fn setCacheFile(const std::string& filename)
+ *  @brief sets where the hierarchy is kept between runs, takes effect at the next prepare()
+ *  @param filename the file, empty to always build the hierarchy
+ */
+void ContractionHierarchySearch::setCacheFile(const std::string& filename) {
+    cacheFile_ = filename;
+}
+
+
+/** @fn hierarchy() const
+ *  @brief getter for the hierarchy
+ *  @return const ContractionHierarchy&
+ */
+const ContractionHierarchy& ContractionHierarchySearch::hierarchy() const {
+    return hierarchy_;
+}
+
+
+/** @fn expanded() const
+ *  @brief the number of intersections the last search expanded
+ *  @return int
+ */
+int ContractionHierarchySearch::expanded() const {
+    return workspaces_.back().expanded;
+}
+
+
+/** @fn memory() const
+ *  @brief the bytes taken by the snapshot, the hierarchy, the ways down to the hospitals and the arrays of every thread
+ *      that searched
+ *  @return size_t
+ */
+size_t ContractionHierarchySearch::memory() const {
+    
+    size_t bytes = graph_.memory() + hierarchy_.memory() + hospitalDistance_.capacity()*sizeof(float) + hospitalEdge_.capacity()*sizeof(int);
+    for (const Workspace& workspace : workspaces_) {
+        bytes += workspace.distance.capacity()*sizeof(float) + (workspace.parentEdge.capacity() + workspace.touched.capacity())*sizeof(int);
+    }
+    return bytes;
+    
+}
+
+
+/** @fn prepare(std::unordered_map<traffictrack::IntersectionID, Intersection*>& intersections)
+ *  @brief takes the snapshot of the map, gets a hierarchy for its roads and finds the way down to the hospitals
+ *  @param intersections the map
+ */
+void ContractionHierarchySearch::prepare(std::unordered_map<traffictrack::IntersectionID, Intersection*>& intersections) {
+    
+    graph_ = RoadGraph(intersections);
+    
+    //only a change to the roads needs a new hierarchy, not a new hospital
+    if (hierarchy_.fingerprint() != ContractionHierarchy::fingerprint(graph_)) {
+        if (cacheFile_.empty() || !hierarchy_.load(cacheFile_, graph_)) {
+            hierarchy_ = ContractionHierarchy(graph_);
+            if (!cacheFile_.empty()) {
+                hierarchy_.save(cacheFile_);
+            }
+        }
+    }
+    
+    workspaces_.assign(TaskPool::shared()->size() + 1, Workspace());
+    
+    findHospitals();
+    
+}
+
+
+/** @fn findHospitals()
+ *  @brief a search from all the hospitals at once, backwards along the roads and shortcuts that lead down to them
+ */
+void ContractionHierarchySearch::findHospitals() {
+    
+    typedef pair<float, int> node;
+    
+    const int size = graph_.size();
+    hospitalDistance_.assign(size, -1);
+    hospitalEdge_.assign(size, -1);
+    
+    priority_queue<node, vector<node>, std::greater<node>> queue;
+    for (int i = 0; i < size; i++) {
+        if (graph_.hospital(i)) {
+            hospitalDistance_[i] = 0;
+            queue.push(node(0, i));
+        }
+    }
+    
+    while (!queue.empty()) {
+        
+        node current = queue.top();
+        queue.pop();
+        if (current.first > hospitalDistance_[current.second]) {
+            continue;
+        }
+        
+        for (int arc = hierarchy_.firstDown(current.second); arc < hierarchy_.endDown(current.second); arc++) {
+            
+            const ContractionHierarchy::Arc& road = hierarchy_.down(arc);
+            float distance = current.first + road.length;
+            
+            if (hospitalDistance_[road.node] < 0 || distance < hospitalDistance_[road.node]) {
+                hospitalDistance_[road.node] = distance;
+                hospitalEdge_[road.node] = road.edge;
+                queue.push(node(distance, road.node));
+            }
+            
+        }
+        
+    }
+    
+}
+
+
+/** @fn search(Intersection* startState, std::unordered_map<traffictrack::IntersectionID, Intersection*>& intersections)
+ *  @brief climbs the hierarchy from the start and turns around where the way to a hospital is shortest
+ *  @return std::pair<std::vector<Intersection*>, float> the path from the start to the hospital and its length, an empty path
+ *      and -1 if no hospital can be reached
+ */
+std::pair<std::vector<Intersection*>, float> ContractionHierarchySearch::search(Intersection* startState, std::unordered_map<traffictrack::IntersectionID, Intersection*>& intersections) {
+    
+    if (!graph_.current()) {
+        prepare(intersections);
+    }
+    
+    return search(graph_.index(startState), workspaces_.back());
+    
+}
+
+
+/** @fn searchBatch(const std::vector<Intersection*>& starts, std::unordered_map<traffictrack::IntersectionID, Intersection*>& intersections)
+ *  @brief climbs the hierarchy from all the starts at once on the shared TaskPool, the calling thread takes part
+ *  @return std::vector<std::pair<std::vector<Intersection*>, float>> the path from every start, in the same order
+ */
+std::vector<std::pair<std::vector<Intersection*>, float>> ContractionHierarchySearch::searchBatch(const std::vector<Intersection*>& starts, std::unordered_map<traffictrack::IntersectionID, Intersection*>& intersections) {
+    
+    //the hierarchy and the way down are only ever replaced here, before the workers start reading them
+    if (!graph_.current()) {
+        prepare(intersections);
+    }
+    
+    vector<pair<vector<Intersection*>, float>> routes(starts.size());
+    TaskPool::shared()->forEach(starts.size(), 4, [this, &starts, &routes](size_t begin, size_t end, int slot) {
+        for (size_t i = begin; i < end; i++) {
+            routes[i] = search(graph_.index(starts[i]), workspaces_[slot]);
+        }
+    }, TaskPool::HIGH);
+    
+    return routes;
+    
+}
+
+
+/** @fn search(int start, Workspace& workspace) const
+ *  @brief the search itself, it only reads the hierarchy and writes to the workspace, so threads with workspaces of
+ *      their own can search at the same time
+ *  @param start the number of the start in graph_, -1 if it is not on the map
+ *  @param workspace the arrays of the calling thread
+ *  @return std::pair<std::vector<Intersection*>, float> the path from the start to the hospital and its length, an empty path
+ *      and -1 if no hospital can be reached
+ */
+std::pair<std::vector<Intersection*>, float> ContractionHierarchySearch::search(int start, Workspace& workspace) const {
+    
+    typedef pair<float, int> node;
+    
+    vector<Intersection*> path;
+    workspace.expanded = 0;
+    
+    if (start < 0) {
+        return make_pair(path, -1);
+    }
+    
+    //the first search of a thread on this snapshot sizes its arrays
+    if (workspace.distance.size() != static_cast<size_t>(graph_.size())) {
+        workspace.distance.assign(graph_.size(), -1);
+        workspace.parentEdge.assign(graph_.size(), -1);
+        workspace.touched.clear();
+    }
+    
+    priority_queue<node, vector<node>, std::greater<node>> queue;
+    workspace.distance[start] = 0;
+    workspace.parentEdge[start] = -1;
+    workspace.touched.push_back(start);
+    queue.push(node(0, start));
+    
+    float best = -1;
+    int turn = -1;
+    
+    //once the closest intersection left is further than the best way found, no other way can be shorter
+    while (!queue.empty() && (best < 0 || queue.top().first < best)) {
+        
+        node current = queue.top();
+        queue.pop();
+        if (current.first > workspace.distance[current.second]) {
+            continue;
+        }
+        workspace.expanded++;
+        
+        if (hospitalDistance_[current.second] >= 0 && (best < 0 || current.first + hospitalDistance_[current.second] < best)) {
+            best = current.first + hospitalDistance_[current.second];
+            turn = current.second;
+        }
+        
+        for (int arc = hierarchy_.firstUp(current.second); arc < hierarchy_.endUp(current.second); arc++) {
+            
+            const ContractionHierarchy::Arc& road = hierarchy_.up(arc);
+            float distance = current.first + road.length;
+            float& known = workspace.distance[road.node];
+            
+            if (known < 0 || distance < known) {
+                if (known < 0) {
+                    workspace.touched.push_back(road.node);
+                }
+                known = distance;
+                workspace.parentEdge[road.node] = road.edge;
+                queue.push(node(distance, road.node));
+            }
+            
+        }
+        
+    }
+    
+    if (turn >= 0) {
+        
+        //the roads and shortcuts up to where the search turned around, found from the end
+        vector<int> edges;
+        for (int current = turn; workspace.parentEdge[current] >= 0; current = hierarchy_.from(workspace.parentEdge[current])) {
+            edges.push_back(workspace.parentEdge[current]);
+        }
+        
+        vector<int> nodes(1, start);
+        for (auto it = edges.rbegin(); it != edges.rend(); ++it) {
+            hierarchy_.unpack(*it, nodes);
+        }
+        
+        //then down to the hospital
+        for (int current = turn; hospitalEdge_[current] >= 0; current = hierarchy_.to(hospitalEdge_[current])) {
+            hierarchy_.unpack(hospitalEdge_[current], nodes);
+        }
+        
+        path.reserve(nodes.size());
+        for (int node : nodes) {
+            path.push_back(graph_.intersection(node));
+        }
+        
+    }
+    
+    for (int node : workspace.touched) {
+        workspace.distance[node] = -1;
+    }
+    workspace.touched.clear();
+    
+    return make_pair(path, best);
+    
+}
@@ -0,0 +1,70 @@
+//
+//  ContractionHierarchySearch.hpp
+//  TraffikTrak
+//
+//  Created by Matt Lovick on 2026-10-19.
+//  Copyright © 2026 Matt Lovick. All rights reserved.
+//
+
+#ifndef ContractionHierarchySearch_hpp
+#define ContractionHierarchySearch_hpp
+
+#include <vector>
+#include <unordered_map>
+#include <utility>
+#include <string>
+#include "Intersection.hpp"
+#include "IntersectionID.h"
+#include "AbstractPathFinder.hpp"
+#include "RoadGraph.hpp"
+#include "ContractionHierarchy.hpp"
+
+
+/** @class ContractionHierarchySearch
+ *  @brief implements the AbstractPathFinder with a ContractionHierarchy, for city sized maps
+ *
+ *  prepare() builds the hierarchy, or loads it from the cache file if one was built for the same roads before and saves
+ *  it otherwise. it then works out, for every intersection, the shortest way down the hierarchy to a hospital. a search
+ *  only climbs the hierarchy from the start, and the best intersection to turn around at gives the nearest hospital. a new
+ *  hospital only repeats the way down, the hierarchy is rebuilt only when the roads change. searchBatch() climbs from
+ *  several starts at once on the shared TaskPool
+ *  @author Matthew Lovick
+ */
+class ContractionHierarchySearch : public AbstractPathFinder {
+    
+protected:
+    
+    /** @struct Workspace
+     *  @brief the arrays of one thread's searches, sized to the map by its first search
+     */
+    struct Workspace {
+        std::vector<float> distance; /**< distance from the start of the current search, -1 if not reached */
+        std::vector<int> parentEdge; /**< the road or shortcut the current search reached each intersection by */
+        std::vector<int> touched; /**< the intersections whose distance has to be reset after the search */
+        int expanded = 0; /**< intersections expanded by the last search */
+    };
+    
+    RoadGraph graph_; /**< snapshot of the map the hierarchy belongs to */
+    ContractionHierarchy hierarchy_;
+    std::string cacheFile_; /**< where the hierarchy is saved, empty to always build it */
+    std::vector<float> hospitalDistance_; /**< length of the shortest way down the hierarchy to a hospital, -1 if there is none */
+    std::vector<int> hospitalEdge_; /**< the first road or shortcut of that way, -1 at the hospitals */
+    std::vector<Workspace> workspaces_; /**< one per worker of the shared TaskPool, the last one for the calling thread */
+    
+    void findHospitals();
+    std::pair<std::vector<Intersection*>, float> search(int start, Workspace& workspace) const;
+    
+public:
+    ContractionHierarchySearch(const std::string& cacheFile = "");
+    virtual ~ContractionHierarchySearch();
+    void setCacheFile(const std::string& filename);
+    const ContractionHierarchy& hierarchy() const;
+    int expanded() const;
+    virtual size_t memory() const;
+    virtual std::pair<std::vector<Intersection*>, float> search(Intersection* startState, std::unordered_map<traffictrack::IntersectionID, Intersection*>& intersections);
+    virtual std::vector<std::pair<std::vector<Intersection*>, float>> searchBatch(const std::vector<Intersection*>& starts, std::unordered_map<traffictrack::IntersectionID, Intersection*>& intersections);
+    virtual void prepare(std::unordered_map<traffictrack::IntersectionID, Intersection*>& intersections);
+    
+};
+
+#endif /* ContractionHierarchySearch_hpp */
@@ -12,6 +12,7 @@
 #include <utility>
 #include <mutex>
 #include <thread>
+#include <algorithm>
 #include "Controller.hpp"
 #include "ArgumentInterpreter.hpp"
 #include "Intersection.hpp"
@@ -26,6 +27,9 @@
 #include "DateScorePair.hpp"
 #include "IntersectionID.h"
 #include "UniformCostSearch.hpp"
+#include "HospitalRouteTree.hpp"
+#include "AStarSearch.hpp"
+#include "ContractionHierarchySearch.hpp"
 #include "LightSchedule.hpp"
 #include "AbstractTrafficLightScheduler.hpp"
 #include "DefaultTrafficLightScheduler.hpp"
@@ -36,6 +40,9 @@
 #include "AbstractPathFinder.hpp"
 #include "UniformCostSearch.hpp"
 #include "AverageCongestionScores.hpp"
+#include "TrafficLight.hpp"
+#include "FrameQuality.h"
+#include "FrameQualityGate.hpp"
 #include <opencv2/dnn.hpp>
 #include <opencv2/imgproc.hpp>
 #include <opencv2/highgui.hpp>
@@ -52,193 +59,269 @@ Controller* Controller::instance_ = nullptr;
 /** @fn Controller()
  *  @brief default constructor initializes
  */
-Controller::Controller() {
+Controller::Controller() : sleeping_(false), dataRequests_(4096), emergencyVehicleAlerts_(16384), emergencyAlertsHandled_(0), emergencyWakeLatencyTotal_(0), emergencyWakeLatencyMax_(0) {
     
     database_ = nullptr;
     pathFinder_ = nullptr;
     timeBetweenScheduleUpdates_ = seconds(60); //aribtrary value for proof of concept
-    timeSinceLastUpdate_ = seconds(60); //arbitrary value
-    timeCounterThread_ = nullptr;
+    nextScheduleUpdate_ = clock::now(); //schedule as soon as the controller starts
     scheduler = new DefaultTrafficLightScheduler();
+    logBatchesInFlight_ = 0;
+    maxLogBatches_ = 1024;
+    logScoresDropped_ = 0;
+    logMetrics_ = TaskPool::Metrics();
+    logWaitTotal_ = 0;
+    logRunTotal_ = 0;
+    executionShards_ = 0;
+    executor_ = nullptr;
     
 }
 
 
-/** @fn handleDataLogRequest(traffictrack::IntersectionID ID, traffictrack::DateScorePair score)
- *  @brief method that handles when intersection wants to log congestion score in the database
- *  @param ID the ID of the intersection that the score is for
- *  @param score the information that will be logged in the database
+/** @fn handleDataLogRequests(std::vector<DataRequest> requests)
+ *  @brief method that handles a batch of congestion scores the intersections want to log in the database
+ *  @param requests the IDs of the intersections and the information that will be logged for them
  */
-void Controller::handleDataLogRequest(traffictrack::IntersectionID ID, traffictrack::DateScorePair score) {
+void Controller::handleDataLogRequests(std::vector<DataRequest> requests) {
     
-    if (logThreads_.size() >= maxLogThreads_) {
-        clearLogThreads();
+    //the path finder runs on this thread too, so it can take the new congestion without locking
+    if (pathFinder_ != nullptr) {
+        pathFinder_->updateCongestion(requests, intersections_);
     }
     
-    thread* my_thread = new thread(&AbstractTrafficDatabase::log, database_, ID, score);
-    logThreads_.push_back(my_thread);
+    //this thread also handles the emergency alerts, so it never waits for a slow database. when too many batches are
+    //waiting to be written the new one is dropped and counted, like the scores dataRequests_ drops when it is full
+    {
+        lock_guard<mutex> lock(logMutex_);
+        if (maxLogBatches_ != 0 && logBatchesInFlight_ >= maxLogBatches_) {
+            logScoresDropped_ += static_cast<long long>(requests.size());
+            return;
+        }
+        logBatchesInFlight_++;
+        logMetrics_.maxQueued = max(logMetrics_.maxQueued, static_cast<long long>(logBatchesInFlight_));
+    }
+    
+    //writing scores is the least urgent work on the shared pool
+    AbstractTrafficDatabase* database = database_;
+    clock::time_point posted = clock::now();
+    TaskPool::shared()->post([this, database, posted, batch = std::move(requests)]() {
+        
+        clock::time_point started = clock::now();
+        database->logBatch(batch);
+        long long wait = duration_cast<microseconds>(started - posted).count();
+        long long run = duration_cast<microseconds>(clock::now() - started).count();
+        
+        lock_guard<mutex> guard(logMutex_);
+        logBatchesInFlight_--;
+        logWaitTotal_ += wait;
+        logRunTotal_ += run;
+        logMetrics_.tasks++;
+        logMetrics_.maxWaitMicroseconds = max(logMetrics_.maxWaitMicroseconds, wait);
+        logMetrics_.maxRunMicroseconds = max(logMetrics_.maxRunMicroseconds, run);
+        logCondition_.notify_all();
+        
+    }, TaskPool::LOW);
     
 }
 
 
-/** @fn handleEmergencyAlert(ID)
- *  @brief method that handles when an emergency vehicle is detected
- *  @param ID the id of the intersection that the emergency vehicle was detected at
+/** @fn handleEmergencyAlerts(const std::vector<EmergencyAlert>& alerts)
+ *  @brief method that handles a burst of emergency vehicles being detected
+ *
+ *  the routes of all the vehicles are searched at once, spread over the shared pool by path finders that can, and the
+ *  lights are then changed one route after the other on this thread
+ *  @param alerts the ids of the intersections that the emergency vehicles were detected at
  */
-void Controller::handleEmergencyAlert(traffictrack::IntersectionID ID) {
+void Controller::handleEmergencyAlerts(const std::vector<EmergencyAlert>& alerts) {
     
-    pair<vector<Intersection*>, float> path = pathFinder_->search(intersections_[ID], intersections_);
+    vector<Intersection*> starts;
+    starts.reserve(alerts.size());
+    for (const EmergencyAlert& alert : alerts) {
+        auto it = intersections_.find(alert.first);
+        starts.push_back(it != intersections_.end() ? it->second : nullptr);
+    }
     
-    if (path.second > 0) {
-        
-        Intersection* previous = path.first[0];
-        for (auto it = path.first.begin()+1; it != path.first.end(); ++it) {
-            
-            Direction direction = Direction::DEFAULT;
-            
-            for (Road r : previous->neighbors()) {
-                
-                if (r.secondIntersection() == (*it)) {
-                    direction = r.direction();
-                    break;
-                }
-                
-            }
-            
-            if (direction != Direction::DEFAULT) {
-                
-                LightColour colour;
-                if (direction == Direction::NORTH || direction == Direction::SOUTH) {
-                    colour = (*it)->northSouthColour();
-                }
-                else {
-                    colour = (*it)->eastWestColour();
-                }
-                
-                if (colour != LightColour::GREEN) {
-                    (*it)->changeLights();
-                }
-                
-            }
-            
-            previous = (*it);
-            
+    vector<pair<vector<Intersection*>, float>> paths = pathFinder_->searchBatch(starts, intersections_);
+    
+    for (const pair<vector<Intersection*>, float>& path : paths) {
+        if (path.second > 0) {
+            preemptLights(path.first);
         }
-        
     }
     
 }
 
 
-/** @fn clearLogThreads()
- *  @brief joins all the current threads running in the database and resets the vector to be empty, since we need to keep track of loose threads for safety
+/** @fn preemptLights(const std::vector<Intersection*>& path)
+ *  @brief turns the lights green along the route of an emergency vehicle. each change is only requested, the lights go
+ *      through their yellow phase on the timer and shared TaskPool while the controller thread moves on
+ *  @param path the intersections on the route, in order
  */
-void Controller::clearLogThreads() {
+void Controller::preemptLights(const std::vector<Intersection*>& path) {
     
-    for (thread* t : logThreads_) {
-        if (t->joinable()) {
-            t->join();
-            delete t;
+    Intersection* previous = path[0];
+    for (auto it = path.begin()+1; it != path.end(); ++it) {
+        
+        Direction direction = Direction::DEFAULT;
+        
+        for (Road r : previous->neighbors()) {
+            
+            if (r.secondIntersection() == (*it)) {
+                direction = r.direction();
+                break;
+            }
+            
         }
+        
+        if (direction != Direction::DEFAULT) {
+            
+            LightColour colour;
+            if (direction == Direction::NORTH || direction == Direction::SOUTH) {
+                colour = (*it)->northSouthColour();
+            }
+            else {
+                colour = (*it)->eastWestColour();
+            }
+            
+            if (colour != LightColour::GREEN) {
+                (*it)->changeLightsSoon();
+            }
+            
+        }
+        
+        previous = (*it);
+        
     }
-    logThreads_.clear();
     
 }
 
 
 /** @fn manageRequests()
- *  @brief internal looping thread that pulls information from the queue and handles events accordingly
+ *  @brief internal looping thread that pulls information from the queues and handles events accordingly
+ *
+ *  requests are taken from the lock-free queues in batches. the thread only sleeps on requestsCondition_ once both queues are
+ *  empty, until a request is queued, the next schedule update is due or the controller is stopped, so it uses no cpu while there
+ *  is nothing to do. pending emergency alerts are always handled first, before a due schedule update and before data log requests
  */
 void Controller::manageRequests() {
     
-    unique_lock<mutex> threadLock(timeCounterThreadMutex_);
-    if (timeCounterThread_ == nullptr) {
-        timeCounterThread_ = new thread (&Controller::countTimeSinceLastUpdate, this);
-    }
-    threadLock.unlock();
+    vector<EmergencyAlert> alerts;
+    vector<DataRequest> requests;
+    alerts.reserve(maxBatch_);
+    requests.reserve(maxBatch_);
     
     while (!stopRequested()) {
         
-        {
-            unique_lock<mutex> timeCounterLock(timeCounterMutex_);
-            if (timeSinceLastUpdate_ >= timeBetweenScheduleUpdates_) {
-                timeCounterLock.unlock();
-                updateSchedules();
+        alerts.clear();
+        if (emergencyVehicleAlerts_.popBatch(alerts, maxBatch_) > 0) {
+            for (const EmergencyAlert& alert : alerts) {
+                recordWakeLatency(alert.second);
             }
+            handleEmergencyAlerts(alerts);
+            continue;
         }
         
-        unique_lock<mutex> emergencyLock(emergencyAlertMutex_);
-        if (!emergencyVehicleAlerts_.empty()) {
-            
-            IntersectionID ID = emergencyVehicleAlerts_.front();
-            emergencyVehicleAlerts_.pop();
-            emergencyLock.unlock();
-            
-            handleEmergencyAlert(ID);
-            
+        if (clock::now() >= nextScheduleUpdate_) {
+            updateSchedules();
+            continue;
         }
-        else {
-            
-            emergencyLock.unlock();
-            unique_lock<mutex> dataRequestsLock(dataRequestsMutex_);
-            if (!dataRequests_.empty()) {
-                
-                pair<IntersectionID, DateScorePair> data = dataRequests_.front();
-                dataRequests_.pop();
-                dataRequestsLock.unlock();
-                
-                handleDataLogRequest(data.first, data.second);
-                
-            }
-            
+        
+        requests.clear();
+        if (dataRequests_.popBatch(requests, maxBatch_) > 0) {
+            handleDataLogRequests(std::move(requests));
+            requests.reserve(maxBatch_);
+            continue;
+        }
+        
+        //announce the sleep before checking the queues one last time, a producer that pushes after the check sees sleeping_ and notifies
+        unique_lock<mutex> lock(requestsMutex_);
+        sleeping_.store(true);
+        atomic_thread_fence(memory_order_seq_cst);
+        if (emergencyVehicleAlerts_.empty() && dataRequests_.empty() && !stopRequested()) {
+            requestsCondition_.wait_until(lock, nextScheduleUpdate_);
         }
+        sleeping_.store(false);
         
     }
+    
+}
 
-        
-    threadLock.lock();
-    if (timeCounterThread_->joinable()) {
-        timeCounterThread_->join();
-        delete timeCounterThread_;
-        timeCounterThread_ = nullptr;
+
+/** @fn recordWakeLatency(clock::time_point queued)
+ *  @brief records how long an emergency alert waited in the queue before the controller thread picked it up
+ *  @param queued the time the alert was queued
+ */
+void Controller::recordWakeLatency(clock::time_point queued) {
+    
+    long long latency = duration_cast<microseconds>(clock::now() - queued).count();
+    
+    emergencyAlertsHandled_++;
+    emergencyWakeLatencyTotal_ += latency;
+    
+    //only the controller thread writes the maximum, so a plain compare and store is enough
+    if (latency > emergencyWakeLatencyMax_) {
+        emergencyWakeLatencyMax_ = latency;
     }
     
 }
 
 
-/** @fn countTimeSinceLastUpdate()
- *  @brief counts the number of seconds since the last time that the traffic light schedules
+/** @fn notifyController()
+ *  @brief called by producers after queueing a request, wakes the controller thread only if it is sleeping
+ *
+ *  while the controller thread is busy the producer does not touch the mutex at all. when it is sleeping the mutex is free,
+ *  since the wait releases it, so taking it here never blocks behind the controller's work
  */
-void Controller::countTimeSinceLastUpdate() {
+void Controller::notifyController() {
     
-    while(!stopRequested()) {
-        
-        waitFor(seconds(1));
-        lock_guard<mutex> guard(timeCounterMutex_);
-        timeSinceLastUpdate_++;
-        
+    atomic_thread_fence(memory_order_seq_cst);
+    if (sleeping_.load()) {
+        {
+            lock_guard<mutex> guard(requestsMutex_);
+        }
+        requestsCondition_.notify_one();
     }
     
 }
 
 
+/** @fn wakeUp()
+ *  @brief wakes the controller thread so it sees the stop signal
+ */
+void Controller::wakeUp() {
+    
+    {
+        lock_guard<mutex> guard(requestsMutex_);
+    }
+    requestsCondition_.notify_all();
+    
+}
+
+
 /** @fn updateSchedules()
- *  @brief calculates new schedules for each intersection and updates their interval times based on the historical data
+ *  @brief recalculates the schedules of the time blocks that got new data since the last update, and gives the intersections
+ *      whose schedule changed their new weekly schedule
  */
 void Controller::updateSchedules() {
     
-    AbstractTrafficLightScheduler::IntersectionSchedules schedules = scheduler->schedule(database_->calculateAverages());
-    for (auto it = schedules.begin(); it != schedules.end(); ++it) {
+    AbstractTrafficLightScheduler::IntersectionSchedules changed = scheduler->schedule(database_->calculateChangedAverages());
+    
+    for (auto it = changed.begin(); it != changed.end(); ++it) {
         
         IntersectionID id = it->first;
-        LightSchedule intersection_schedule = it->second;
-        DayTimeBlockPair p("Mon", 1);
-        intersections_[id]->updateLightSchedule(intersection_schedule[p].first, intersection_schedule[p].second);
+        LightSchedule& intersection_schedule = schedules_[id];
+        for (auto& block : it->second) {
+            intersection_schedule[block.first] = block.second;
+        }
+        
+        auto intersection = intersections_.find(id);
+        if (intersection != intersections_.end()) {
+            intersection->second->updateLightSchedule(intersection_schedule, database_->numberOfTimeBlocks());
+        }
         
     }
     
-    lock_guard<mutex> guard(timeCounterMutex_);
-    timeSinceLastUpdate_ = seconds(0);
+    nextScheduleUpdate_ = clock::now() + timeBetweenScheduleUpdates_;
     
 }
 
@@ -260,6 +343,9 @@ Controller* Controller::instance() {
  */
 Controller::~Controller() {
     
+    //stop the controller thread here, the base class destructor can no longer reach the overridden wakeUp()
+    stop();
+    
     for (auto it = intersections_.begin(); it != intersections_.end(); ++it) {
         it->second->stop();
     }
@@ -268,11 +354,24 @@ Controller::~Controller() {
         delete it->second;
     }
     
+    //the intersections no longer post any work once they are stopped
+    delete executor_;
+    
+    //finishes the scores already queued before the database is closed
+    {
+        unique_lock<mutex> lock(logMutex_);
+        logCondition_.wait(lock, [this]() { return logBatchesInFlight_ == 0; });
+    }
+    
     if (database_ != nullptr) {
         database_->close();
         delete database_;
     }
     
+    if (pathFinder_ != nullptr) {
+        delete pathFinder_;
+    }
+    
 }
 
 
@@ -296,7 +395,10 @@ bool Controller::initialize(int argc, const char* argv[]) {
     };
     
     std::map<string, AbstractPathFinder*> pathFinders = {
-        {"UniformCostSearch", new UniformCostSearch()}
+        {"UniformCostSearch", new UniformCostSearch()},
+        {"HospitalRouteTree", new HospitalRouteTree()},
+        {"AStarSearch", new AStarSearch()},
+        {"ContractionHierarchySearch", new ContractionHierarchySearch()}
     };
     
     try {
@@ -306,6 +408,15 @@ bool Controller::initialize(int argc, const char* argv[]) {
         mapParser[interpreter.mapParser()]->parse(interpreter.map(), intersections_);
         database_ = configParser[interpreter.configParser()]->parse(interpreter.config(), intersections_);
         pathFinder_ = pathFinders[interpreter.searchAlgorithm()];
+        pathFinders.erase(interpreter.searchAlgorithm());
+        
+        //the hierarchy is kept next to the map file, so only the first run on a map has to build it
+        ContractionHierarchySearch* hierarchy = dynamic_cast<ContractionHierarchySearch*>(pathFinder_);
+        if (hierarchy != nullptr) {
+            hierarchy->setCacheFile(interpreter.map() + ".ch");
+        }
+        
+        pathFinder_->prepare(intersections_);
         
         database_->run();
         
@@ -326,12 +437,55 @@ bool Controller::initialize(int argc, const char* argv[]) {
     delete mapParser["QuickMapFileParser"];
     delete mapParser["ExplicitMapFileParser"];
     delete configParser["QuickDatabaseConfigParser"];
+    for (auto it = pathFinders.begin(); it != pathFinders.end(); ++it) {
+        delete it->second;
+    }
     
     return successful_initialization;
     
 }
 
 
+/** @fn configureLogging(size_t maxBatches)
+ *  @brief limits the batches of scores waiting to be written to the database, only possible before the controller runs
+ *  @param maxBatches the most batches handed to the shared pool and not written yet, further batches are dropped until one
+ *      is written. 0 for no limit
+ *  @return bool false if the controller is already running
+ */
+bool Controller::configureLogging(size_t maxBatches) {
+    
+    lock_guard<mutex> threadGuard(threadMutex_);
+    
+    if (thread_ != nullptr) {
+        return false;
+    }
+    
+    lock_guard<mutex> logGuard(logMutex_);
+    maxLogBatches_ = maxBatches;
+    return true;
+    
+}
+
+
+/** @fn configureExecution(int shards)
+ *  @brief sets how many shards the intersections are spread over on the shared pool, only possible before the controller runs
+ *  @param shards the number of shards, 0 for four per worker of the shared pool
+ *  @return bool false if the controller is already running
+ */
+bool Controller::configureExecution(int shards) {
+    
+    lock_guard<mutex> threadGuard(threadMutex_);
+    
+    if (thread_ != nullptr) {
+        return false;
+    }
+    
+    executionShards_ = shards;
+    return true;
+    
+}
+
+
 /** @fn logScore(traffictrack::IntersectionID ID, traffictrack::DateScorePair score)
  *  @brief puts a request to log a congestion score in the queue
  *  @param ID the id of the intersection requesting the operation
@@ -339,8 +493,10 @@ bool Controller::initialize(int argc, const char* argv[]) {
  */
 void Controller::logScore(traffictrack::IntersectionID ID, traffictrack::DateScorePair score) {
     
-    lock_guard<mutex> requestsGuard(dataRequestsMutex_);
-    dataRequests_.push(make_pair(ID, score));
+    //a full queue drops the score and counts it, the intersection never waits for the controller
+    if (dataRequests_.push(make_pair(ID, score))) {
+        notifyController();
+    }
     
 }
 
@@ -351,8 +507,8 @@ void Controller::logScore(traffictrack::IntersectionID ID, traffictrack::DateSco
  */
 void Controller::alertEmergencyVehicle(traffictrack::IntersectionID ID) {
     
-    lock_guard<mutex> alertGuard(emergencyAlertMutex_);
-    emergencyVehicleAlerts_.push(ID);
+    emergencyVehicleAlerts_.push(make_pair(ID, clock::now()));
+    notifyController();
     
 }
 
@@ -369,8 +525,12 @@ bool Controller::run() {
         thread_ = new thread(&Controller::manageRequests, this);
         running_ = true;
         
+        if (executor_ == nullptr) {
+            executor_ = new IntersectionExecutor(executionShards_);
+        }
+        
         for (auto it = intersections_.begin(); it != intersections_.end(); ++it) {
-            it->second->run();
+            it->second->runSharded(executor_);
         }
         
         return true;
@@ -400,4 +560,91 @@ void Controller::testController() {
     for (auto it = intersections_.begin(); it != intersections_.end(); ++it) {
         it->second->processImage();
     }
-}
\ No newline at end of file
+}
+
+
+/** @fn emergencyWakeLatency() const
+ *  @brief statistics of the time emergency alerts waited before the controller thread picked them up
+ *  @return Controller::WakeLatency
+ */
+Controller::WakeLatency Controller::emergencyWakeLatency() const {
+    
+    WakeLatency latency;
+    latency.alerts = emergencyAlertsHandled_;
+    latency.meanMicroseconds = latency.alerts > 0 ? static_cast<double>(emergencyWakeLatencyTotal_) / latency.alerts : 0;
+    latency.maxMicroseconds = emergencyWakeLatencyMax_;
+    return latency;
+    
+}
+
+
+/** @fn dataRequestCounters() const
+ *  @brief counters of the data log request queue, dropped counts the scores lost because the queue was full
+ *  @return MpscQueueCounters
+ */
+MpscQueueCounters Controller::dataRequestCounters() const {
+    return dataRequests_.counters();
+}
+
+
+/** @fn emergencyAlertCounters() const
+ *  @brief counters of the emergency alert queue, dropped counts the alerts that arrived while the ring was full
+ *  @return MpscQueueCounters
+ */
+MpscQueueCounters Controller::emergencyAlertCounters() const {
+    return emergencyVehicleAlerts_.counters();
+}
+
+
+/** @fn logMetrics() const
+ *  @brief queue wait and write times of the batches of scores written so far, other work on the shared pool is not
+ *      counted. maxQueued is the most batches that were waiting to be written at once
+ *  @return TaskPool::Metrics
+ */
+TaskPool::Metrics Controller::logMetrics() const {
+    
+    lock_guard<mutex> guard(logMutex_);
+    TaskPool::Metrics metrics = logMetrics_;
+    metrics.meanWaitMicroseconds = metrics.tasks > 0 ? static_cast<double>(logWaitTotal_) / metrics.tasks : 0;
+    metrics.meanRunMicroseconds = metrics.tasks > 0 ? static_cast<double>(logRunTotal_) / metrics.tasks : 0;
+    return metrics;
+    
+}
+
+
+/** @fn droppedLogScores() const
+ *  @brief scores of the batches dropped because too many batches were waiting to be written, the path finder still
+ *      got them. the scores dataRequests_ dropped are in dataRequestCounters()
+ *  @return long long
+ */
+long long Controller::droppedLogScores() const {
+    
+    lock_guard<mutex> guard(logMutex_);
+    return logScoresDropped_;
+    
+}
+
+
+/** @fn frameCounters() const
+ *  @brief totals of the quality gates of every camera, the frames they skipped were not run through yolo
+ *  @return Controller::FrameCounters
+ */
+Controller::FrameCounters Controller::frameCounters() const {
+    
+    FrameCounters counters = { 0, 0, { } };
+    for (auto it = intersections_.begin(); it != intersections_.end(); ++it) {
+        for (TrafficLight* light : it->second->getLights()) {
+            FrameQualityGate* gate = light->qualityGate();
+            if (gate == nullptr) {
+                continue;
+            }
+            counters.checked += gate->checked();
+            counters.skipped += gate->skipped();
+            for (int i = 0; i < FrameQuality::NUMBER_OF_QUALITIES; i++) {
+                counters.skippedFor[i] += gate->skipped(static_cast<FrameQuality>(i));
+            }
+        }
+    }
+    return counters;
+    
+}
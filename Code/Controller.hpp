@@ -10,9 +10,11 @@
 #define Controller_hpp
 
 #include <unordered_map>
-#include <queue>
+#include <vector>
 #include <utility>
 #include <mutex>
+#include <condition_variable>
+#include <atomic>
 #include <thread>
 #include <chrono>
 #include "Intersection.hpp"
@@ -22,6 +24,10 @@
 #include "DateScorePair.hpp"
 #include "AbstractStoppableThread.hpp"
 #include "AbstractTrafficLightScheduler.hpp"
+#include "MpscRingQueue.hpp"
+#include "TaskPool.hpp"
+#include "IntersectionExecutor.hpp"
+#include "FrameQuality.h"
 
 class AbstractTrafficLightScheduler;
 
@@ -36,38 +42,82 @@ private:
     Controller();
     static Controller* instance_; /**< static instance for singleton */
     
+public:
+    /** @struct WakeLatency
+     *  @brief time between an emergency alert being queued and the controller thread picking it up
+     */
+    struct WakeLatency {
+        long long alerts; /**< number of alerts handled */
+        double meanMicroseconds;
+        long long maxMicroseconds;
+    };
+    
+    /** @struct FrameCounters
+     *  @brief camera frames the quality gates of every intersection checked, and the ones they skipped for each reason
+     */
+    struct FrameCounters {
+        long long checked;
+        long long skipped; /**< for any reason */
+        long long skippedFor[traffictrack::FrameQuality::NUMBER_OF_QUALITIES]; /**< indexed by FrameQuality, always 0 for GOOD */
+    };
+    
+    typedef AbstractTrafficDatabase::LogRecord DataRequest;
+    typedef std::pair<traffictrack::IntersectionID, std::chrono::steady_clock::time_point> EmergencyAlert; /**< alert and the time it was queued */
+    
 protected:
-    std::mutex dataRequestsMutex_;
-    std::mutex emergencyAlertMutex_;
-    std::mutex timeCounterMutex_;
-    std::mutex timeCounterThreadMutex_;
+    typedef std::chrono::steady_clock clock;
+    std::mutex requestsMutex_; /**< only held by the controller thread around its wait, and briefly by producers to wake it */
+    std::condition_variable requestsCondition_; /**< wakes the controller thread when a request is queued or it is stopped */
+    std::atomic<bool> sleeping_; /**< set while the controller thread is (about to be) waiting on requestsCondition_ */
     std::unordered_map<traffictrack::IntersectionID, Intersection*> intersections_; /**< Intersections (nodes) for the graph */
     AbstractTrafficDatabase* database_; /**< database that stores the congestion scores of the intersections */
     AbstractPathFinder* pathFinder_;
-    std::queue<std::pair<traffictrack::IntersectionID, traffictrack::DateScorePair>> dataRequests_;
-    std::queue<traffictrack::IntersectionID> emergencyVehicleAlerts_;
-    std::vector<std::thread*> logThreads_;
-    int maxLogThreads_ = 10;
+    MpscRingQueue<DataRequest> dataRequests_; /**< drops new scores when full, a missed score only thins out the averages */
+    MpscRingQueue<EmergencyAlert> emergencyVehicleAlerts_; /**< sized far beyond any burst of alerts so none is dropped in practice, a drop is still counted */
+    const size_t maxBatch_ = 256; /**< most requests taken from a queue at once */
+    mutable std::mutex logMutex_; /**< synchronize access to the log batch members below */
+    std::condition_variable logCondition_; /**< signals the controller's destructor that a batch of scores was written */
+    size_t logBatchesInFlight_; /**< batches handed to the shared pool and not written yet */
+    size_t maxLogBatches_; /**< most batches in flight before new ones are dropped, 0 for no limit */
+    long long logScoresDropped_; /**< scores of the batches dropped because too many were in flight */
+    TaskPool::Metrics logMetrics_; /**< of the written batches, the means are worked out from the totals below */
+    long long logWaitTotal_; /**< microseconds */
+    long long logRunTotal_; /**< microseconds */
+    int executionShards_; /**< number of shards the intersections are spread over, 0 for the default */
+    IntersectionExecutor* executor_; /**< runs the intersections, created when the controller runs */
     std::chrono::seconds timeBetweenScheduleUpdates_;
-    std::chrono::seconds timeSinceLastUpdate_;
-    std::thread* timeCounterThread_;
+    clock::time_point nextScheduleUpdate_; /**< deadline of the next schedule update, only used by the controller thread */
     AbstractTrafficLightScheduler* scheduler;
+    AbstractTrafficLightScheduler::IntersectionSchedules schedules_; /**< latest schedule of every intersection, only used by the controller thread */
+    std::atomic<long long> emergencyAlertsHandled_;
+    std::atomic<long long> emergencyWakeLatencyTotal_; /**< microseconds */
+    std::atomic<long long> emergencyWakeLatencyMax_; /**< microseconds */
     
-    void handleDataLogRequest(traffictrack::IntersectionID ID, traffictrack::DateScorePair score);
-    void handleEmergencyAlert(traffictrack::IntersectionID ID);
-    void clearLogThreads();
+    void handleDataLogRequests(std::vector<DataRequest> requests);
+    void handleEmergencyAlerts(const std::vector<EmergencyAlert>& alerts);
+    void preemptLights(const std::vector<Intersection*>& path);
     void manageRequests();
-    void countTimeSinceLastUpdate();
     void updateSchedules();
+    void recordWakeLatency(clock::time_point queued);
+    void notifyController();
+    virtual void wakeUp();
     
 public:
     static Controller* instance();
     virtual ~Controller();
     bool initialize(int argc, const char* argv[]);
+    bool configureLogging(size_t maxBatches);
+    bool configureExecution(int shards);
     void logScore(traffictrack::IntersectionID ID, traffictrack::DateScorePair score);
     void alertEmergencyVehicle(traffictrack::IntersectionID ID);
     virtual bool run();
     void testController();
+    WakeLatency emergencyWakeLatency() const;
+    MpscQueueCounters dataRequestCounters() const;
+    MpscQueueCounters emergencyAlertCounters() const;
+    TaskPool::Metrics logMetrics() const;
+    long long droppedLogScores() const;
+    FrameCounters frameCounters() const;
     
 };
 
@@ -0,0 +1,84 @@
+//
+//  CoroutineSupport.hpp
+//  TraffikTrak
+//
+//  Created by Matt Lovick on 2026-10-19.
+//  Copyright © 2026 Matt Lovick. All rights reserved.
+//
+
+#ifndef CoroutineSupport_hpp
+#define CoroutineSupport_hpp
+
+//only part of the C++20 build (-DTRAFFICTRACK_COROUTINES=ON), the default C++14 build never includes it
+#ifdef TRAFFICTRACK_COROUTINES
+
+#include <coroutine>
+#include <exception>
+#include <functional>
+#include <utility>
+
+/** @class DetachedTask
+ *  @brief return type of a coroutine that nobody waits for. it starts running right away, and its frame frees itself when
+ *      the coroutine returns. a coroutine that might not finish must be resumed (i.e. at shutdown) or its frame leaks
+ *  @author Matthew Lovick
+ */
+class DetachedTask {
+
+public:
+    struct promise_type {
+        DetachedTask get_return_object() { return DetachedTask(); }
+        std::suspend_never initial_suspend() noexcept { return {}; }
+        std::suspend_never final_suspend() noexcept { return {}; }
+        void return_void() { }
+        void unhandled_exception() { std::terminate(); }
+    };
+
+};
+
+
+/** @class ResumeWith
+ *  @brief awaitable that hands the coroutine's resume function to a callable, which arranges for it to be called later:
+ *      on a shard, from a timer, from a completion callback. the callable returns false if it did not arrange anything,
+ *      the coroutine then continues right away. co_await returns what the callable returned
+ *
+ *  the resume function must run as a later task of the same IntersectionExecutor shard the coroutine is running on, never
+ *  inline and never on another thread, so it cannot run before await_suspend has returned
+ *  @author Matthew Lovick
+ */
+template <typename F>
+class ResumeWith {
+
+protected:
+    F start_;
+    bool suspended_;
+
+public:
+    explicit ResumeWith(F start) : start_(std::move(start)), suspended_(false) { }
+
+    bool await_ready() const noexcept {
+        return false;
+    }
+
+    bool await_suspend(std::coroutine_handle<> handle) {
+        suspended_ = start_(std::function<void()>([handle]() { handle.resume(); }));
+        return suspended_;
+    }
+
+    bool await_resume() const noexcept {
+        return suspended_;
+    }
+
+};
+
+
+/**
+ *  \brief builds a ResumeWith awaitable, so the type of the callable does not have to be spelled out
+ */
+template <typename F>
+ResumeWith<F> resumeWith(F start) {
+    return ResumeWith<F>(std::move(start));
+}
+
+#endif /* TRAFFICTRACK_COROUTINES */
+
+#endif /* CoroutineSupport_hpp */
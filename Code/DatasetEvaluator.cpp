@@ -0,0 +1,137 @@
+//
+//  DatasetEvaluator.cpp
+//  TraffikTrak
+//
+//  Created by Matt Lovick on 2026-10-19.
+//  Copyright © 2026 Matt Lovick. All rights reserved.
+//
+
+#include <string>
+#include <vector>
+#include <deque>
+#include <future>
+#include <chrono>
+#include <fstream>
+#include <algorithm>
+#include "DatasetEvaluator.hpp"
+#include "InferencePool.hpp"
+#include "ProcessedImage.hpp"
+#include "IOException.hpp"
+
+using namespace std;
+using namespace std::chrono;
+
+
+/** @fn findImages(const std::string& directory) const
+ *  @brief finds every photo in the directory and its subdirectories
+ *  @param directory the root of the directory tree
+ *  @return std::vector<std::string> the file names sorted so the CSV rows are in a stable order
+ */
+std::vector<std::string> DatasetEvaluator::findImages(const std::string& directory) const {
+
+    vector<string> images;
+
+    for (const string& extension : extensions_) {
+        vector<cv::String> found;
+        cv::glob(directory + "/*." + extension, found, true);
+        images.insert(images.end(), found.begin(), found.end());
+    }
+
+    sort(images.begin(), images.end());
+    images.erase(unique(images.begin(), images.end()), images.end());
+    return images;
+
+}
+
+
+/** @fn DatasetEvaluator()
+ *  @brief constructor sets the photo extensions and keeps 4 photos per worker in flight
+ */
+DatasetEvaluator::DatasetEvaluator() {
+
+    extensions_ = { "jpg", "jpeg", "png" };
+    maxInFlight_ = 4 * InferencePool::instance()->threads();
+
+}
+
+
+/** @fn ~DatasetEvaluator()
+ *  @brief destructor does nothing
+ */
+DatasetEvaluator::~DatasetEvaluator() { }
+
+
+/** @fn evaluate(const std::string& directory, const std::string& csvFile)
+ *  @brief processes every photo in the directory tree and writes one CSV row per photo
+ *  @param directory the root of the directory tree
+ *  @param csvFile the file the results are written to
+ *  @return DatasetEvaluator::Summary the aggregate results
+ */
+DatasetEvaluator::Summary DatasetEvaluator::evaluate(const std::string& directory, const std::string& csvFile) {
+
+    vector<string> images = findImages(directory);
+    if (images.empty()) {
+        throw IOException("no photos found in " + directory);
+    }
+
+    ofstream out(csvFile);
+    if (!out.is_open()) {
+        throw IOException("file " + csvFile + " could not be opened");
+    }
+
+    out << "image,objects,vehicles,left,straight,right,decode_ms,preprocess_ms,forward_ms,decode_outputs_ms,nms_ms,counting_ms,total_ms" << endl;
+
+    InferencePool* pool = InferencePool::instance();
+    Summary summary;
+    double totalLatency = 0;
+
+    steady_clock::time_point start = steady_clock::now();
+
+    //submit photos while keeping at most maxInFlight_ outstanding, and write the results in submission order
+    deque<pair<string, future<timed_detection>>> inFlight;
+    size_t next = 0;
+
+    while (next < images.size() || !inFlight.empty()) {
+
+        while (next < images.size() && static_cast<int>(inFlight.size()) < maxInFlight_) {
+            inFlight.push_back(make_pair(images[next], pool->detectTimed(images[next])));
+            next++;
+        }
+
+        string image = inFlight.front().first;
+        timed_detection detection = inFlight.front().second.get();
+        inFlight.pop_front();
+
+        steady_clock::time_point countStart = steady_clock::now();
+        vector<int> lanes = ProcessedImage::countLanes(detection.objects);
+        double counting = duration<double, milli>(steady_clock::now() - countStart).count();
+
+        int vehicles = lanes[0] + lanes[1] + lanes[2];
+        double total = detection.decode + detection.timings.preprocess + detection.timings.forward + detection.timings.decode + detection.timings.nms + counting;
+
+        //quote the file name, it may contain commas
+        string quoted = image;
+        for (size_t pos = quoted.find('"'); pos != string::npos; pos = quoted.find('"', pos + 2)) {
+            quoted.insert(pos, "\"");
+        }
+
+        out << "\"" << quoted << "\"," << detection.objects.size() << "," << vehicles << "," << lanes[0] << "," << lanes[1] << "," << lanes[2] << ","
+            << detection.decode << "," << detection.timings.preprocess << "," << detection.timings.forward << ","
+            << detection.timings.decode << "," << detection.timings.nms << "," << counting << "," << total << "\n";
+
+        summary.images++;
+        if (!detection.readable) {
+            summary.unreadable++;
+        }
+        summary.vehicles += vehicles;
+        totalLatency += total;
+
+    }
+
+    summary.seconds = duration<double>(steady_clock::now() - start).count();
+    summary.imagesPerSecond = summary.seconds > 0 ? summary.images / summary.seconds : 0;
+    summary.meanLatency = summary.images > 0 ? totalLatency / summary.images : 0;
+
+    return summary;
+
+}
@@ -0,0 +1,50 @@
+//
+//  DatasetEvaluator.hpp
+//  TraffikTrak
+//
+//  Created by Matt Lovick on 2026-10-19.
+//  Copyright © 2026 Matt Lovick. All rights reserved.
+//
+
+#ifndef DatasetEvaluator_hpp
+#define DatasetEvaluator_hpp
+
+#include <string>
+#include <vector>
+
+/** @class DatasetEvaluator
+ *  @brief runs every photo in a directory tree through the computer vision pipeline without a display and writes the results to a CSV file
+ *
+ *  one row is written per photo with the number of objects and vehicles found, the vehicles per lane and the time spent in each stage.
+ *  photos are processed on all workers of the InferencePool, with a bounded number in flight so any size of archive can be evaluated
+ *  @author Matthew Lovick
+ */
+class DatasetEvaluator {
+    
+public:
+    /** @struct Summary
+     *  @brief aggregate results of an evaluation
+     */
+    struct Summary {
+        int images = 0; /**< number of photos processed */
+        int unreadable = 0; /**< photos that could not be decoded */
+        long vehicles = 0; /**< vehicles counted across all photos */
+        double seconds = 0; /**< wall time of the evaluation */
+        double imagesPerSecond = 0; /**< aggregate throughput */
+        double meanLatency = 0; /**< mean time in milliseconds spent on one photo by a worker */
+    };
+    
+protected:
+    std::vector<std::string> extensions_; /**< photo file extensions that are evaluated */
+    int maxInFlight_; /**< photos submitted to the pool but not yet written */
+    
+    std::vector<std::string> findImages(const std::string& directory) const;
+    
+public:
+    DatasetEvaluator();
+    virtual ~DatasetEvaluator();
+    Summary evaluate(const std::string& directory, const std::string& csvFile);
+    
+};
+
+#endif /* DatasetEvaluator_hpp */
@@ -23,6 +23,11 @@ namespace traffictrack {
         
     public:
         using pair<std::string, CongestionScore>::pair;
+        DateScorePair() = default;
+        DateScorePair(const DateScorePair&) = default;
+        DateScorePair(DateScorePair&&) = default; //the virtual destructor would otherwise turn every move into a copy
+        DateScorePair& operator = (const DateScorePair&) = default;
+        DateScorePair& operator = (DateScorePair&&) = default;
         virtual ~DateScorePair(){};
         
     };
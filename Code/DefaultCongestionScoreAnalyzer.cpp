@@ -71,8 +71,9 @@ void DefaultCongestionScoreAnalyzer::analyze(traffictrack::CongestionScore score
     float ratio = intersection->state_->trafficRatio(northSouthTraffic, eastWestTraffic);
     
     
+    //the change runs on the shared TaskPool, so the caller does not wait out the yellow light
     if (ratio >= criticalRatio) {
-        intersection->changeLights();
+        intersection->changeLightsSoon();
     }
     
 }
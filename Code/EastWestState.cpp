@@ -6,7 +6,6 @@
 //  Copyright © 2020 Matt Lovick. All rights reserved.
 //
 
-#include <thread>
 #include <mutex>
 #include "EastWestState.hpp"
 #include "Intersection.hpp"
@@ -19,33 +18,33 @@
 EastWestState::~EastWestState() { }
 
 
-/** @fn changeLights(Intersection* intersection)
- *  @brief changes the state of the intersection by changing the interval time and changing the lights
+/** @fn beginChange(Intersection* intersection)
+ *  @brief turns the east/west lights yellow without waiting
  *  @param intersection the intersection that owns this state object
  */
-void EastWestState::changeLights(Intersection* intersection) {
-    
-    std::thread* eastLight;
-    std::thread* westLight;
+void EastWestState::beginChange(Intersection* intersection) {
     
     std::lock_guard<std::mutex> lightsGuard(intersection->lightsMutex_);
-    //change the green lights to red
-    //since they turn yellow first and wait for a few seconds, use threads to do this in parallel
-    eastLight = new std::thread(&TrafficLight::changeLight, intersection->lights_[1]);
-    westLight = new std::thread(&TrafficLight::changeLight, intersection->lights_[3]);
-    
-    eastLight->join();
-    westLight->join();
+    intersection->lights_[1]->beginChange();
+    intersection->lights_[3]->beginChange();
     
-    delete eastLight;
-    delete westLight;
+}
+
+
+/** @fn finishChange(Intersection* intersection)
+ *  @brief turns the yellow east/west lights red and the north/south lights green, once the lights have been yellow long enough
+ *  @param intersection the intersection that owns this state object
+ */
+void EastWestState::finishChange(Intersection* intersection) {
     
-    //now that the other lights are red, make the east/west lights green
+    std::lock_guard<std::mutex> lightsGuard(intersection->lightsMutex_);
+    intersection->lights_[1]->finishChange();
+    intersection->lights_[3]->finishChange();
     intersection->lights_[0]->changeLight();
     intersection->lights_[2]->changeLight();
     
     std::lock_guard<std::mutex> nextStateGuard(intersection->nextStateMutex_);
-    intersection->nextState_ = new NorthSouthState(intersection->northSouthIntervalTime_);
+    intersection->nextState_ = new NorthSouthState(intersection->currentIntervals().first);
     
 }
 
@@ -23,7 +23,8 @@ class EastWestState : public AbstractIntersectionState {
 public:
     using AbstractIntersectionState::AbstractIntersectionState;
     virtual ~EastWestState();
-    virtual void changeLights(Intersection* intersection);
+    virtual void beginChange(Intersection* intersection);
+    virtual void finishChange(Intersection* intersection);
     virtual float trafficRatio(int northSouthTraffic, int eastWestTraffic);
     
 };
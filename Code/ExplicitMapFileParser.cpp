@@ -8,14 +8,9 @@
 
 
 #include <string>
-#include <vector>
-#include <fstream>
-#include <sstream>
 #include <unordered_map>
-#include <string>
 #include "ExplicitMapFileParser.hpp"
-#include "Road.hpp"
-#include "IOException.hpp"
+#include "MapFileReader.hpp"
 #include "FormatException.hpp"
 #include "IntersectionID.h"
 #include "Intersection.hpp"
@@ -41,91 +36,42 @@ void ExplicitMapFileParser::parse(const std::string filename, std::unordered_map
     
     intersections.clear();
     
-    ifstream inFile;
-    inFile.open(filename);
+    //throws IOException if the file cannot be opened
+    MapFileReader reader(filename);
+    
+    int number_of_intersections = -1;
+    
+    if (!reader.nextLine() || !reader.readInt(number_of_intersections) || number_of_intersections < 0) {
+        throw FormatException("invalid number of intersections specified in " + reader.where());
+    }
+    
+    intersections.reserve(static_cast<size_t>(number_of_intersections));
+    int ID = -1;
     
-    if (inFile.is_open()) {
+    for (int i = 0; i < number_of_intersections; i++) {
         
-        int number_of_intersections;
-        inFile >> number_of_intersections;
-        inFile.ignore();
+        if (!reader.nextLine()) {
+            throw FormatException("invalid number of intersection IDs specified in " + reader.where());
+        }
         
-        string intersection_ID;
-        IntersectionID ID;
+        if (!reader.readInt(ID)) {
+            throw FormatException("invalid intersection ID in " + reader.where());
+        }
         
-        for (int i = 0; i < number_of_intersections; i++) {
-            
-            if (!getline(inFile, intersection_ID)) {
-                throw FormatException("invalid number of intersection IDs specified");
-            }
-            
-            istringstream ss(intersection_ID);
-            
-            if (!(ss >> ID)) {
-                throw FormatException("invalid intersection ID");
-            }
-            
-            intersections.insert( { ID, new Intersection(ID) } );
-            
-            if (i == 0) {
-                intersections[ID]->setHospital(true);
-            }
-            
+        //an ID listed twice keeps its first intersection
+        if (intersections.find(IntersectionID(ID)) != intersections.end()) {
+            continue;
         }
         
+        Intersection* intersection = new Intersection(IntersectionID(ID));
+        intersections.insert( { IntersectionID(ID), intersection } );
         
-        string road_input;
-        IntersectionID first(-1), second(-1);
-        float distance = -1;
-        char char_direction = ' ';
-        string str_direction = " ";
-        Direction direction = Direction::DEFAULT;
-        while (getline(inFile, road_input, '\n')) {
-            
-            istringstream ss(road_input);
-            
-            ss >> first;
-            ss >> second;
-            ss >> distance;
-            ss >> str_direction;
-            
-            char_direction = str_direction[0];
-            char_direction = static_cast<char>(tolower(static_cast<unsigned char>(char_direction)));
-            
-            switch (char_direction) {
-                case 'n':
-                    direction = Direction::NORTH;
-                    break;
-                case 'e':
-                    direction = Direction::EAST;
-                    break;
-                case 's':
-                    direction = Direction::SOUTH;
-                    break;
-                case 'w':
-                    direction = Direction::WEST;
-                    break;
-                default:
-                    direction = Direction::DEFAULT;
-            }
-            
-            if (intersections.find(first) == intersections.end() || intersections.find(second) == intersections.end() || distance < 0 || direction == Direction::DEFAULT) {
-                inFile.close();
-                throw FormatException("improper file formate in " + filename);
-            }
-            
-            intersections.at(first)->addRoad(intersections[first], intersections[second], distance, direction);
-            
-            int value = static_cast<int>(direction);
-            value = (value+2)%4;
-            Direction reverse_direction = static_cast<Direction>(value);
-            
-            intersections.at(second)->addRoad(intersections[second], intersections[first], distance, reverse_direction);
-            
+        if (i == 0) {
+            intersection->setHospital(true);
         }
         
-    } else {
-        throw IOException("file " + filename + " not found");
     }
     
+    parseRoads(reader, intersections);
+    
 }
@@ -0,0 +1,24 @@
+//
+//  FrameQuality.h
+//  TraffikTrak
+//
+//  Created by Matt Lovick on 2026-10-19.
+//  Copyright © 2026 Matt Lovick. All rights reserved.
+//
+
+#ifndef FrameQuality_h
+#define FrameQuality_h
+
+namespace traffictrack {
+    
+    /**  @enum FrameQuality
+     *   @brief result of checking a camera frame before inference. anything but GOOD means the frame is skipped
+     *   @author Matthew Lovick
+     */
+    enum FrameQuality {
+        GOOD, UNREADABLE, BLANK, UNDEREXPOSED, OVEREXPOSED, BLURRY, FROZEN, NUMBER_OF_QUALITIES
+    };
+    
+}
+
+#endif /* FrameQuality_h */
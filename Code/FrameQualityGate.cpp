@@ -0,0 +1,190 @@
+//
+//  FrameQualityGate.cpp
+//  TraffikTrak
+//
+//  Created by Matt Lovick on 2026-10-19.
+//  Copyright © 2026 Matt Lovick. All rights reserved.
+//
+
+#include <mutex>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <opencv2/imgproc.hpp>
+#include "FrameQualityGate.hpp"
+#include "FrameQuality.h"
+
+using namespace std;
+using namespace traffictrack;
+
+
+//width of the thumbnail the checks run on, small enough that the checks cost a fraction of a millisecond
+static const int THUMBNAIL_WIDTH = 160;
+
+
+/** @fn contentHash(const cv::Mat& frame) const
+ *  @brief 64 bit hash of every byte of the full resolution frame, 8 bytes at a time
+ *  @param frame the decoded camera frame
+ *  @return uint64_t the hash, a frame that differs in a single pixel gets a different hash
+ */
+uint64_t FrameQualityGate::contentHash(const cv::Mat& frame) const {
+    
+    const size_t rowBytes = frame.cols * frame.elemSize();
+    uint64_t hash = 14695981039346656037ull ^ (static_cast<uint64_t>(frame.rows) << 32 | static_cast<uint32_t>(frame.cols));
+    
+    for (int row = 0; row < frame.rows; row++) {
+        const unsigned char* bytes = frame.ptr<unsigned char>(row);
+        size_t i = 0;
+        for (; i + 8 <= rowBytes; i += 8) {
+            uint64_t word;
+            memcpy(&word, bytes + i, 8);
+            hash = (hash ^ word) * 0x9E3779B97F4A7C15ull;
+            hash ^= hash >> 32;
+        }
+        for (; i < rowBytes; i++) {
+            hash = (hash ^ bytes[i]) * 1099511628211ull;
+        }
+    }
+    return hash;
+    
+}
+
+
+/** @fn FrameQualityGate(double blurThreshold, double darkThreshold, double brightThreshold, double saturatedFraction, double blankThreshold, int frozenFrames)
+ *  @brief constructor sets the thresholds of the checks
+ *  @param blurThreshold minimum variance of the laplacian of the thumbnail
+ *  @param darkThreshold minimum mean brightness (0-255)
+ *  @param brightThreshold maximum mean brightness (0-255)
+ *  @param saturatedFraction maximum fraction of pixels at 250 or above
+ *  @param blankThreshold minimum standard deviation of the brightness
+ *  @param frozenFrames number of byte for byte identical frames in a row that counts as a frozen camera
+ */
+FrameQualityGate::FrameQualityGate(double blurThreshold, double darkThreshold, double brightThreshold, double saturatedFraction, double blankThreshold, int frozenFrames) : blurThreshold_(blurThreshold), darkThreshold_(darkThreshold), brightThreshold_(brightThreshold), saturatedFraction_(saturatedFraction), blankThreshold_(blankThreshold), frozenFrames_(frozenFrames), lastHash_(0), repeats_(0), checked_(0) {
+    
+    for (int i = 0; i < FrameQuality::NUMBER_OF_QUALITIES; i++) {
+        skipped_[i] = 0;
+    }
+    
+}
+
+
+/** @fn ~FrameQualityGate()
+ *  @brief destructor does nothing
+ */
+FrameQualityGate::~FrameQualityGate() { }
+
+
+/** @fn check(const cv::Mat& frame)
+ *  @brief checks whether the frame is worth sending through yolo and counts the frames that are skipped
+ *  @param frame the decoded camera frame
+ *  @return traffictrack::FrameQuality GOOD, or the first reason the frame should be skipped
+ */
+traffictrack::FrameQuality FrameQualityGate::check(const cv::Mat& frame) {
+    
+    checked_++;
+    FrameQuality quality = FrameQuality::GOOD;
+    
+    if (frame.empty()) {
+        quality = FrameQuality::UNREADABLE;
+    }
+    else {
+        
+        //all checks run on a small grayscale copy
+        cv::Mat gray, thumbnail;
+        if (frame.channels() == 1) {
+            gray = frame;
+        }
+        else {
+            cv::cvtColor(frame, gray, cv::COLOR_BGR2GRAY);
+        }
+        int height = std::max(1, gray.rows * THUMBNAIL_WIDTH / std::max(1, gray.cols));
+        cv::resize(gray, thumbnail, cv::Size(THUMBNAIL_WIDTH, height), 0, 0, cv::INTER_AREA);
+        
+        //brightness statistics in one pass over the thumbnail
+        double sum = 0, sumOfSquares = 0;
+        long saturated = 0;
+        for (int row = 0; row < thumbnail.rows; row++) {
+            const unsigned char* pixels = thumbnail.ptr<unsigned char>(row);
+            for (int col = 0; col < thumbnail.cols; col++) {
+                sum += pixels[col];
+                sumOfSquares += pixels[col] * pixels[col];
+                if (pixels[col] >= 250) {
+                    saturated++;
+                }
+            }
+        }
+        double count = std::max(1, thumbnail.rows * thumbnail.cols);
+        double mean = sum / count;
+        double deviation = std::sqrt(std::max(0.0, sumOfSquares / count - mean * mean));
+        
+        if (deviation < blankThreshold_) {
+            quality = FrameQuality::BLANK;
+        }
+        else if (mean < darkThreshold_) {
+            quality = FrameQuality::UNDEREXPOSED;
+        }
+        else if (mean > brightThreshold_ || saturated / count > saturatedFraction_) {
+            quality = FrameQuality::OVEREXPOSED;
+        }
+        else {
+            cv::Mat laplacian;
+            cv::Scalar laplacianMean, laplacianDeviation;
+            cv::Laplacian(thumbnail, laplacian, CV_64F);
+            cv::meanStdDev(laplacian, laplacianMean, laplacianDeviation);
+            if (laplacianDeviation[0] * laplacianDeviation[0] < blurThreshold_) {
+                quality = FrameQuality::BLURRY;
+            }
+        }
+        
+        //a camera that keeps sending the same picture is frozen, whatever the picture looks like. the thumbnail would
+        //smooth away the sensor noise that tells a live camera on a quiet road apart, so the whole frame is compared
+        uint64_t hash = contentHash(frame);
+        lock_guard<mutex> guard(hashMutex_);
+        repeats_ = (hash == lastHash_) ? repeats_ + 1 : 0;
+        lastHash_ = hash;
+        if (quality == FrameQuality::GOOD && repeats_ + 1 >= frozenFrames_) {
+            quality = FrameQuality::FROZEN;
+        }
+        
+    }
+    
+    if (quality != FrameQuality::GOOD) {
+        skipped_[quality]++;
+    }
+    return quality;
+    
+}
+
+
+/** @fn checked() const
+ *  @brief getter for the number of frames checked
+ *  @return long
+ */
+long FrameQualityGate::checked() const {
+    return checked_;
+}
+
+
+/** @fn skipped() const
+ *  @brief the number of frames that were skipped for any reason
+ *  @return long
+ */
+long FrameQualityGate::skipped() const {
+    
+    long total = 0;
+    for (int i = 0; i < FrameQuality::NUMBER_OF_QUALITIES; i++) {
+        total += skipped_[i];
+    }
+    return total;
+    
+}
+
+
+/** @fn skipped(traffictrack::FrameQuality reason) const
+ *  @brief the number of frames skipped for the given reason
+ *  @param reason the reason the frames were skipped
+ *  @return long
+ */
+long FrameQualityGate::skipped(traffictrack::FrameQuality reason) const {
+    return skipped_[reason];
+}
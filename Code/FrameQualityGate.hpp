@@ -0,0 +1,55 @@
+//
+//  FrameQualityGate.hpp
+//  TraffikTrak
+//
+//  Created by Matt Lovick on 2026-10-19.
+//  Copyright © 2026 Matt Lovick. All rights reserved.
+//
+
+#ifndef FrameQualityGate_hpp
+#define FrameQualityGate_hpp
+
+#include <mutex>
+#include <atomic>
+#include <cstdint>
+#include <opencv2/imgproc.hpp>
+#include "FrameQuality.h"
+
+/** @class FrameQualityGate
+ *  @brief cheap check run on a camera frame before it is sent through yolo, flagging frames that would only produce a garbage score
+ *
+ *  the checks run on a small grayscale thumbnail: blank frames (no contrast), under/over exposure (night, glare) and
+ *  blur (low variance of the laplacian, e.g. a rain smeared lens). frozen frames are the exact same full resolution
+ *  frame several times in a row: a working camera pointed at an empty road still has sensor noise, so only a camera
+ *  that keeps resending one picture repeats every byte. each camera owns one gate, since the frozen frame check compares
+ *  against that camera's previous frames
+ *  @author Matthew Lovick
+ */
+class FrameQualityGate {
+
+protected:
+    const double blurThreshold_; /**< minimum variance of the laplacian of the thumbnail */
+    const double darkThreshold_; /**< minimum mean brightness */
+    const double brightThreshold_; /**< maximum mean brightness */
+    const double saturatedFraction_; /**< maximum fraction of pixels that are blown out */
+    const double blankThreshold_; /**< minimum standard deviation of the brightness */
+    const int frozenFrames_; /**< number of identical frames in a row that counts as frozen */
+    std::mutex hashMutex_; /**< synchronize access to lastHash_ and repeats_ */
+    uint64_t lastHash_; /**< contentHash() of the previous frame */
+    int repeats_;
+    std::atomic<long> checked_;
+    std::atomic<long> skipped_[traffictrack::FrameQuality::NUMBER_OF_QUALITIES];
+
+    uint64_t contentHash(const cv::Mat& frame) const;
+
+public:
+    FrameQualityGate(double blurThreshold = 30, double darkThreshold = 35, double brightThreshold = 220, double saturatedFraction = 0.4, double blankThreshold = 4, int frozenFrames = 3);
+    virtual ~FrameQualityGate();
+    traffictrack::FrameQuality check(const cv::Mat& frame);
+    long checked() const;
+    long skipped() const;
+    long skipped(traffictrack::FrameQuality reason) const;
+
+};
+
+#endif /* FrameQualityGate_hpp */
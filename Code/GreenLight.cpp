@@ -24,15 +24,47 @@ using namespace std::this_thread;
 GreenLight::~GreenLight() { }
 
 
+/** @fn yellowTime()
+ *  @brief how long the light stays yellow when it changes from green to red
+ *  @return std::chrono::seconds
+ */
+std::chrono::seconds GreenLight::yellowTime() {
+    return seconds(3);
+}
+
+
 /** @fn changeLight(TrafficLight* light)
- *  @brief changes the light from green light to red light in the given traffic light
+ *  @brief changes the light from green light to red light in the given traffic light, blocking while the light is yellow
  *  @param light the light whose state this is, that needs to be updated
  */
 void GreenLight::changeLight(TrafficLight* light) {
     
+    beginChange(light);
+    sleep_for(yellowTime());
+    finishChange(light);
+    
+}
+
+
+/** @fn beginChange(TrafficLight* light)
+ *  @brief turns the light yellow
+ *  @param light the light whose state this is, that needs to be updated
+ */
+void GreenLight::beginChange(TrafficLight* light) {
+    
     lock_guard<mutex> colourGuard(light->colourMutex_);
     light->colour_ = traffictrack::LightColour::YELLOW;
-    sleep_for(seconds(3));
+    
+}
+
+
+/** @fn finishChange(TrafficLight* light)
+ *  @brief turns the light red, once it has been yellow for yellowTime()
+ *  @param light the light whose state this is, that needs to be updated
+ */
+void GreenLight::finishChange(TrafficLight* light) {
+    
+    lock_guard<mutex> colourGuard(light->colourMutex_);
     light->colour_ = traffictrack::LightColour::RED;
     lock_guard<mutex> nextStateGuard(light->nextStateMutex_);
     light->nextState_ = new RedLight();
@@ -9,6 +9,7 @@
 #ifndef GreenLight_hpp
 #define GreenLight_hpp
 
+#include <chrono>
 #include "AbstractTrafficLightState.hpp"
 
 /** @class GreenLight
@@ -19,7 +20,10 @@ class GreenLight : public AbstractTrafficLightState {
     
 public:
     virtual ~GreenLight();
+    static std::chrono::seconds yellowTime();
     virtual void changeLight(TrafficLight* light);
+    virtual void beginChange(TrafficLight* light);
+    virtual void finishChange(TrafficLight* light);
 
 };
 
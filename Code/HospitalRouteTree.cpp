@@ -0,0 +1,369 @@
+//
+//  HospitalRouteTree.cpp
+//  TraffikTrak
+//
+//  Created by Matt Lovick on 2026-10-19.
+//  Copyright © 2026 Matt Lovick. All rights reserved.
+//
+
+#include <vector>
+#include <unordered_map>
+#include <utility>
+#include <algorithm>
+#include "HospitalRouteTree.hpp"
+#include "Intersection.hpp"
+#include "IntersectionID.h"
+#include "CongestionScore.hpp"
+#include "DateScorePair.hpp"
+#include "RoadGraph.hpp"
+#include "NodeHeap.hpp"
+#include "TaskPool.hpp"
+
+using namespace std;
+using namespace traffictrack;
+
+
+/** @fn HospitalRouteTree(float delayPerVehicle, int maxVehicles)
+ *  @brief constructor, the tree is built by prepare() or by the first search
+ *  @param delayPerVehicle how much longer each vehicle waiting at an intersection makes the roads to it, 0 to ignore congestion
+ *  @param maxVehicles vehicles beyond this many make no difference
+ */
+HospitalRouteTree::HospitalRouteTree(float delayPerVehicle, int maxVehicles) : delayPerVehicle_(delayPerVehicle), maxVehicles_(maxVehicles) { }
+
+
+/** @fn ~HospitalRouteTree()
+ *  @brief destructor that does nothing
+ */
+HospitalRouteTree::~HospitalRouteTree() { }
+
+
+/** @fn delay(const traffictrack::CongestionScore& score) const
+ *  @brief what the length of the roads to an intersection is multiplied by, given the vehicles waiting in all its lanes
+ *  @param score the congestion score of the intersection
+ *  @return float 1 for an empty intersection
+ */
+float HospitalRouteTree::delay(const traffictrack::CongestionScore& score) const {
+    
+    int vehicles = 0;
+    for (const vector<int>* lanes : { &score.getNorth(), &score.getSouth(), &score.getEast(), &score.getWest() }) {
+        for (int count : *lanes) {
+            vehicles += max(0, count);
+        }
+    }
+    
+    return 1 + delayPerVehicle_ * min(vehicles, maxVehicles_);
+    
+}
+
+
+/** @fn cost(int road) const
+ *  @brief the length of a road of graph_ with the delay at its end
+ *  @return float
+ */
+float HospitalRouteTree::cost(int road) const {
+    return graph_.length(road) * delay_[graph_.target(road)];
+}
+
+
+/** @fn build(std::unordered_map<traffictrack::IntersectionID, Intersection*>& intersections)
+ *  @brief works out the next road towards the nearest hospital for every intersection
+ *
+ *  the roads are one way, so the search runs backwards: it starts from all the hospitals at distance 0 and follows each
+ *  road from its end to its start. the first time an intersection is taken off the queue its distance is final, and the
+ *  road that got there leads to the nearest hospital
+ *  @param intersections the map
+ */
+void HospitalRouteTree::build(std::unordered_map<traffictrack::IntersectionID, Intersection*>& intersections) {
+    
+    graph_ = RoadGraph(intersections);
+    incoming_ = graph_.reversed();
+    const int size = graph_.size();
+    
+    next_.assign(size, -1);
+    distance_.assign(size, -1);
+    lost_.assign(size, false);
+    queue_.resize(size);
+    
+    delay_.assign(size, 1);
+    for (auto it = delays_.begin(); it != delays_.end(); ++it) {
+        auto intersection = intersections.find(it->first);
+        int node = intersection != intersections.end() ? graph_.index(intersection->second) : -1;
+        if (node >= 0) {
+            delay_[node] = it->second;
+        }
+    }
+    
+    for (int i = 0; i < size; i++) {
+        if (graph_.hospital(i)) {
+            distance_[i] = 0;
+            queue_.push(i, 0);
+        }
+    }
+    
+    settle();
+    
+}
+
+
+/** @fn settle()
+ *  @brief takes the intersections off the queue in order of distance and passes their distance on along the roads
+ *      arriving at them, until the queue is empty
+ */
+void HospitalRouteTree::settle() {
+    
+    while (!queue_.empty()) {
+        
+        const int current = queue_.pop();
+        
+        for (int slot = incoming_.firstRoad(current); slot < incoming_.endRoad(current); slot++) {
+            
+            int u = incoming_.target(slot);
+            int road = incoming_.original(slot);
+            float distance = distance_[current] + cost(road);
+            
+            if (distance_[u] < 0 || distance < distance_[u]) {
+                distance_[u] = distance;
+                next_[u] = road;
+                queue_.push(u, distance);
+            }
+            
+        }
+        
+    }
+    
+}
+
+
+/** @fn prepare(std::unordered_map<traffictrack::IntersectionID, Intersection*>& intersections)
+ *  @brief builds the tree ahead of the first search
+ *  @param intersections the map
+ */
+void HospitalRouteTree::prepare(std::unordered_map<traffictrack::IntersectionID, Intersection*>& intersections) {
+    build(intersections);
+}
+
+
+/** @fn updateCongestion(const std::vector<std::pair<traffictrack::IntersectionID, traffictrack::DateScorePair>>& scores, std::unordered_map<traffictrack::IntersectionID, Intersection*>& intersections)
+ *  @brief changes the cost of the roads to the intersections that logged a score, and repairs the part of the tree that changed
+ *  @param scores the latest scores, an intersection that is in it more than once gets the last one
+ *  @param intersections the map
+ */
+void HospitalRouteTree::updateCongestion(const std::vector<std::pair<traffictrack::IntersectionID, traffictrack::DateScorePair>>& scores, std::unordered_map<traffictrack::IntersectionID, Intersection*>& intersections) {
+    
+    const bool current = graph_.current();
+    
+    //the intersections whose delay changed and the delay the tree was built with. lost_ marks the ones seen so far, so
+    //an intersection that is in the batch twice keeps its first old delay
+    vector<pair<int, float>> changes;
+    
+    for (const pair<IntersectionID, DateScorePair>& score : scores) {
+        
+        float delay = this->delay(score.second.second);
+        if (delay != 1) {
+            delays_[score.first] = delay;
+        }
+        else {
+            delays_.erase(score.first);
+        }
+        
+        auto intersection = intersections.find(score.first);
+        int node = current && intersection != intersections.end() ? graph_.index(intersection->second) : -1;
+        if (node < 0 || delay == delay_[node]) {
+            continue;
+        }
+        
+        if (!lost_[node]) {
+            lost_[node] = true;
+            changes.push_back(make_pair(node, delay_[node]));
+        }
+        delay_[node] = delay;
+        
+    }
+    
+    //a changed map needs a new tree anyway, which picks up the delays
+    if (!current) {
+        build(intersections);
+        return;
+    }
+    
+    for (const pair<int, float>& change : changes) {
+        lost_[change.first] = false;
+    }
+    
+    //a road that got more expensive and is part of the tree makes the intersection it starts from lose its distance, and
+    //with it every intersection whose way to a hospital went through there
+    affected_.clear();
+    for (const pair<int, float>& change : changes) {
+        
+        if (delay_[change.first] <= change.second) {
+            continue;
+        }
+        
+        for (int slot = incoming_.firstRoad(change.first); slot < incoming_.endRoad(change.first); slot++) {
+            int u = incoming_.target(slot);
+            if (next_[u] == incoming_.original(slot) && !lost_[u]) {
+                lost_[u] = true;
+                affected_.push_back(u);
+            }
+        }
+        
+    }
+    
+    for (size_t i = 0; i < affected_.size(); i++) {
+        
+        const int v = affected_[i];
+        for (int slot = incoming_.firstRoad(v); slot < incoming_.endRoad(v); slot++) {
+            int u = incoming_.target(slot);
+            if (next_[u] == incoming_.original(slot) && !lost_[u]) {
+                lost_[u] = true;
+                affected_.push_back(u);
+            }
+        }
+        
+    }
+    
+    for (int v : affected_) {
+        distance_[v] = -1;
+        next_[v] = -1;
+    }
+    
+    //the affected intersections start from their best road into the rest of the tree, whose distances still hold
+    for (int v : affected_) {
+        
+        for (int road = graph_.firstRoad(v); road < graph_.endRoad(v); road++) {
+            int target = graph_.target(road);
+            if (distance_[target] >= 0 && !lost_[target]) {
+                float distance = cost(road) + distance_[target];
+                if (distance_[v] < 0 || distance < distance_[v]) {
+                    distance_[v] = distance;
+                    next_[v] = road;
+                }
+            }
+        }
+        
+        if (distance_[v] >= 0) {
+            queue_.push(v, distance_[v]);
+        }
+        
+    }
+    
+    //a road that got cheaper can shorten the way of the intersection it starts from
+    for (const pair<int, float>& change : changes) {
+        
+        const int v = change.first;
+        if (delay_[v] >= change.second || distance_[v] < 0) {
+            continue;
+        }
+        
+        for (int slot = incoming_.firstRoad(v); slot < incoming_.endRoad(v); slot++) {
+            int u = incoming_.target(slot);
+            int road = incoming_.original(slot);
+            float distance = distance_[v] + cost(road);
+            if (distance_[u] < 0 || distance < distance_[u]) {
+                distance_[u] = distance;
+                next_[u] = road;
+                queue_.push(u, distance);
+            }
+        }
+        
+    }
+    
+    //passes the new distances on, this only reaches the intersections whose distance changes
+    settle();
+    
+    for (int v : affected_) {
+        lost_[v] = false;
+    }
+    
+}
+
+
+/** @fn distance(Intersection* intersection) const
+ *  @brief the cost of the way from an intersection to its nearest hospital, with the delays
+ *  @return float -1 if no hospital can be reached or the intersection is not in the tree
+ */
+float HospitalRouteTree::distance(Intersection* intersection) const {
+    
+    int node = graph_.index(intersection);
+    return node >= 0 ? distance_[node] : -1;
+    
+}
+
+
+/** @fn memory() const
+ *  @brief the bytes taken by the snapshots, the tree, the delays and the arrays of the repairs
+ *  @return size_t
+ */
+size_t HospitalRouteTree::memory() const {
+    
+    return graph_.memory() + incoming_.memory() + next_.capacity()*sizeof(int) + (distance_.capacity() + delay_.capacity())*sizeof(float)
+        + delays_.size()*(sizeof(std::pair<traffictrack::IntersectionID, float>) + 2*sizeof(void*)) + delays_.bucket_count()*sizeof(void*)
+        + queue_.memory() + affected_.capacity()*sizeof(int) + lost_.capacity();
+    
+}
+
+
+/** @fn search(Intersection* startState, std::unordered_map<traffictrack::IntersectionID, Intersection*>& intersections)
+ *  @brief follows the tree from the start to the nearest hospital, after rebuilding it if the map changed
+ *  @return std::pair<std::vector<Intersection*>, float> the path from the start to the hospital and its cost, which is its
+ *      length when there is no congestion. an empty path and -1 if no hospital can be reached
+ */
+std::pair<std::vector<Intersection*>, float> HospitalRouteTree::search(Intersection* startState, std::unordered_map<traffictrack::IntersectionID, Intersection*>& intersections) {
+    
+    if (!graph_.current()) {
+        build(intersections);
+    }
+    
+    return search(graph_.index(startState));
+    
+}
+
+
+/** @fn searchBatch(const std::vector<Intersection*>& starts, std::unordered_map<traffictrack::IntersectionID, Intersection*>& intersections)
+ *  @brief follows the tree from all the starts at once on the shared TaskPool, after rebuilding it if the map changed
+ *  @return std::vector<std::pair<std::vector<Intersection*>, float>> the path from every start, in the same order
+ */
+std::vector<std::pair<std::vector<Intersection*>, float>> HospitalRouteTree::searchBatch(const std::vector<Intersection*>& starts, std::unordered_map<traffictrack::IntersectionID, Intersection*>& intersections) {
+    
+    //the tree is only ever rebuilt here, before the workers start reading it
+    if (!graph_.current()) {
+        build(intersections);
+    }
+    
+    //following the tree takes about as long as handing out a task, so a range is only worth it for many starts
+    vector<pair<vector<Intersection*>, float>> routes(starts.size());
+    TaskPool::shared()->forEach(starts.size(), 64, [this, &starts, &routes](size_t begin, size_t end, int /* slot */) {
+        for (size_t i = begin; i < end; i++) {
+            routes[i] = search(graph_.index(starts[i]));
+        }
+    }, TaskPool::HIGH);
+    
+    return routes;
+    
+}
+
+
+/** @fn search(int start) const
+ *  @brief follows the tree from an intersection, it only reads the tree so any number of threads can at once
+ *  @param start the number of the start in graph_, -1 if it is not on the map
+ *  @return std::pair<std::vector<Intersection*>, float> the path from the start to the hospital and its cost, an empty path
+ *      and -1 if no hospital can be reached
+ */
+std::pair<std::vector<Intersection*>, float> HospitalRouteTree::search(int start) const {
+    
+    vector<Intersection*> path;
+    
+    if (start < 0 || distance_[start] < 0) {
+        return make_pair(path, -1);
+    }
+    
+    for (int current = start; ; current = graph_.target(next_[current])) {
+        path.push_back(graph_.intersection(current));
+        if (next_[current] < 0) {
+            break;
+        }
+    }
+    
+    return make_pair(std::move(path), distance_[start]);
+    
+}
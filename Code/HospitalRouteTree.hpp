@@ -0,0 +1,71 @@
+//
+//  HospitalRouteTree.hpp
+//  TraffikTrak
+//
+//  Created by Matt Lovick on 2026-10-19.
+//  Copyright © 2026 Matt Lovick. All rights reserved.
+//
+
+#ifndef HospitalRouteTree_hpp
+#define HospitalRouteTree_hpp
+
+#include <vector>
+#include <unordered_map>
+#include <utility>
+#include "Intersection.hpp"
+#include "IntersectionID.h"
+#include "CongestionScore.hpp"
+#include "DateScorePair.hpp"
+#include "AbstractPathFinder.hpp"
+#include "RoadGraph.hpp"
+#include "NodeHeap.hpp"
+
+
+/** @class HospitalRouteTree
+ *  @brief implements the AbstractPathFinder with a shortest path tree that is rooted at every hospital at once
+ *
+ *  the hospitals never change while the program runs, so the shortest path from every intersection to its nearest hospital
+ *  is worked out ahead of time: one search over the reversed roads that starts from all the hospitals together. every
+ *  intersection then only stores the next road on its way to a hospital, and a search just follows those roads, which
+ *  takes as long as the path is. the tree is rebuilt when the map changes (RoadGraph::current())
+ *
+ *  the cost of a road is its length, made longer by the vehicles waiting at the intersection it leads to. when new
+ *  congestion scores come in, only the part of the tree whose costs changed is repaired: the intersections whose way to a
+ *  hospital got more expensive lose their distance and are searched again from the rest of the tree, and cheaper roads
+ *  are passed on from where they are. the work depends on how many distances change, not on the size of the map
+ *  @author Matthew Lovick
+ */
+class HospitalRouteTree : public AbstractPathFinder {
+
+protected:
+    RoadGraph graph_; /**< snapshot of the map the tree was built from, the tree refers to the intersections by their number in it */
+    RoadGraph incoming_; /**< graph_ reversed, incoming_.firstRoad(v) to incoming_.endRoad(v)-1 are the roads arriving at v */
+    std::vector<int> next_; /**< the next road on the way to the nearest hospital, -1 for hospitals and intersections that cannot reach one */
+    std::vector<float> distance_; /**< cost of the way to the nearest hospital, -1 if there is no way to one */
+    std::vector<float> delay_; /**< what the length of a road arriving at each intersection is multiplied by */
+    std::unordered_map<traffictrack::IntersectionID, float> delays_; /**< the delays that are not 1, kept by ID so they outlive a rebuild of the tree */
+    const float delayPerVehicle_; /**< how much longer each vehicle waiting at an intersection makes the roads to it */
+    const int maxVehicles_; /**< vehicles beyond this many make no difference */
+    NodeHeap queue_;
+    std::vector<int> affected_; /**< the intersections whose distance a repair is searching for again */
+    std::vector<char> lost_; /**< whether an intersection is in affected_ */
+
+    void build(std::unordered_map<traffictrack::IntersectionID, Intersection*>& intersections);
+    float cost(int road) const;
+    void settle();
+    std::pair<std::vector<Intersection*>, float> search(int start) const;
+
+public:
+    HospitalRouteTree(float delayPerVehicle = 0.02f, int maxVehicles = 100);
+    virtual ~HospitalRouteTree();
+    float delay(const traffictrack::CongestionScore& score) const;
+    float distance(Intersection* intersection) const;
+    virtual size_t memory() const;
+    virtual std::pair<std::vector<Intersection*>, float> search(Intersection* startState, std::unordered_map<traffictrack::IntersectionID, Intersection*>& intersections);
+    virtual std::vector<std::pair<std::vector<Intersection*>, float>> searchBatch(const std::vector<Intersection*>& starts, std::unordered_map<traffictrack::IntersectionID, Intersection*>& intersections);
+    virtual void prepare(std::unordered_map<traffictrack::IntersectionID, Intersection*>& intersections);
+    virtual void updateCongestion(const std::vector<std::pair<traffictrack::IntersectionID, traffictrack::DateScorePair>>& scores, std::unordered_map<traffictrack::IntersectionID, Intersection*>& intersections);
+
+};
+
+#endif /* HospitalRouteTree_hpp */
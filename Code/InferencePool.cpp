@@ -0,0 +1,178 @@
+//
+//  InferencePool.cpp
+//  TraffikTrak
+//
+//  Created by Matt Lovick on 2026-10-19.
+//  Copyright © 2026 Matt Lovick. All rights reserved.
+//
+
+#include <vector>
+#include <mutex>
+#include <thread>
+#include <future>
+#include <chrono>
+#include "InferencePool.hpp"
+#include "Yolo.hpp"
+#include "TaskPool.hpp"
+#include "FrameQuality.h"
+#include "FrameQualityGate.hpp"
+
+using namespace std;
+
+
+//initialize static variables
+InferencePool* InferencePool::instance_ = nullptr;
+std::mutex InferencePool::staticMutex_;
+
+
+/** @fn InferencePool(int threads)
+ *  @brief private constructor starts the workers, the networks are loaded lazily
+ *  @param threads the number of workers
+ */
+InferencePool::InferencePool(int threads) {
+    
+    pool_ = new TaskPool(threads);
+    models_.resize(pool_->size(), nullptr);
+    
+}
+
+
+/** @fn model()
+ *  @brief returns the network of the worker running the calling thread, loading it on first use
+ *  @return yolo* the network
+ */
+yolo* InferencePool::model() {
+    
+    int worker = pool_->currentWorker();
+    if (models_[worker] == nullptr) {
+        models_[worker] = new yolo("yolov3.weights","coco.names","yolov3.cfg",416,416, 0.30);
+    }
+    return models_[worker];
+    
+}
+
+
+/** @fn instance()
+ *  @brief returns the singleton, creating it with one worker per core the first time
+ *  @return InferencePool*
+ */
+InferencePool* InferencePool::instance() {
+    
+    lock_guard<mutex> guard(staticMutex_);
+    if (instance_ == nullptr) {
+        instance_ = new InferencePool(static_cast<int>(thread::hardware_concurrency()));
+    }
+    return instance_;
+    
+}
+
+
+/** @fn ~InferencePool()
+ *  @brief waits for the submitted photos to finish then frees the networks
+ */
+InferencePool::~InferencePool() {
+    
+    delete pool_;
+    
+    for (yolo* m : models_) {
+        if (m != nullptr) {
+            delete m;
+        }
+    }
+    
+}
+
+
+/** @fn threads() const
+ *  @brief getter for the number of workers
+ *  @return int
+ */
+int InferencePool::threads() const {
+    return pool_->size();
+}
+
+
+/** @fn detect(cv::String imageFile)
+ *  @brief reads the photo and identifies the objects in it on one of the workers
+ *  @param imageFile the file name of the photo
+ *  @return std::future<std::vector<yolo_obj>> the objects identified in the photo
+ */
+std::future<std::vector<yolo_obj>> InferencePool::detect(cv::String imageFile) {
+    
+    return pool_->submit([this, imageFile]() {
+        return model()->processImage(cv::imread(imageFile));
+    });
+    
+}
+
+
+/** @fn detect(cv::Mat image)
+ *  @brief identifies the objects in an image that is already decoded on one of the workers
+ *  @param image the image
+ *  @return std::future<std::vector<yolo_obj>> the objects identified in the image
+ */
+std::future<std::vector<yolo_obj>> InferencePool::detect(cv::Mat image) {
+    
+    return pool_->submit([this, image]() {
+        return model()->processImage(image);
+    });
+    
+}
+
+
+/** @fn runTimed(const cv::String& imageFile, FrameQualityGate* gate)
+ *  @brief decodes, checks and runs one photo through yolo, measuring each stage. only called on the workers
+ *  @param imageFile the file name of the photo
+ *  @param gate optional quality gate
+ *  @return timed_detection
+ */
+timed_detection InferencePool::runTimed(const cv::String& imageFile, FrameQualityGate* gate) {
+    
+    timed_detection detection;
+    chrono::steady_clock::time_point start = chrono::steady_clock::now();
+    cv::Mat image = cv::imread(imageFile);
+    detection.decode = chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+    detection.readable = !image.empty();
+    if (gate != nullptr) {
+        detection.quality = gate->check(image);
+    }
+    else {
+        detection.quality = detection.readable ? traffictrack::FrameQuality::GOOD : traffictrack::FrameQuality::UNREADABLE;
+    }
+    if (detection.quality == traffictrack::FrameQuality::GOOD) {
+        detection.objects = model()->processImage(image, &detection.timings);
+    }
+    return detection;
+    
+}
+
+
+/** @fn detectTimed(cv::String imageFile, FrameQualityGate* gate)
+ *  @brief same as detect(cv::String) but also measures how long each stage took, and can skip unusable frames
+ *  @param imageFile the file name of the photo
+ *  @param gate optional, checks the decoded photo first. the photo is only run through yolo if the gate finds it GOOD
+ *  @return std::future<timed_detection> the objects identified in the photo, the quality verdict and the stage timings
+ */
+std::future<timed_detection> InferencePool::detectTimed(cv::String imageFile, FrameQualityGate* gate) {
+    
+    return pool_->submit([this, imageFile, gate]() {
+        return runTimed(imageFile, gate);
+    });
+    
+}
+
+
+/** @fn detectTimed(cv::String imageFile, FrameQualityGate* gate, std::function<void(timed_detection)> done)
+ *  @brief same as detectTimed(cv::String, FrameQualityGate*) but hands the result to a callback instead of a future,
+ *      so nothing has to wait for it. done runs on the worker and should hand any long work to another thread
+ *  @param imageFile the file name of the photo
+ *  @param gate optional quality gate
+ *  @param done called with the result
+ */
+void InferencePool::detectTimed(cv::String imageFile, FrameQualityGate* gate, std::function<void(timed_detection)> done) {
+    
+    pool_->submit([this, imageFile, gate, done]() {
+        done(runTimed(imageFile, gate));
+    });
+    
+}
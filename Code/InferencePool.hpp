@@ -0,0 +1,64 @@
+//
+//  InferencePool.hpp
+//  TraffikTrak
+//
+//  Created by Matt Lovick on 2026-10-19.
+//  Copyright © 2026 Matt Lovick. All rights reserved.
+//
+
+#ifndef InferencePool_hpp
+#define InferencePool_hpp
+
+#include <vector>
+#include <mutex>
+#include <future>
+#include <functional>
+#include "Yolo.hpp"
+#include "TaskPool.hpp"
+#include "FrameQuality.h"
+
+class FrameQualityGate;
+
+/*objects identified in a photo and how long each stage took in milliseconds -
+readable - whether the photo could be decoded, quality - the verdict of the quality gate, anything but GOOD means inference was skipped,
+decode - reading the photo from disk, timings - the yolo stages, counting is not included*/
+typedef struct timed_detection
+{
+    std::vector<yolo_obj> objects;
+    bool readable = false;
+    traffictrack::FrameQuality quality = traffictrack::FrameQuality::UNREADABLE;
+    double decode = 0;
+    yolo_timings timings;
+}timed_detection;
+
+/** @class InferencePool
+ *  @brief shared pool of workers that run photos through yolo, used by every intersection
+ *
+ *  a cv::dnn::Net can only run one forward pass at a time, so every worker owns its own network. the networks are
+ *  loaded by the worker the first time it is given a photo
+ *  @author Matthew Lovick
+ */
+class InferencePool {
+    
+protected:
+    static InferencePool* instance_; /**< static instance for singleton */
+    static std::mutex staticMutex_;
+    TaskPool* pool_; /**< the workers, deleted before the networks so no worker is still using one. kept apart from the shared pool so a forward pass never delays a light change */
+    std::vector<yolo*> models_; /**< one network per worker, models_[i] is only touched by worker i */
+    
+    InferencePool(int threads);
+    yolo* model();
+    timed_detection runTimed(const cv::String& imageFile, FrameQualityGate* gate);
+    
+public:
+    static InferencePool* instance();
+    virtual ~InferencePool();
+    int threads() const;
+    std::future<std::vector<yolo_obj>> detect(cv::String imageFile);
+    std::future<std::vector<yolo_obj>> detect(cv::Mat image);
+    std::future<timed_detection> detectTimed(cv::String imageFile, FrameQualityGate* gate = nullptr);
+    void detectTimed(cv::String imageFile, FrameQualityGate* gate, std::function<void(timed_detection)> done);
+    
+};
+
+#endif /* InferencePool_hpp */
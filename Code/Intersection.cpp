@@ -29,6 +29,10 @@
 #include "DefaultTrafficLightScheduler.hpp"
 #include "Controller.hpp"
 #include "ProcessedImage.hpp"
+#include "FrameQualityGate.hpp"
+#include "TimerService.hpp"
+#include "InferencePool.hpp"
+#include "IntersectionExecutor.hpp"
 #include <opencv2/dnn.hpp>
 #include <opencv2/imgproc.hpp>
 #include <opencv2/highgui.hpp>
@@ -38,71 +42,236 @@ using namespace std::chrono;
 using namespace traffictrack;
 
 
-/** @fn countTimeSinceLastChange()
- *  @brief looping thread that counts the number of seconds since the last time the lights were changed
+LatencyHistogram Intersection::phaseJitter_;
+std::atomic<unsigned long long> Intersection::mapVersion_(0);
+
+
+/** @fn scheduleChange(TimerService::clock::time_point deadline, bool finishing)
+ *  @brief replaces the light change timer with one that expires at deadline. the caller holds stateMutex_
+ *  @param deadline when the step is due
+ *  @param finishing false to start a change (green to yellow), true to finish it once the yellow time is over
  */
-void Intersection::countTimeSinceLastChange() {
+void Intersection::scheduleChange(TimerService::clock::time_point deadline, bool finishing) {
     
-    while(!stopRequested()) {
-        
-        waitFor(seconds(1));
-        lock_guard<mutex> guard(timeCounterMutex_);
-        timeSinceLastChange_++;
-        
-    }
+    TimerService* timers = TimerService::instance();
+    timers->cancel(changeTimer_);
+    
+    unsigned long long generation = ++changeGeneration_;
+    
+    changeTimer_ = timers->schedule(deadline, [this, generation, deadline, finishing]() {
+        lock_guard<mutex> phaseGuard(phaseMutex_);
+        phaseChange_ = TaskPool::shared()->submit([this, generation, deadline, finishing]() { runScheduledChange(generation, deadline, finishing); }, TaskPool::HIGH);
+    });
     
 }
 
 
-/** @fn monitorIntersection()
- *  @brief looping thread that gathers real time data from the intersection using the traffic light cameras, and decides how to handle the information
+/** @fn runScheduledChange(unsigned long long generation, TimerService::clock::time_point deadline, bool finishing)
+ *  @brief runs on the shared TaskPool when a scheduled step is due, records how late it started and schedules the next step
+ *
+ *  the next step is due a fixed time after this one was due rather than after it ran, so lateness does not add up over the cycles
+ *  @param generation the value of changeGeneration_ when the step was scheduled
+ *  @param deadline the time the step was due
+ *  @param finishing whether this step finishes a change
  */
-void Intersection::monitorIntersection() {
+void Intersection::runScheduledChange(unsigned long long generation, TimerService::clock::time_point deadline, bool finishing) {
     
-    //create the thread that counts the time since the last light change
-    unique_lock<mutex> timeCounterThreadLock(timeCounterThreadMutex_);
-    if (timeCounterThread_ == nullptr) {
-        timeCounterThread_ = new thread(&Intersection::countTimeSinceLastChange, this);
+    lock_guard<mutex> stateGuard(stateMutex_);
+    
+    //the lights were changed some other way (emergency vehicle) or the intersection stopped since this was scheduled
+    if (generation != changeGeneration_) {
+        return;
     }
-    timeCounterThreadLock.unlock();
     
-    //loop to take photos and implement any logic associated with analyzing the real time data
-    while (!stopRequested()) {
-        
-        {
-            unique_lock<mutex> timeCounterLock(timeCounterMutex_);
-            if (timeSinceLastChange_ >= state_->intervalTime()) {
-                timeCounterLock.unlock();
-                this->changeLights();
-            }
-        }
-        
+    TimerService::clock::time_point now = TimerService::clock::now();
+    phaseJitter_.record(duration_cast<microseconds>(now - deadline).count());
+    
+    if (!finishing) {
+        state_->beginChange(this);
+        changing_ = true;
+        scheduleChange(deadline + GreenLight::yellowTime(), true);
+    }
+    else {
+        state_->finishChange(this);
+        advanceState();
+        changing_ = false;
+        scheduleChange(deadline + state_->intervalTime(), false);
+    }
+    
+}
 
-        //take one photo for each traffic light   
-        cv::String img1 = lights_.at(0)->takePhoto();
-        cv::String img2 = lights_.at(1)->takePhoto();
-        cv::String img3 = lights_.at(2)->takePhoto();
-        cv::String img4 = lights_.at(3)->takePhoto();
 
-        ProcessedImage data = ProcessedImage(img1,img2 ,img3, img4);//process the photos
-        DateScorePair scores = data.carCount();
+/** @fn analyzeCycle(const ProcessedImage& data)
+ *  @brief analyzes and logs the photos of one monitoring cycle
+ *
+ *  approaches without a usable frame keep their last good score, and a cycle without any usable frame is not analyzed or logged
+ *  @param data the processed photos of the four lights
+ */
+void Intersection::analyzeCycle(const ProcessedImage& data) {
+    
+    if (data.skippedApproaches() < 4) {
+        DateScorePair scores = data.carCount(lastScore_);
+        lastScore_ = scores.second;
         analyzer_ -> analyze(scores.second, this);//change the traffic light based on real time data
         Controller::instance()->logScore(this->ID_, scores);
-            
-            
+    }
+    
+}
+
+
+/** @fn requestDetections(std::function<void()> done)
+ *  @brief takes the photos of one monitoring cycle and hands them to the InferencePool. runs on the intersection's shard
+ *
+ *  the shard does not wait for the photos, the last one to be processed posts done back to the shard. the results are in cycleDetections_
+ *  @param done what to run on the shard once every photo was processed
+ */
+void Intersection::requestDetections(std::function<void()> done) {
+    
+    InferencePool* pool = InferencePool::instance();
+    cyclePending_ = 4;
+    
+    for (int i = 0; i < 4; i++) {
+        cv::String photo = lights_.at(i)->takePhoto();
+        pool->detectTimed(photo, lights_.at(i)->qualityGate(), [this, i, done](timed_detection detection) {
+            cycleDetections_[i] = std::move(detection);
+            if (--cyclePending_ == 0) {
+                executor_->post(ID_, done);
+            }
+        });
+    }
+    
+}
+
+
+/** @fn scheduleCycle(std::chrono::seconds delay, std::function<void()> next)
+ *  @brief posts the next cycle to the intersection's shard once the delay is over, unless the intersection is stopping
+ *  @param delay the time between two cycles
+ *  @param next what to run on the shard when the delay is over. wakeUp() runs it early if the intersection is stopped first
+ *  @return bool false if the intersection is stopping, the cycles are then over and nothing was scheduled
+ */
+bool Intersection::scheduleCycle(std::chrono::seconds delay, std::function<void()> next) {
+    
+    lock_guard<mutex> cycleGuard(cycleMutex_);
+    
+    if (stopRequested()) {
+        cycleInFlight_ = false;
+        cycleCondition_.notify_all();
+        return false;
+    }
+    
+    cycleResume_ = next;
+    cycleTimer_ = TimerService::instance()->scheduleAfter(delay, [this, next]() {
+        executor_->post(ID_, next);
+    });
+    return true;
+    
+}
+
+
+/** @fn beginCycle()
+ *  @brief starts a monitoring cycle, or ends the cycles if the intersection is stopping. runs on the intersection's shard
+ */
+void Intersection::beginCycle() {
+    
+    if (stopRequested()) {
+        endCycles();
+        return;
+    }
+    
+    requestDetections([this]() { finishCycle(); });
+    
+}
+
+
+/** @fn finishCycle()
+ *  @brief analyzes the processed photos and schedules the next cycle. runs on the intersection's shard
+ */
+void Intersection::finishCycle() {
+    
+    analyzeCycle(ProcessedImage(cycleDetections_));
+    scheduleCycle(seconds(5), [this]() { beginCycle(); });
+    
+}
+
+
+#ifdef TRAFFICTRACK_COROUTINES
+
+/** @fn monitorCycles()
+ *  @brief the monitoring loop as a coroutine, the C++20 build runs it instead of beginCycle()/finishCycle(). runs on the intersection's shard
+ *
+ *  it reads like the old blocking loop, but every wait suspends the coroutine instead of a thread: the photos are resumed from
+ *  the InferencePool's completion callback and the sleep from a timer, both through the shard. the intersection must not be
+ *  touched once endCycles() was called or the sleep was refused, stop() may already have returned
+ */
+DetachedTask Intersection::monitorCycles() {
+    
+    while (true) {
+        
+        if (stopRequested()) {
+            endCycles();
+            co_return;
+        }
+        
+        co_await resumeWith([this](std::function<void()> resume) {
+            requestDetections(std::move(resume));
+            return true;
+        });
         
-        waitFor(std::chrono::seconds(5));
+        analyzeCycle(ProcessedImage(cycleDetections_));
         
+        bool scheduled = co_await resumeWith([this](std::function<void()> resume) {
+            return scheduleCycle(seconds(5), std::move(resume));
+        });
+        if (!scheduled) {
+            co_return;
+        }
+        
+    }
+    
+}
+
+#endif
+
+
+/** @fn endCycles()
+ *  @brief marks that no cycle is running or scheduled anymore, so wakeUp() can return
+ */
+void Intersection::endCycles() {
+    
+    lock_guard<mutex> cycleGuard(cycleMutex_);
+    cycleInFlight_ = false;
+    cycleCondition_.notify_all();
+    
+}
+
+
+/** @fn wakeUp()
+ *  @brief there is no thread to join, so stop() waits here until the current cycle is over and the timers are cancelled
+ */
+void Intersection::wakeUp() {
+    
+    if (executor_ == nullptr) {
+        return;
     }
     
-    //join the counting thread when stopping the internal thread
-    timeCounterThreadLock.lock();
-    if (timeCounterThread_->joinable()) {
-        timeCounterThread_->join();
-        delete timeCounterThread_;
-        timeCounterThread_ = nullptr;
+    {
+        unique_lock<mutex> cycleLock(cycleMutex_);
+        
+        //a cycle waiting for its timer is resumed right away, one that is running sees the stop signal when it is done
+        if (cycleTimer_ != 0 && TimerService::instance()->cancel(cycleTimer_)) {
+            executor_->post(ID_, cycleResume_);
+        }
+        cycleCondition_.wait(cycleLock, [this]() { return !cycleInFlight_; });
+        cycleTimer_ = 0;
+        cycleResume_ = nullptr;
     }
     
+    lock_guard<mutex> stateGuard(stateMutex_);
+    TimerService::instance()->cancel(changeTimer_);
+    changeTimer_ = 0;
+    changeGeneration_++;
+    executor_ = nullptr;
+    
 }
 
 
@@ -110,11 +279,10 @@ void Intersection::monitorIntersection() {
  *  @brief constructor sets default values, and sets two lights to green and the opposing lights to red, and initializes the internal state
  *  @param ID the id of the intersection being created
  */
-Intersection::Intersection(traffictrack::IntersectionID ID) : ID_(ID), hospital_(false) {
+Intersection::Intersection(traffictrack::IntersectionID ID) : ID_(ID), hospital_(false), positionX_(0), positionY_(0), located_(false), changeTimer_(0), changeGeneration_(0), changing_(false), executor_(nullptr), cycleInFlight_(false), cycleTimer_(0), cycleDetections_(4), cyclePending_(0) {
     
-    northSouthIntervalTime_ = seconds(5);
-    eastWestIntervalTime_ = seconds(5);
-    timeSinceLastChange_ = seconds(0);
+    schedule_ = new WeeklySchedule(WeeklySchedule::Intervals(seconds(5), seconds(5)));
+    scheduleReaders_ = 0;
     
     lights_ = {
         new TrafficLight(LightColour::GREEN, new GreenLight()),
@@ -123,21 +291,40 @@ Intersection::Intersection(traffictrack::IntersectionID ID) : ID_(ID), hospital_
         new TrafficLight(LightColour::RED, new RedLight())
     };
     
-    state_ = new NorthSouthState(this->northSouthIntervalTime_);
+    state_ = new NorthSouthState(currentIntervals().first);
     nextState_ = nullptr;
-    timeCounterThread_ = nullptr;
     analyzer_ = new DefaultCongestionScoreAnalyzer();
     
+    lastScore_.setNorth(0, 0, 0);
+    lastScore_.setSouth(0, 0, 0);
+    lastScore_.setEast(0, 0, 0);
+    lastScore_.setWest(0, 0, 0);
+    
 }
 
 
 /** @fn ~Intersection()
- *  @brief stops the internal looping thread if it is not already stopped and releases any dynamic memory not needed anymore
+ *  @brief stops monitoring if it is not already stopped and releases any dynamic memory not needed anymore
  */
 Intersection::~Intersection() {
     
     stop();
     
+    //the lights may have been changed without the intersection running, the timer and the change it hands off must not outlive the intersection
+    {
+        lock_guard<mutex> stateGuard(stateMutex_);
+        if (changeTimer_ != 0) {
+            TimerService::instance()->cancel(changeTimer_);
+        }
+        changeGeneration_++;
+    }
+    {
+        lock_guard<mutex> phaseGuard(phaseMutex_);
+        if (phaseChange_.valid()) {
+            phaseChange_.wait();
+        }
+    }
+    
     lock_guard<mutex> lightsGuard(lightsMutex_);
     for (TrafficLight* light : lights_) {
         if (light != nullptr)
@@ -149,6 +336,12 @@ Intersection::~Intersection() {
         delete state_;
     }
     
+    delete schedule_.load();
+
+    if (analyzer_ != nullptr) {
+        delete analyzer_;
+    }
+
 }
 
 
@@ -157,7 +350,9 @@ Intersection::~Intersection() {
  *  @param val the value of of whether the hospital is at the location or not
  */
 void Intersection::setHospital(bool val) {
-    hospital_ = val;
+    if (hospital_.exchange(val) != val) {
+        mapVersion_++;
+    }
 }
 
 
@@ -195,6 +390,42 @@ bool Intersection::hospital() const {
 }
 
 
+/** @fn setPosition(float x, float y)
+ *  @brief sets where the intersection is, which lets AStarSearch estimate how far away a hospital is
+ *  @param x the position from west to east, in the same unit as the road lengths
+ *  @param y the position from south to north
+ */
+void Intersection::setPosition(float x, float y) {
+    
+    lock_guard<mutex> guard(neighborsMutex_);
+    if (!located_ || positionX_ != x || positionY_ != y) {
+        positionX_ = x;
+        positionY_ = y;
+        located_ = true;
+        mapVersion_++;
+    }
+    
+}
+
+
+/** @fn located() const
+ *  @brief whether the position of the intersection is known
+ *  @return bool
+ */
+bool Intersection::located() const {
+    return located_;
+}
+
+
+/** @fn position() const
+ *  @brief getter for the position of the intersection, (0, 0) if it is not located()
+ *  @return std::pair<float, float> the x and y of the intersection
+ */
+std::pair<float, float> Intersection::position() const {
+    return std::make_pair(positionX_, positionY_);
+}
+
+
 /** @fn northSouthcolour() const
  *  @brief returns the colour of the north and south facing lights
  *  @return traffictrack::LightColour the colour of the north/south lights
@@ -231,7 +462,11 @@ bool Intersection::addRoad(Road road) {
     
     if (road.firstIntersection() == this) {
         lock_guard<mutex> guard(neighborsMutex_);
-        return neighbors_.insert(road).second;
+        bool inserted = neighbors_.insert(road).second;
+        if (inserted) {
+            mapVersion_++;
+        }
+        return inserted;
     }
     else return false;
     
@@ -250,59 +485,158 @@ bool Intersection::addRoad(Intersection* first, Intersection* second, float dist
     
     if (first == this) {
         lock_guard<mutex> guard(neighborsMutex_);
-        return neighbors_.insert(Road(first, second, distance, direction)).second;
+        bool inserted = neighbors_.insert(Road(first, second, distance, direction)).second;
+        if (inserted) {
+            mapVersion_++;
+        }
+        return inserted;
     }
     else return false;
     
 }
 
 
-/** @fn changeLights()
- *  @brief changes the colour and state of the traffic light itself by delegating to its current state who will change the lights next state
+/** @fn advanceState()
+ *  @brief replaces the current state with the one it left in nextState_ when it changed the lights. the caller holds stateMutex_
  */
-void Intersection::changeLights() {
+void Intersection::advanceState() {
     
-    lock_guard<mutex> stateGuard(stateMutex_);
-    state_->changeLights(this);
     delete state_;
     lock_guard<mutex> nextStateGuard(nextStateMutex_);
     state_ = nextState_;
     nextState_ = nullptr;
-    lock_guard<mutex> timeCounterGuard(timeCounterMutex_);
-    timeSinceLastChange_ = seconds(0);
     
 }
 
 
+/** @fn changeLightsSoon()
+ *  @brief asks for the lights to change as soon as the shared TaskPool gets to it, without waiting for the yellow light.
+ *      does nothing if a change is already under way
+ */
+void Intersection::changeLightsSoon() {
+    
+    lock_guard<mutex> stateGuard(stateMutex_);
+    if (!changing_) {
+        scheduleChange(TimerService::clock::now(), false);
+    }
+    
+}
+
+
+/** @fn phaseJitter()
+ *  @brief how late the scheduled light changes of all intersections started, in microseconds
+ *  @return LatencyHistogram&
+ */
+LatencyHistogram& Intersection::phaseJitter() {
+    return phaseJitter_;
+}
+
+
+/** @fn mapVersion()
+ *  @brief a number that changes whenever a road, a hospital or a position is added anywhere on the map, so a path finder can tell that
+ *      what it precomputed is out of date
+ *  @return unsigned long long
+ */
+unsigned long long Intersection::mapVersion() {
+    return mapVersion_;
+}
+
+
 /** @fn updateLightSchedule(std::chrono::seconds northSouthTime, std::chrono::seconds eastWestTime)
- *  @brief updates the interval times that the lights switche after
+ *  @brief updates the interval times that the lights switche after, the same times are used all week
  *  @param northSouthTime the time in seconds that the north/south lights will stay green for during regular operations
  *  @param eastWestTime the time in seconds that the east/west lights will wstay green for during regular operations
  */
 void Intersection::updateLightSchedule(std::chrono::seconds northSouthTime, std::chrono::seconds eastWestTime) {
+    publishSchedule(new WeeklySchedule(WeeklySchedule::Intervals(northSouthTime, eastWestTime)));
+}
+
+
+/** @fn updateLightSchedule(const traffictrack::LightSchedule& schedule, traffictrack::TimeBlock timeBlocks)
+ *  @brief replaces the interval times of the whole week. from then on every light change uses the times of the time block
+ *      it happens in, so the intersection moves from one block to the next by itself
+ *  @param schedule the interval times of each day time block, blocks that are missing keep the times in use right now
+ *  @param timeBlocks the number of time blocks the day is separated into, as configured for the database
+ */
+void Intersection::updateLightSchedule(const traffictrack::LightSchedule& schedule, traffictrack::TimeBlock timeBlocks) {
+    publishSchedule(new WeeklySchedule(schedule, timeBlocks, currentIntervals()));
+}
+
+
+/** @fn publishSchedule(const WeeklySchedule* schedule)
+ *  @brief swaps in a new schedule and frees the old one once no thread is reading it anymore. readers never wait, only the
+ *      caller does, for as long as the reads that started before the swap take
+ *  @param schedule the new schedule, the intersection takes ownership of it
+ */
+void Intersection::publishSchedule(const WeeklySchedule* schedule) {
+    
+    const WeeklySchedule* old = schedule_.exchange(schedule);
+    
+    //a reader that registers after the exchange can only see the new schedule
+    while (scheduleReaders_.load() > 0) {
+        this_thread::yield();
+    }
     
-    lock_guard<mutex> guard(intervalMutex_);
-    northSouthIntervalTime_ = northSouthTime;
-    eastWestIntervalTime_ = eastWestTime;
+    delete old;
+    
+}
+
+
+/** @fn currentIntervals()
+ *  @brief the interval times of the time block the week is in right now, without taking any lock
+ *  @return WeeklySchedule::Intervals the north/south and east/west interval times
+ */
+WeeklySchedule::Intervals Intersection::currentIntervals() {
+    
+    scheduleReaders_++;
+    WeeklySchedule::Intervals intervals = schedule_.load()->current();
+    scheduleReaders_--;
+    return intervals;
     
 }
 
 
 /** @fn run()
- *  @brief starts the internal thread that will automatically change the traffic lights and collect real time data
- *  @return bool whether or not the thread was started. fails if the thread was already running
+ *  @brief starts monitoring the intersection on the default IntersectionExecutor, the lights then change automatically and real time data is collected
+ *  @return bool whether or not monitoring was started. fails if the intersection was already running
  */
 bool Intersection::run() {
+    return runSharded(IntersectionExecutor::instance());
+}
+
+
+/** @fn runSharded(IntersectionExecutor* executor)
+ *  @brief starts monitoring the intersection without a thread of its own. the cycles run on the intersection's shard of executor,
+ *      driven by timers and by the InferencePool's completion callbacks
+ *  @param executor the executor shared by the intersections, it must outlive the monitoring
+ *  @return bool whether or not monitoring was started. fails if the intersection is already running
+ */
+bool Intersection::runSharded(IntersectionExecutor* executor) {
     
     lock_guard<mutex> guard(threadMutex_);
     
-    if (thread_ == nullptr) {
-        thread_ = new thread(&Intersection::monitorIntersection, this);
-        running_ = true;
-        return true;
+    if (running_) {
+        return false;
+    }
+    
+    executor_ = executor;
+    running_ = true;
+    
+    {
+        lock_guard<mutex> stateGuard(stateMutex_);
+        scheduleChange(TimerService::clock::now() + state_->intervalTime(), false);
+    }
+    {
+        lock_guard<mutex> cycleGuard(cycleMutex_);
+        cycleInFlight_ = true;
     }
     
-    return false;
+#ifdef TRAFFICTRACK_COROUTINES
+    executor_->post(ID_, [this]() { monitorCycles(); });
+#else
+    executor_->post(ID_, [this]() { beginCycle(); });
+#endif
+    return true;
     
 }
 
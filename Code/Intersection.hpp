@@ -15,6 +15,10 @@
 #include <thread>
 #include <chrono>
 #include <atomic>
+#include <future>
+#include <condition_variable>
+#include <functional>
+#include <utility>
 #include "Road.hpp"
 #include "Direction.h"
 #include "IntersectionID.h"
@@ -26,12 +30,21 @@
 #include "AbstractCongestionScoreAnalyzer.hpp"
 #include "DefaultCongestionScoreAnalyzer.hpp"
 #include "LightColour.h"
+#include "LightSchedule.hpp"
+#include "WeeklySchedule.hpp"
 #include "DateScorePair.hpp"
+#include "TimerService.hpp"
+#include "TaskPool.hpp"
+#include "LatencyHistogram.hpp"
+#include "InferencePool.hpp"
+#include "IntersectionExecutor.hpp"
+#include "CoroutineSupport.hpp"
 
 class NorthSouthState;
 class EastWestState;
 class DefaultCongestionScoreAnalyzer;
 class AbstractCongestionScoreAnalyzer;
+class ProcessedImage;
 
 /** @class Intersection
  *  @brief intersection which manages 4 traffic lights and changing the lights based on a given schedule
@@ -40,28 +53,54 @@ class AbstractCongestionScoreAnalyzer;
 class Intersection : public AbstractStoppableThread {
 
 protected:
-    std::mutex timeCounterMutex_;
-    std::mutex timeCounterThreadMutex_;
-    std::mutex intervalMutex_;
     std::mutex stateMutex_;
     std::mutex nextStateMutex_;
     std::mutex neighborsMutex_;
     std::mutex intervalsMutex_;
     std::mutex lightsMutex_;
-    std::thread* timeCounterThread_;
     const traffictrack::IntersectionID ID_;
     std::atomic_bool hospital_;
     std::set<Road> neighbors_;
+    float positionX_; /**< where the intersection is, in the same unit as the road lengths. set while the map is read */
+    float positionY_;
+    std::atomic_bool located_; /**< whether the map file gave the position of the intersection */
     std::vector<TrafficLight*> lights_;
-    std::chrono::seconds northSouthIntervalTime_;
-    std::chrono::seconds eastWestIntervalTime_;
-    std::chrono::seconds timeSinceLastChange_;
+    std::atomic<const WeeklySchedule*> schedule_; /**< the interval times for the whole week, replaced as a whole and never changed in place */
+    std::atomic<int> scheduleReaders_; /**< threads reading *schedule_ right now, a replaced schedule is freed once it drops to 0 */
+    static LatencyHistogram phaseJitter_;
+    static std::atomic<unsigned long long> mapVersion_; /**< incremented whenever a road, a hospital or a position is added or changed */
+    std::mutex phaseMutex_; /**< synchronize access to phaseChange_ */
+    std::future<void> phaseChange_; /**< the last light change handed to the shared TaskPool */
+    TimerService::TimerID changeTimer_; /**< timer that expires when the current state's interval is over, guarded by stateMutex_ */
+    unsigned long long changeGeneration_; /**< incremented on every light change, so a scheduled change that was overtaken does nothing. guarded by stateMutex_ */
+    bool changing_; /**< a scheduled change has turned the lights yellow and not finished yet, guarded by stateMutex_ */
+    IntersectionExecutor* executor_; /**< runs the monitoring cycles, nullptr when the intersection is not running */
+    std::mutex cycleMutex_; /**< synchronize access to cycleInFlight_ and cycleTimer_ */
+    std::condition_variable cycleCondition_; /**< signals wakeUp() that the last cycle ended */
+    bool cycleInFlight_; /**< a cycle is running or waiting for its timer */
+    TimerService::TimerID cycleTimer_; /**< timer that posts the next cycle */
+    std::function<void()> cycleResume_; /**< what cycleTimer_ posts, wakeUp() posts it early when it cancels the timer */
+    std::vector<timed_detection> cycleDetections_; /**< results of the current cycle, one per light */
+    std::atomic<int> cyclePending_; /**< photos of the current cycle still being processed */
     AbstractIntersectionState* state_;
     AbstractIntersectionState* nextState_;
     AbstractCongestionScoreAnalyzer* analyzer_;
+    traffictrack::CongestionScore lastScore_; /**< last score built from usable frames, only used on the intersection's shard */
     
-    void countTimeSinceLastChange();
-    void monitorIntersection();
+    void scheduleChange(TimerService::clock::time_point deadline, bool finishing);
+    void runScheduledChange(unsigned long long generation, TimerService::clock::time_point deadline, bool finishing);
+    void advanceState();
+    void publishSchedule(const WeeklySchedule* schedule);
+    void analyzeCycle(const ProcessedImage& data);
+    void requestDetections(std::function<void()> done);
+    bool scheduleCycle(std::chrono::seconds delay, std::function<void()> next);
+    void beginCycle();
+    void finishCycle();
+#ifdef TRAFFICTRACK_COROUTINES
+    DetachedTask monitorCycles();
+#endif
+    void endCycles();
+    virtual void wakeUp();
     
 public:
     Intersection(traffictrack::IntersectionID ID);
@@ -70,14 +109,22 @@ public:
     void setAnalyzer(AbstractCongestionScoreAnalyzer* analyzer);
     traffictrack::IntersectionID ID() const;
     bool hospital() const;
+    void setPosition(float x, float y);
+    bool located() const;
+    std::pair<float, float> position() const;
     traffictrack::LightColour northSouthColour() const;
     traffictrack::LightColour eastWestColour() const;
     const std::set<Road>& neighbors() const;
     bool addRoad(Road road);
     bool addRoad(Intersection* first, Intersection* second, float distance, traffictrack::Direction direction);
-    void changeLights();
+    void changeLightsSoon();
+    static LatencyHistogram& phaseJitter();
+    static unsigned long long mapVersion();
     void updateLightSchedule(std::chrono::seconds northSouthTime, std::chrono::seconds eastWestTime);
+    void updateLightSchedule(const traffictrack::LightSchedule& schedule, traffictrack::TimeBlock timeBlocks);
+    WeeklySchedule::Intervals currentIntervals();
     virtual bool run();
+    bool runSharded(IntersectionExecutor* executor);
     traffictrack::DateScorePair processImage();
     std::vector<TrafficLight*> getLights();
     friend class NorthSouthState;
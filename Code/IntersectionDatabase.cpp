@@ -19,6 +19,7 @@
 #include <iostream>
 #include <mutex>
 #include <sstream>
+#include <cctype>
 #include <future>
 #include "IntersectionDatabase.hpp"
 #include "DateScorePair.hpp"
@@ -60,6 +61,11 @@ IntersectionDatabase::IntersectionDatabase(traffictrack::IntersectionID intersec
     //set up the caches with initial values from the files so that averages can be calculated quickly without IO
     setupCaches();
     
+    //the data read from the files has not been averaged yet
+    for (const auto& it : data_) {
+        changed_.insert(it.first);
+    }
+    
 }
 
 
@@ -182,15 +188,22 @@ std::string IntersectionDatabase::appendPath(std::string first, std::string seco
 }
 
 
-/** @fn convertToDayTimeBlockPair(traffic::DateScorePair date_score_pair) const
+/** @fn convertToDayTimeBlockPair(const traffic::DateScorePair& date_score_pair) const
  *  @brief extracts information from the timestamp in the DateScorePair and creates a DayTimeBlockPair
  *  @param date_score_pair the pair to extract the information from
  *  @return traffictrack::DayTimeBlockPair
  */
-traffictrack::DayTimeBlockPair IntersectionDatabase::convertToDayTimeBlockPair(traffictrack::DateScorePair date_score_pair) const {
+traffictrack::DayTimeBlockPair IntersectionDatabase::convertToDayTimeBlockPair(const traffictrack::DateScorePair& date_score_pair) const {
+    
+    const string& date = date_score_pair.first;
+    
+    //ctime timestamps ("Www Mmm dd hh:mm:ss yyyy") have the hour at a fixed position, so they are read without any streams
+    if (date.length() >= 14 && date[3] == ' ' && date[10] == ' ' && date[13] == ':' && isdigit(date[11]) && isdigit(date[12])) {
+        int hour = (date[11] - '0') * 10 + (date[12] - '0');
+        return DayTimeBlockPair(date.substr(0, 3), hour / numberOfHoursPerBlock_);
+    }
     
     //extract the first 3 characters as they are a three character shorthand for the day of the week
-    string date = date_score_pair.first;
     string day = "";
     
     for (int i = 0; i < 3; i++) {
@@ -311,7 +324,8 @@ bool IntersectionDatabase::log(traffictrack::DateScorePair date_score_pair) {
     lock_guard<mutex> guard(dataMutex_);
     auto it = data_.find(key);
     if (it != data_.end()) {
-        it->second.add(date_score_pair);
+        it->second.add(std::move(date_score_pair));
+        changed_.insert(key);
         success = true;
     }
     
@@ -320,94 +334,169 @@ bool IntersectionDatabase::log(traffictrack::DateScorePair date_score_pair) {
 }
 
 
-/** @fn calculateAverages(std::promise<traffictrafk::AverageCongestionScores> p)
- *  @brief calculates the average congestion scores for each day time block
- *  @param p the promise that is used to return the value since this method will be used with a thread that can't return values
+/** @fn logBatch(std::vector<traffictrack::DateScorePair>& date_score_pairs)
+ *  @brief logs several congestion scores while taking the data lock once
+ *  @param date_score_pairs the scores, they are moved into the caches. consecutive scores from the same time block share one cache lookup
+ *  @return int the number of scores that were logged
  */
-void IntersectionDatabase::calculateAverages(std::promise<traffictrack::AverageCongestionScores> p) {
+int IntersectionDatabase::logBatch(std::vector<traffictrack::DateScorePair>& date_score_pairs) {
     
-    lock_guard<mutex> guard(fileMutex_);
+    //work out the keys before taking the lock
+    vector<DayTimeBlockPair> keys;
+    keys.reserve(date_score_pairs.size());
+    for (const DateScorePair& date_score_pair : date_score_pairs) {
+        keys.push_back(convertToDayTimeBlockPair(date_score_pair));
+    }
     
-    AverageCongestionScores light_average;
+    int logged = 0;
     
-    //go through each day time block pair
-    for (auto it = data_.cbegin(); it != data_.cend(); ++it) {
+    lock_guard<mutex> guard(dataMutex_);
+    auto it = data_.end();
+    for (size_t i = 0; i < date_score_pairs.size(); i++) {
         
-        const auto& cache = it->second.data();
+        if (it == data_.end() || it->first != keys[i]) {
+            it = data_.find(keys[i]);
+            if (it != data_.end()) {
+                changed_.insert(keys[i]);
+            }
+        }
         
-        CongestionScore averages;
+        if (it != data_.end()) {
+            it->second.add(std::move(date_score_pairs[i]));
+            logged++;
+        }
         
-        //default averages are 0
-        vector<int> north_sum = { 0, 0, 0 };
-        vector<int> east_sum = { 0, 0, 0 };
-        vector<int> south_sum = { 0, 0, 0 };
-        vector<int> west_sum = { 0, 0, 0 };
+    }
+    
+    return logged;
+    
+}
+
+
+/** @fn average(const Cache& cache) const
+ *  @brief averages the last prediction_level number of congestion scores in a cache
+ *  @param cache the cache of one day time block
+ *  @return traffictrack::CongestionScore the average, 0 in every direction if the cache is empty
+ */
+traffictrack::CongestionScore IntersectionDatabase::average(const Cache& cache) const {
+    
+    const auto& data = cache.data();
+    
+    CongestionScore averages;
+    
+    //default averages are 0
+    vector<int> north_sum = { 0, 0, 0 };
+    vector<int> east_sum = { 0, 0, 0 };
+    vector<int> south_sum = { 0, 0, 0 };
+    vector<int> west_sum = { 0, 0, 0 };
+    
+    int datapoints = 0;
+    
+    //go through the last prediction_level number of entries and add their values
+    for (auto it = data.crbegin(); it != data.crbegin() + std::min(static_cast<int>(data.size()), static_cast<int>(predictionLevel_)); ++it) {
         
-        int datapoints = 0;
+        const vector<int>& north_traffic = it->first.second.getNorth();
+        for (int i = 0; i < north_traffic.size(); i++) {
+            north_sum[i] += north_traffic[i];
+        }
         
-        //go through the last prediction_level number of entries and add their values
-        for (auto it1 = cache.crbegin(); it1 != cache.crbegin() + std::min(static_cast<int>(cache.size()), static_cast<int>(predictionLevel_)); ++it1) {
-            
-            const vector<int>& north_traffic = it1->first.second.getNorth();
-            for (int i = 0; i < north_traffic.size(); i++) {
-                north_sum[i] += north_traffic[i];
-            }
-            
-            const vector<int>& east_traffic = it1->first.second.getEast();
-            for (int i = 0; i < east_traffic.size(); i++) {
-                east_sum[i] += east_traffic[i];
-            }
-            
-            const vector<int>& south_traffic = it1->first.second.getSouth();
-            for (int i = 0; i < south_traffic.size(); i++) {
-                south_sum[i] += south_traffic[i];
-            }
-            
-            const vector<int>& west_traffic = it1->first.second.getWest();
-            for (int i = 0; i < west_traffic.size(); i++) {
-                west_sum[i] += west_traffic[i];
-            }
-            
-            datapoints++;
-            
+        const vector<int>& east_traffic = it->first.second.getEast();
+        for (int i = 0; i < east_traffic.size(); i++) {
+            east_sum[i] += east_traffic[i];
         }
         
-        //average the values
-        if (datapoints > 0) {
-            
-            for (int i = 0; i < north_sum.size(); i++) {
-                north_sum[i] /= datapoints;
-            }
-            
-            for (int i = 0; i < east_sum.size(); i++) {
-                east_sum[i] /= datapoints;
-            }
-            
-            for (int i = 0; i < south_sum.size(); i++) {
-                south_sum[i] /= datapoints;
-            }
-            
-            for (int i = 0; i < west_sum.size(); i++) {
-                west_sum[i] /= datapoints;
-            }
-            
+        const vector<int>& south_traffic = it->first.second.getSouth();
+        for (int i = 0; i < south_traffic.size(); i++) {
+            south_sum[i] += south_traffic[i];
+        }
+        
+        const vector<int>& west_traffic = it->first.second.getWest();
+        for (int i = 0; i < west_traffic.size(); i++) {
+            west_sum[i] += west_traffic[i];
+        }
+        
+        datapoints++;
+        
+    }
+    
+    //average the values
+    if (datapoints > 0) {
+        
+        for (int i = 0; i < north_sum.size(); i++) {
+            north_sum[i] /= datapoints;
+        }
+        
+        for (int i = 0; i < east_sum.size(); i++) {
+            east_sum[i] /= datapoints;
         }
         
-        //set the values in a congestion score object and add it to the list of averages
-        averages.setNorth(north_sum[0], north_sum[1], north_sum[2]);
-        averages.setEast(east_sum[0], east_sum[1], east_sum[2]);
-        averages.setSouth(south_sum[0], south_sum[1], south_sum[2]);
-        averages.setWest(west_sum[0], west_sum[1], west_sum[2]);
+        for (int i = 0; i < south_sum.size(); i++) {
+            south_sum[i] /= datapoints;
+        }
         
-        light_average[it->first] = averages;
+        for (int i = 0; i < west_sum.size(); i++) {
+            west_sum[i] /= datapoints;
+        }
         
     }
     
+    //set the values in a congestion score object
+    averages.setNorth(north_sum[0], north_sum[1], north_sum[2]);
+    averages.setEast(east_sum[0], east_sum[1], east_sum[2]);
+    averages.setSouth(south_sum[0], south_sum[1], south_sum[2]);
+    averages.setWest(west_sum[0], west_sum[1], west_sum[2]);
+    
+    return averages;
+    
+}
+
+
+/** @fn calculateAverages(std::promise<traffictrafk::AverageCongestionScores> p)
+ *  @brief calculates the average congestion scores for each day time block
+ *  @param p the promise that is used to return the value since this method will be used with a thread that can't return values
+ */
+void IntersectionDatabase::calculateAverages(std::promise<traffictrack::AverageCongestionScores> p) {
+    
+    lock_guard<mutex> guard(fileMutex_);
+    
+    AverageCongestionScores light_average;
+    
+    //go through each day time block pair
+    for (auto it = data_.cbegin(); it != data_.cend(); ++it) {
+        light_average[it->first] = average(it->second);
+    }
+    
     p.set_value(light_average);
     
 }
 
 
+/** @fn calculateChangedAverages()
+ *  @brief calculates the average congestion scores of the day time blocks logged to since the last call, the first call
+ *      covers every block. the work only depends on how many blocks got new data, not on the size of the database
+ *  @return traffictrack::AverageCongestionScores the averages of the changed blocks, empty if nothing was logged
+ */
+traffictrack::AverageCongestionScores IntersectionDatabase::calculateChangedAverages() {
+    
+    lock_guard<mutex> guard1(fileMutex_);
+    lock_guard<mutex> guard2(dataMutex_);
+    
+    AverageCongestionScores light_average;
+    
+    for (const DayTimeBlockPair& key : changed_) {
+        auto it = data_.find(key);
+        if (it != data_.end()) {
+            light_average[key] = average(it->second);
+        }
+    }
+    
+    changed_.clear();
+    
+    return light_average;
+    
+}
+
+
 /** @fn writeCache()
  *  @brief writes the data in the caches that haven't been written to a file already
  *  @return int the number of IO errors
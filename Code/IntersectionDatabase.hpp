@@ -10,6 +10,7 @@
 #define IntersectionDatabase_hpp
 
 #include <map>
+#include <set>
 #include <unordered_map>
 #include <mutex>
 #include <vector>
@@ -24,6 +25,7 @@
 #include "DatabaseLocation.h"
 #include "PredictionLevel.h"
 #include "Cache.hpp"
+#include "CongestionScore.hpp"
 
 /** @class IntersectionDatabase
  *  @brief manages congestion scores for intersections, returns an average congestion score over a period of time
@@ -44,20 +46,24 @@ protected:
     const traffictrack::PredictionLevel predictionLevel_;
     const std::vector<std::string> daysOfTheWeek_;
     std::map<traffictrack::DayTimeBlockPair, Cache> data_;
+    std::set<traffictrack::DayTimeBlockPair> changed_; /**< time blocks logged to since the last calculateChangedAverages(), guarded by dataMutex_ */
     
     IntersectionDatabase(traffictrack::IntersectionID intersection_ID, traffictrack::TimeBlock number_of_time_blocks, traffictrack::TempFile tmp_filename, traffictrack::DatabaseLocation database_directory, traffictrack::PredictionLevel prediction_level);
     void setupCaches();
     std::string generateFilename(traffictrack::DayTimeBlockPair p) const;
     std::string appendPath(std::string first, std::string second) const;
-    traffictrack::DayTimeBlockPair convertToDayTimeBlockPair(traffictrack::DateScorePair) const;
+    traffictrack::DayTimeBlockPair convertToDayTimeBlockPair(const traffictrack::DateScorePair& date_score_pair) const;
     std::string getCurrentDirectory() const;
+    traffictrack::CongestionScore average(const Cache& cache) const;
     
 public:
     static IntersectionDatabase* create(traffictrack::IntersectionID intersection_ID, traffictrack::TimeBlock number_of_time_blocks, traffictrack::TempFile tmp_filename, traffictrack::DatabaseLocation database_directory, traffictrack::PredictionLevel prediction_level);
     static IntersectionDatabase* instance(int intersection_ID);
     virtual ~IntersectionDatabase();
     bool log(traffictrack::DateScorePair date_score_pair);
+    int logBatch(std::vector<traffictrack::DateScorePair>& date_score_pairs);
     void calculateAverages(std::promise<traffictrack::AverageCongestionScores> p);
+    traffictrack::AverageCongestionScores calculateChangedAverages();
     int writeCache();
     
 };
@@ -0,0 +1,159 @@
+//
+//  IntersectionExecutor.cpp
+//  TraffikTrak
+//
+//  Created by Matt Lovick on 2026-10-19.
+//  Copyright © 2026 Matt Lovick. All rights reserved.
+//
+
+#include <vector>
+#include <deque>
+#include <mutex>
+#include <cstdlib>
+#include <functional>
+#include "IntersectionExecutor.hpp"
+
+using namespace std;
+
+
+IntersectionExecutor* IntersectionExecutor::instance_ = nullptr;
+std::mutex IntersectionExecutor::staticMutex_;
+
+
+/** @fn IntersectionExecutor(int shards, TaskPool* pool)
+ *  @brief constructor creates the shards, no threads are started
+ *  @param shards the number of shards, 0 for four per worker of the pool
+ *  @param pool the pool the shards run on, nullptr for the shared pool
+ */
+IntersectionExecutor::IntersectionExecutor(int shards, TaskPool* pool) : pool_(pool), scheduled_(0) {
+    
+    if (pool_ == nullptr) {
+        pool_ = TaskPool::shared();
+    }
+    
+    //a few shards per worker, so a shard with a slow task does not hold up a whole worker's share of the intersections
+    if (shards <= 0) {
+        shards = pool_->size() * 4;
+    }
+    
+    for (int i = 0; i < shards; i++) {
+        shards_.push_back(new Shard());
+    }
+    
+}
+
+
+/** @fn instance()
+ *  @brief the executor used by intersections that are started on their own, created the first time it is used
+ *  @return IntersectionExecutor*
+ */
+IntersectionExecutor* IntersectionExecutor::instance() {
+    
+    lock_guard<mutex> guard(staticMutex_);
+    if (instance_ == nullptr) {
+        instance_ = new IntersectionExecutor();
+    }
+    return instance_;
+    
+}
+
+
+/** @fn ~IntersectionExecutor()
+ *  @brief destructor waits for the tasks that were already posted
+ */
+IntersectionExecutor::~IntersectionExecutor() {
+    
+    {
+        unique_lock<mutex> lock(scheduledMutex_);
+        scheduledCondition_.wait(lock, [this]() { return scheduled_ == 0; });
+    }
+    
+    for (Shard* shard : shards_) {
+        delete shard;
+    }
+    
+}
+
+
+/** @fn runShard(Shard* shard)
+ *  @brief runs on the pool: runs the tasks of a shard in order, and requeues the shard after a few tasks if more are waiting
+ *  @param shard the shard
+ */
+void IntersectionExecutor::runShard(Shard* shard) {
+    
+    for (int i = 0; i < tasksPerTurn_; i++) {
+        
+        function<void()> task;
+        {
+            lock_guard<mutex> guard(shard->mutex);
+            if (shard->tasks.empty()) {
+                shard->scheduled = false;
+                break;
+            }
+            task = std::move(shard->tasks.front());
+            shard->tasks.pop_front();
+        }
+        
+        task();
+        
+        if (i + 1 == tasksPerTurn_) {
+            pool_->post([this, shard]() { runShard(shard); });
+            return;
+        }
+        
+    }
+    
+    lock_guard<mutex> guard(scheduledMutex_);
+    scheduled_--;
+    scheduledCondition_.notify_all();
+    
+}
+
+
+/** @fn shards() const
+ *  @brief getter for the number of shards
+ *  @return int
+ */
+int IntersectionExecutor::shards() const {
+    return static_cast<int>(shards_.size());
+}
+
+
+/** @fn shardOf(traffictrack::IntersectionID ID) const
+ *  @brief the shard that runs the tasks of an intersection
+ *  @param ID the id of the intersection
+ *  @return int between 0 and shards()-1
+ */
+int IntersectionExecutor::shardOf(traffictrack::IntersectionID ID) const {
+    return abs(static_cast<int>(ID)) % static_cast<int>(shards_.size());
+}
+
+
+/** @fn post(traffictrack::IntersectionID ID, std::function<void()> task)
+ *  @brief queues a task on the shard of an intersection
+ *  @param ID the id of the intersection the task belongs to
+ *  @param task the task, it should not block for long since the other intersections on the shard wait for it
+ */
+void IntersectionExecutor::post(traffictrack::IntersectionID ID, std::function<void()> task) {
+    
+    Shard* shard = shards_[shardOf(ID)];
+    bool schedule = false;
+    
+    {
+        lock_guard<mutex> guard(shard->mutex);
+        shard->tasks.push_back(std::move(task));
+        if (!shard->scheduled) {
+            shard->scheduled = true;
+            schedule = true;
+        }
+    }
+    
+    if (schedule) {
+        {
+            lock_guard<mutex> guard(scheduledMutex_);
+            scheduled_++;
+        }
+        pool_->post([this, shard]() { runShard(shard); });
+    }
+    
+}
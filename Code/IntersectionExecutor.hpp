@@ -0,0 +1,61 @@
+//
+//  IntersectionExecutor.hpp
+//  TraffikTrak
+//
+//  Created by Matt Lovick on 2026-10-19.
+//  Copyright © 2026 Matt Lovick. All rights reserved.
+//
+
+#ifndef IntersectionExecutor_hpp
+#define IntersectionExecutor_hpp
+
+#include <vector>
+#include <deque>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+#include "IntersectionID.h"
+#include "TaskPool.hpp"
+
+/** @class IntersectionExecutor
+ *  @brief runs the monitoring cycles of many intersections on the shared TaskPool, sharded by intersection ID
+ *
+ *  every intersection is pinned to one shard. a shard runs its tasks one at a time and in the order they were posted, on
+ *  whichever worker of the pool is free, so the steps of one intersection never run at the same time while different
+ *  shards spread over all the workers. the number of threads does not grow with the number of intersections
+ *  @author Matthew Lovick
+ */
+class IntersectionExecutor {
+    
+protected:
+    /** @struct Shard
+     *  @brief tasks of the intersections of one shard, waiting to run in order
+     */
+    struct Shard {
+        std::mutex mutex; /**< synchronize access to tasks and scheduled */
+        std::deque<std::function<void()>> tasks;
+        bool scheduled = false; /**< a task that runs the shard is queued or running on the pool */
+    };
+    
+    static IntersectionExecutor* instance_; /**< static instance used by intersections started with Intersection::run() */
+    static std::mutex staticMutex_;
+    static const int tasksPerTurn_ = 16; /**< tasks a shard runs before it lets the other shards have the worker */
+    TaskPool* pool_;
+    std::vector<Shard*> shards_;
+    std::mutex scheduledMutex_; /**< synchronize access to scheduled_ */
+    std::condition_variable scheduledCondition_; /**< signals the destructor that a shard is no longer scheduled */
+    int scheduled_; /**< shards that are queued or running on the pool */
+    
+    void runShard(Shard* shard);
+    
+public:
+    IntersectionExecutor(int shards = 0, TaskPool* pool = nullptr);
+    static IntersectionExecutor* instance();
+    virtual ~IntersectionExecutor();
+    int shards() const;
+    int shardOf(traffictrack::IntersectionID ID) const;
+    void post(traffictrack::IntersectionID ID, std::function<void()> task);
+    
+};
+
+#endif /* IntersectionExecutor_hpp */
@@ -0,0 +1,168 @@
+//
+//  LatencyHistogram.cpp
+//  TraffikTrak
+//
+//  Created by Matt Lovick on 2026-10-19.
+//  Copyright © 2026 Matt Lovick. All rights reserved.
+//
+
+#include <atomic>
+#include <ostream>
+#include <string>
+#include <algorithm>
+#include "LatencyHistogram.hpp"
+
+using namespace std;
+
+
+/** @fn LatencyHistogram()
+ *  @brief constructor starts with every bucket empty
+ */
+LatencyHistogram::LatencyHistogram() {
+    reset();
+}
+
+
+/** @fn ~LatencyHistogram()
+ *  @brief destructor does nothing
+ */
+LatencyHistogram::~LatencyHistogram() { }
+
+
+/** @fn record(long long microseconds)
+ *  @brief adds one latency to the histogram, negative latencies count as 0
+ *  @param microseconds the latency
+ */
+void LatencyHistogram::record(long long microseconds) {
+    
+    if (microseconds < 0) {
+        microseconds = 0;
+    }
+    
+    int index = 0;
+    while (index < NUMBER_OF_BUCKETS - 1 && microseconds >= bucketUpperBound(index)) {
+        index++;
+    }
+    
+    buckets_[index]++;
+    count_++;
+    total_ += microseconds;
+    
+    long long current = max_.load();
+    while (microseconds > current && !max_.compare_exchange_weak(current, microseconds)) { }
+    
+}
+
+
+/** @fn reset()
+ *  @brief empties every bucket
+ */
+void LatencyHistogram::reset() {
+    
+    for (int i = 0; i < NUMBER_OF_BUCKETS; i++) {
+        buckets_[i] = 0;
+    }
+    count_ = 0;
+    total_ = 0;
+    max_ = 0;
+    
+}
+
+
+/** @fn count() const
+ *  @brief the number of latencies recorded
+ *  @return long long
+ */
+long long LatencyHistogram::count() const {
+    return count_;
+}
+
+
+/** @fn mean() const
+ *  @brief the mean latency in microseconds
+ *  @return double 0 if nothing was recorded
+ */
+double LatencyHistogram::mean() const {
+    
+    long long n = count_;
+    return n > 0 ? static_cast<double>(total_) / n : 0;
+    
+}
+
+
+/** @fn max() const
+ *  @brief the largest latency recorded, in microseconds
+ *  @return long long
+ */
+long long LatencyHistogram::max() const {
+    return max_;
+}
+
+
+/** @fn percentile(double fraction) const
+ *  @brief upper bound of the bucket that holds the given fraction of the latencies, e.g. 0.99 for the 99th percentile
+ *  @param fraction between 0 and 1
+ *  @return long long microseconds, never more than max()
+ */
+long long LatencyHistogram::percentile(double fraction) const {
+    
+    long long n = count_;
+    if (n == 0) {
+        return 0;
+    }
+    
+    long long target = static_cast<long long>(fraction * n + 0.5);
+    if (target < 1) {
+        target = 1;
+    }
+    
+    long long seen = 0;
+    for (int i = 0; i < NUMBER_OF_BUCKETS; i++) {
+        seen += buckets_[i];
+        if (seen >= target) {
+            return std::min(bucketUpperBound(i), max());
+        }
+    }
+    
+    return max();
+    
+}
+
+
+/** @fn bucket(int index) const
+ *  @brief the number of latencies in a bucket
+ *  @param index between 0 and NUMBER_OF_BUCKETS-1
+ *  @return long long
+ */
+long long LatencyHistogram::bucket(int index) const {
+    return buckets_[index];
+}
+
+
+/** @fn bucketUpperBound(int index)
+ *  @brief the first latency, in microseconds, that no longer belongs in a bucket
+ *  @param index between 0 and NUMBER_OF_BUCKETS-1
+ *  @return long long
+ */
+long long LatencyHistogram::bucketUpperBound(int index) {
+    return 1LL << index;
+}
+
+
+/** @fn print(std::ostream& out) const
+ *  @brief writes the summary and the non-empty buckets, one per line
+ *  @param out the stream to write to
+ */
+void LatencyHistogram::print(std::ostream& out) const {
+    
+    out << "count " << count() << " | mean " << mean() << " us | p50 " << percentile(0.5) << " us | p99 " << percentile(0.99) << " us | max " << max() << " us" << endl;
+    
+    for (int i = 0; i < NUMBER_OF_BUCKETS; i++) {
+        long long n = buckets_[i];
+        if (n > 0) {
+            long long low = i == 0 ? 0 : bucketUpperBound(i - 1);
+            out << "  [" << low << ", " << (i == NUMBER_OF_BUCKETS - 1 ? string("inf") : to_string(bucketUpperBound(i))) << ") us: " << n << endl;
+        }
+    }
+    
+}
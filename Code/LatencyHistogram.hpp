@@ -0,0 +1,49 @@
+//
+//  LatencyHistogram.hpp
+//  TraffikTrak
+//
+//  Created by Matt Lovick on 2026-10-19.
+//  Copyright © 2026 Matt Lovick. All rights reserved.
+//
+
+#ifndef LatencyHistogram_hpp
+#define LatencyHistogram_hpp
+
+#include <atomic>
+#include <string>
+#include <ostream>
+
+/** @class LatencyHistogram
+ *  @brief lock-free histogram of latencies in microseconds, with one bucket per power of two
+ *
+ *  bucket 0 holds latencies below 1 us and bucket i holds [2^(i-1), 2^i) us, the last bucket also holds everything larger.
+ *  any number of threads can record at once
+ *  @author Matthew Lovick
+ */
+class LatencyHistogram {
+    
+public:
+    static const int NUMBER_OF_BUCKETS = 28; /**< the last regular bucket ends at 2^26 us, a bit over a minute */
+    
+protected:
+    std::atomic<long long> buckets_[NUMBER_OF_BUCKETS];
+    std::atomic<long long> count_;
+    std::atomic<long long> total_;
+    std::atomic<long long> max_;
+    
+public:
+    LatencyHistogram();
+    virtual ~LatencyHistogram();
+    void record(long long microseconds);
+    void reset();
+    long long count() const;
+    double mean() const;
+    long long max() const;
+    long long percentile(double fraction) const;
+    long long bucket(int index) const;
+    static long long bucketUpperBound(int index);
+    void print(std::ostream& out) const;
+    
+};
+
+#endif /* LatencyHistogram_hpp */
@@ -0,0 +1,351 @@
+//
+//  MapFileReader.cpp
+//  TraffikTrak
+//
+//  Created by Matt Lovick on 2026-10-19.
+//  Copyright © 2026 Matt Lovick. All rights reserved.
+//
+
+#include <string>
+#include <vector>
+#include <fstream>
+#include <cstring>
+#include <cstdint>
+#include <cmath>
+#include <climits>
+#include "MapFileReader.hpp"
+#include "IOException.hpp"
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+using namespace std;
+
+
+/** @fn MapFileReader(const std::string& filename)
+ *  @brief opens the file and maps it into memory, the first line is read by nextLine()
+ *  @param filename the map file
+ */
+MapFileReader::MapFileReader(const std::string& filename) : filename_(filename), mapping_(nullptr), data_(nullptr), size_(0), line_(0) {
+
+    bool loaded = false;
+
+#if defined(__unix__) || defined(__APPLE__)
+    int file = open(filename.c_str(), O_RDONLY);
+    if (file < 0) {
+        throw IOException("file " + filename + " not found");
+    }
+
+    struct stat status;
+    if (fstat(file, &status) == 0 && S_ISREG(status.st_mode)) {
+        if (status.st_size == 0) {
+            loaded = true;
+        }
+        else {
+            void* mapping = mmap(nullptr, static_cast<size_t>(status.st_size), PROT_READ, MAP_PRIVATE, file, 0);
+            if (mapping != MAP_FAILED) {
+                madvise(mapping, static_cast<size_t>(status.st_size), MADV_SEQUENTIAL);
+                mapping_ = mapping;
+                data_ = static_cast<const char*>(mapping);
+                size_ = static_cast<size_t>(status.st_size);
+                loaded = true;
+            }
+        }
+    }
+    close(file);
+#endif
+
+    //files that cannot be mapped, like pipes, are read in one go
+    if (!loaded) {
+        ifstream in(filename, ios::binary);
+        if (!in.is_open()) {
+            throw IOException("file " + filename + " not found");
+        }
+        buffer_.assign(istreambuf_iterator<char>(in), istreambuf_iterator<char>());
+        data_ = buffer_.data();
+        size_ = buffer_.size();
+    }
+
+    next_ = data_;
+    lineStart_ = cursor_ = lineEnd_ = data_;
+
+}
+
+
+/** @fn ~MapFileReader()
+ *  @brief unmaps the file
+ */
+MapFileReader::~MapFileReader() {
+
+#if defined(__unix__) || defined(__APPLE__)
+    if (mapping_ != nullptr) {
+        munmap(mapping_, size_);
+    }
+#endif
+
+}
+
+
+/** @fn size() const
+ *  @brief the size of the file in bytes
+ *  @return size_t
+ */
+size_t MapFileReader::size() const {
+    return size_;
+}
+
+
+/** @fn line() const
+ *  @brief the number of the current line, counted from 1, 0 before the first nextLine()
+ *  @return int
+ */
+int MapFileReader::line() const {
+    return line_;
+}
+
+
+/** @fn where() const
+ *  @brief the file and the current line, for error messages
+ *  @return std::string like "map.txt at line 12"
+ */
+std::string MapFileReader::where() const {
+    return filename_ + " at line " + to_string(line_);
+}
+
+
+/** @fn nextLine()
+ *  @brief moves on to the next line
+ *  @return bool false at the end of the file
+ */
+bool MapFileReader::nextLine() {
+
+    const char* end = data_ + size_;
+    if (next_ >= end) {
+        return false;
+    }
+
+    const char* newline = static_cast<const char*>(memchr(next_, '\n', static_cast<size_t>(end - next_)));
+    lineStart_ = cursor_ = next_;
+    lineEnd_ = newline != nullptr ? newline : end;
+    next_ = newline != nullptr ? newline + 1 : end;
+    line_++;
+
+    return true;
+
+}
+
+
+/** @fn rewindLine()
+ *  @brief goes back to the start of the current line, so it can be read differently
+ */
+void MapFileReader::rewindLine() {
+    cursor_ = lineStart_;
+}
+
+
+/** @fn skipSpaces()
+ *  @brief moves the cursor past spaces, tabs and carriage returns
+ */
+void MapFileReader::skipSpaces() {
+
+    while (cursor_ < lineEnd_ && (*cursor_ == ' ' || *cursor_ == '\t' || *cursor_ == '\r')) {
+        cursor_++;
+    }
+
+}
+
+
+/** @fn endOfToken(const char* position) const
+ *  @brief whether a token that ends just before position is followed by a separator or the end of the line
+ */
+bool MapFileReader::endOfToken(const char* position) const {
+    return position == lineEnd_ || *position == ' ' || *position == '\t' || *position == '\r';
+}
+
+
+/** @fn blank()
+ *  @brief whether the rest of the line is empty
+ *  @return bool
+ */
+bool MapFileReader::blank() {
+
+    skipSpaces();
+    return cursor_ == lineEnd_;
+
+}
+
+
+/** @fn readInt(int& value)
+ *  @brief reads a whole number in decimal, with an optional sign
+ *  @param value set to the number
+ *  @return bool false if the next token is not a number that fits in an int, value is then left as it was
+ */
+bool MapFileReader::readInt(int& value) {
+
+    skipSpaces();
+    const char* p = cursor_;
+
+    bool negative = false;
+    if (p < lineEnd_ && (*p == '-' || *p == '+')) {
+        negative = *p == '-';
+        p++;
+    }
+
+    const char* digits = p;
+    long long number = 0;
+    while (p < lineEnd_ && static_cast<unsigned>(*p - '0') < 10) {
+        number = number * 10 + (*p - '0');
+        if (number > static_cast<long long>(INT_MAX) + 1) {
+            return false;
+        }
+        p++;
+    }
+
+    if (p == digits || !endOfToken(p)) {
+        return false;
+    }
+    if (negative) {
+        number = -number;
+    }
+    if (number > INT_MAX || number < INT_MIN) {
+        return false;
+    }
+
+    value = static_cast<int>(number);
+    cursor_ = p;
+    return true;
+
+}
+
+
+/** @fn readFloat(float& value)
+ *  @brief reads a decimal number with an optional sign, fraction and exponent, like "12", "-0.5" or "1.5e3"
+ *
+ *  the first 19 significant digits are gathered into an integer and scaled once by a power of ten, which is exact for
+ *  the numbers map files hold and within a float's precision for the others
+ *  @param value set to the number
+ *  @return bool false if the next token is not such a number, value is then left as it was
+ */
+bool MapFileReader::readFloat(float& value) {
+
+    static const double powers[] = { 1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11, 1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22 };
+
+    skipSpaces();
+    const char* p = cursor_;
+
+    bool negative = false;
+    if (p < lineEnd_ && (*p == '-' || *p == '+')) {
+        negative = *p == '-';
+        p++;
+    }
+
+    uint64_t mantissa = 0;
+    int significant = 0;
+    int exponent = 0;
+    bool digits = false;
+
+    while (p < lineEnd_ && static_cast<unsigned>(*p - '0') < 10) {
+        if (significant < 19) {
+            mantissa = mantissa * 10 + static_cast<unsigned>(*p - '0');
+            significant += mantissa != 0;
+        }
+        else {
+            exponent++;
+        }
+        digits = true;
+        p++;
+    }
+
+    if (p < lineEnd_ && *p == '.') {
+        p++;
+        while (p < lineEnd_ && static_cast<unsigned>(*p - '0') < 10) {
+            if (significant < 19) {
+                mantissa = mantissa * 10 + static_cast<unsigned>(*p - '0');
+                significant += mantissa != 0;
+                exponent--;
+            }
+            digits = true;
+            p++;
+        }
+    }
+
+    if (!digits) {
+        return false;
+    }
+
+    if (p < lineEnd_ && (*p == 'e' || *p == 'E')) {
+
+        const char* e = p + 1;
+        bool negativeExponent = false;
+        if (e < lineEnd_ && (*e == '-' || *e == '+')) {
+            negativeExponent = *e == '-';
+            e++;
+        }
+
+        const char* exponentDigits = e;
+        int written = 0;
+        while (e < lineEnd_ && static_cast<unsigned>(*e - '0') < 10) {
+            written = written < 10000 ? written * 10 + (*e - '0') : written;
+            e++;
+        }
+        if (e == exponentDigits) {
+            return false;
+        }
+
+        exponent += negativeExponent ? -written : written;
+        p = e;
+
+    }
+
+    if (!endOfToken(p)) {
+        return false;
+    }
+
+    double number = static_cast<double>(mantissa);
+    if (mantissa != 0) {
+        if (exponent >= 0 && exponent <= 22) {
+            number *= powers[exponent];
+        }
+        else if (exponent < 0 && exponent >= -22) {
+            number /= powers[-exponent];
+        }
+        else {
+            number *= pow(10.0, exponent);
+        }
+    }
+
+    value = static_cast<float>(negative ? -number : number);
+    cursor_ = p;
+    return true;
+
+}
+
+
+/** @fn readWord(const char*& word, size_t& length)
+ *  @brief reads the characters up to the next separator
+ *  @param word set to the first character of the word, in the file itself
+ *  @param length set to the number of characters
+ *  @return bool false if the rest of the line is empty
+ */
+bool MapFileReader::readWord(const char*& word, size_t& length) {
+
+    skipSpaces();
+    if (cursor_ == lineEnd_) {
+        return false;
+    }
+
+    const char* p = cursor_;
+    while (!endOfToken(p)) {
+        p++;
+    }
+
+    word = cursor_;
+    length = static_cast<size_t>(p - cursor_);
+    cursor_ = p;
+    return true;
+
+}
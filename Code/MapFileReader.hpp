@@ -0,0 +1,61 @@
+//
+//  MapFileReader.hpp
+//  TraffikTrak
+//
+//  Created by Matt Lovick on 2026-10-19.
+//  Copyright © 2026 Matt Lovick. All rights reserved.
+//
+
+#ifndef MapFileReader_hpp
+#define MapFileReader_hpp
+
+#include <string>
+#include <vector>
+#include <cstddef>
+
+
+/** @class MapFileReader
+ *  @brief reads a map file line by line and splits each line into numbers and words, for the map file parsers
+ *
+ *  the file is mapped into memory, or read into a buffer in one go where it cannot be, and the lines and tokens are
+ *  found in a single pass over it: nothing is copied, no stream or locale is involved and numbers are converted straight
+ *  from the characters, like std::from_chars. tokens are separated by spaces, tabs or a carriage return, and never go past
+ *  the end of their line. a read that fails leaves the line where it was, and where() names the file and the line for
+ *  the error message
+ *  @author Matthew Lovick
+ */
+class MapFileReader {
+
+protected:
+    std::string filename_;
+    void* mapping_; /**< the mapped file, nullptr if it was read into buffer_ instead */
+    std::vector<char> buffer_;
+    const char* data_; /**< the contents of the file */
+    size_t size_;
+    const char* next_; /**< start of the line after the current one */
+    const char* lineStart_;
+    const char* cursor_; /**< the next character of the current line to read */
+    const char* lineEnd_;
+    int line_; /**< number of the current line, from 1 */
+
+    void skipSpaces();
+    bool endOfToken(const char* position) const;
+
+public:
+    MapFileReader(const std::string& filename);
+    MapFileReader(const MapFileReader&) = delete;
+    MapFileReader& operator = (const MapFileReader&) = delete;
+    virtual ~MapFileReader();
+    size_t size() const;
+    int line() const;
+    std::string where() const;
+    bool nextLine();
+    void rewindLine();
+    bool blank();
+    bool readInt(int& value);
+    bool readFloat(float& value);
+    bool readWord(const char*& word, size_t& length);
+
+};
+
+#endif /* MapFileReader_hpp */
@@ -0,0 +1,344 @@
+//
+//  MapGenerator.cpp
+//  TraffikTrak
+//
+//  Created by Matt Lovick on 2026-10-19.
+//  Copyright © 2026 Matt Lovick. All rights reserved.
+//
+
+#include <vector>
+#include <string>
+#include <utility>
+#include <fstream>
+#include <sstream>
+#include <iomanip>
+#include <random>
+#include <algorithm>
+#include <numeric>
+#include <cmath>
+#include "MapGenerator.hpp"
+#include "Direction.h"
+
+using namespace std;
+using namespace traffictrack;
+
+
+/** @fn MapGenerator(const Settings& settings)
+ *  @brief constructor, the map is made by generate()
+ *  @param settings what kind of map to make
+ */
+MapGenerator::MapGenerator(const Settings& settings) : settings_(settings), random_(settings.seed) { }
+
+
+/** @fn ~MapGenerator()
+ *  @brief destructor that does nothing
+ */
+MapGenerator::~MapGenerator() { }
+
+
+/** @fn parseLayout(const std::string& name, Layout& layout)
+ *  @brief reads a layout from its name, "grid", "radial" or "planar"
+ *  @return bool false if the name is unknown
+ */
+bool MapGenerator::parseLayout(const std::string& name, Layout& layout) {
+
+    if (name == "grid") {
+        layout = GRID;
+    }
+    else if (name == "radial") {
+        layout = RADIAL;
+    }
+    else if (name == "planar") {
+        layout = PLANAR;
+    }
+    else {
+        return false;
+    }
+    return true;
+
+}
+
+
+/** @fn parseLengths(const std::string& description, Settings& settings)
+ *  @brief reads the lengths of the roads from "straight:detour", "uniform:min:max" or "exponential:min:mean"
+ *  @param description the lengths, the detour defaults to 1.5
+ *  @param settings gets the lengths and their parameters
+ *  @return bool false if the description is not one of the above or its numbers make no sense
+ */
+bool MapGenerator::parseLengths(const std::string& description, Settings& settings) {
+
+    istringstream ss(description);
+    string name, number;
+    vector<float> numbers;
+
+    getline(ss, name, ':');
+    while (getline(ss, number, ':')) {
+        istringstream value(number);
+        float f = 0;
+        if (!(value >> f) || f < 0) {
+            return false;
+        }
+        numbers.push_back(f);
+    }
+
+    if (name == "straight" && numbers.size() <= 1) {
+        settings.lengths = STRAIGHT;
+        settings.first = numbers.empty() ? 1.5f : numbers[0];
+        return settings.first >= 1;
+    }
+    if (name == "uniform" && numbers.size() == 2) {
+        settings.lengths = UNIFORM;
+        settings.first = numbers[0];
+        settings.second = numbers[1];
+        return settings.first <= settings.second;
+    }
+    if (name == "exponential" && numbers.size() == 2) {
+        settings.lengths = EXPONENTIAL;
+        settings.first = numbers[0];
+        settings.second = numbers[1];
+        return settings.second > 0;
+    }
+    return false;
+
+}
+
+
+/** @fn addRoad(int from, int to, traffictrack::Direction direction)
+ *  @brief adds a road between two intersections whose positions are set, with a length drawn from the settings
+ */
+void MapGenerator::addRoad(int from, int to, traffictrack::Direction direction) {
+
+    float length = 0;
+
+    switch (settings_.lengths) {
+        case STRAIGHT: {
+            float straight = hypot(positions_[to].first - positions_[from].first, positions_[to].second - positions_[from].second);
+            length = straight * uniform_real_distribution<float>(1, settings_.first)(random_);
+            break;
+        }
+        case UNIFORM:
+            length = uniform_real_distribution<float>(settings_.first, settings_.second)(random_);
+            break;
+        case EXPONENTIAL:
+            length = settings_.first + exponential_distribution<float>(1 / settings_.second)(random_);
+            break;
+    }
+
+    Road road = { from, to, length, direction };
+    roads_.push_back(road);
+
+}
+
+
+/** @fn generate()
+ *  @brief makes the map, replacing the one made before
+ */
+void MapGenerator::generate() {
+
+    positions_.clear();
+    roads_.clear();
+    hospitals_.clear();
+    random_.seed(settings_.seed);
+
+    const float block = settings_.blockLength;
+    const int wanted = max(4, settings_.intersections);
+
+    if (settings_.layout == RADIAL) {
+
+        //about as many spokes as rings, the first ring is one block from the center
+        const int spokes = max(4, static_cast<int>(lround(sqrt(static_cast<double>(wanted)))));
+        const int rings = max(1, (wanted + spokes/2) / spokes);
+        const double turn = 2*acos(-1.0) / spokes;
+
+        for (int ring = 0; ring < rings; ring++) {
+            for (int spoke = 0; spoke < spokes; spoke++) {
+                float radius = block * (ring + 1);
+                positions_.push_back(make_pair(static_cast<float>(radius * sin(spoke*turn)), static_cast<float>(-radius * cos(spoke*turn))));
+            }
+        }
+
+        roads_.reserve(2 * positions_.size());
+        for (int ring = 0; ring < rings; ring++) {
+            for (int spoke = 0; spoke < spokes; spoke++) {
+                int current = ring*spokes + spoke;
+                addRoad(current, ring*spokes + (spoke + 1) % spokes, Direction::EAST);
+                if (ring + 1 < rings) {
+                    addRoad(current, current + spokes, Direction::NORTH);
+                }
+            }
+        }
+
+    }
+    else {
+
+        const int side = max(2, static_cast<int>(lround(sqrt(static_cast<double>(wanted)))));
+
+        //a third of a block at most, so the roads of a row and of a column never cross
+        uniform_real_distribution<float> shift(-block/3, block/3);
+        for (int i = 0; i < side*side; i++) {
+            float x = block * (i % side), y = block * (i / side);
+            if (settings_.layout == PLANAR) {
+                x += shift(random_);
+                y += shift(random_);
+            }
+            positions_.push_back(make_pair(x, y));
+        }
+
+        //every road of the grid, east then south
+        vector<pair<int, int>> candidates;
+        candidates.reserve(2 * side * side);
+        for (int i = 0; i < side*side; i++) {
+            if (i % side + 1 < side) {
+                candidates.push_back(make_pair(i, i + 1));
+            }
+            if (i / side + 1 < side) {
+                candidates.push_back(make_pair(i, i + side));
+            }
+        }
+
+        vector<char> kept(candidates.size(), true);
+
+        if (settings_.layout == PLANAR) {
+
+            //the roads in random order, a road that joins two parts not yet connected is part of the spanning tree
+            vector<int> order(candidates.size());
+            iota(order.begin(), order.end(), 0);
+            shuffle(order.begin(), order.end(), random_);
+
+            vector<int> parent(side*side);
+            iota(parent.begin(), parent.end(), 0);
+            auto root = [&parent](int node) {
+                while (parent[node] != node) {
+                    parent[node] = parent[parent[node]];
+                    node = parent[node];
+                }
+                return node;
+            };
+
+            bernoulli_distribution keep(settings_.keptRoads);
+            for (int index : order) {
+                int a = root(candidates[index].first), b = root(candidates[index].second);
+                if (a != b) {
+                    parent[a] = b;
+                }
+                else {
+                    kept[index] = keep(random_);
+                }
+            }
+
+        }
+
+        roads_.reserve(candidates.size());
+        for (size_t i = 0; i < candidates.size(); i++) {
+            if (kept[i]) {
+                bool east = candidates[i].second == candidates[i].first + 1;
+                addRoad(candidates[i].first, candidates[i].second, east ? Direction::EAST : Direction::SOUTH);
+            }
+        }
+
+    }
+
+    uniform_int_distribution<int> perThousand(0, 999);
+    for (int i = 0; i < size(); i++) {
+        if (perThousand(random_) < settings_.hospitalsPerThousand) {
+            hospitals_.push_back(i);
+        }
+    }
+    if (hospitals_.empty()) {
+        hospitals_.push_back(uniform_int_distribution<int>(0, size() - 1)(random_));
+    }
+
+}
+
+
+/** @fn size() const
+ *  @brief the number of intersections of the map
+ *  @return int
+ */
+int MapGenerator::size() const {
+    return static_cast<int>(positions_.size());
+}
+
+
+/** @fn roads() const
+ *  @brief the number of roads of the map, counting each direction once
+ *  @return int
+ */
+int MapGenerator::roads() const {
+    return static_cast<int>(2 * roads_.size());
+}
+
+
+/** @fn hospitals() const
+ *  @brief getter for the intersections with a hospital
+ *  @return const std::vector<int>&
+ */
+const std::vector<int>& MapGenerator::hospitals() const {
+    return hospitals_;
+}
+
+
+/** @fn writeSections(std::ostream& out) const
+ *  @brief writes the roads and the coordinates and hospitals sections, which both formats share
+ */
+void MapGenerator::writeSections(std::ostream& out) const {
+
+    static const char letters[] = { 'N', 'E', 'S', 'W' };
+
+    out << fixed << setprecision(1);
+    for (const Road& road : roads_) {
+        out << road.from << ' ' << road.to << ' ' << road.length << ' ' << letters[road.direction] << '\n';
+    }
+
+    out << "coordinates\n";
+    for (int i = 0; i < size(); i++) {
+        out << i << ' ' << positions_[i].first << ' ' << positions_[i].second << '\n';
+    }
+
+    out << "hospitals\n";
+    for (int hospital : hospitals_) {
+        out << hospital << '\n';
+    }
+
+}
+
+
+/** @fn writeQuick(const std::string& filename) const
+ *  @brief writes the map in the format of QuickMapFileParser, the intersections are numbered from 0
+ *  @return bool false if the file could not be written
+ */
+bool MapGenerator::writeQuick(const std::string& filename) const {
+
+    ofstream out(filename);
+    if (!out.is_open()) {
+        return false;
+    }
+
+    out << size() << '\n';
+    writeSections(out);
+
+    return out.good();
+
+}
+
+
+/** @fn writeExplicit(const std::string& filename) const
+ *  @brief writes the map in the format of ExplicitMapFileParser, with the same IDs as writeQuick()
+ *  @return bool false if the file could not be written
+ */
+bool MapGenerator::writeExplicit(const std::string& filename) const {
+
+    ofstream out(filename);
+    if (!out.is_open()) {
+        return false;
+    }
+
+    out << size() << '\n';
+    for (int i = 0; i < size(); i++) {
+        out << i << '\n';
+    }
+    writeSections(out);
+
+    return out.good();
+
+}
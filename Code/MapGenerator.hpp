@@ -0,0 +1,100 @@
+//
+//  MapGenerator.hpp
+//  TraffikTrak
+//
+//  Created by Matt Lovick on 2026-10-19.
+//  Copyright © 2026 Matt Lovick. All rights reserved.
+//
+
+#ifndef MapGenerator_hpp
+#define MapGenerator_hpp
+
+#include <vector>
+#include <string>
+#include <utility>
+#include <ostream>
+#include <random>
+#include "Direction.h"
+
+
+/** @class MapGenerator
+ *  @brief makes up city maps of any size to test the routing with, and writes them in the formats of QuickMapFileParser
+ *      and ExplicitMapFileParser
+ *
+ *  every road goes both ways, like the roads of the map files. an intersection has at most one road per direction, the
+ *  layouts are chosen so that this always holds:
+ *
+ *      GRID    a square grid, the roads follow the rows and columns
+ *      RADIAL  rings around the center crossed by spokes. north is outwards along a spoke and east is clockwise along a
+ *              ring, so the directions are the ones a driver sees rather than the ones on a compass
+ *      PLANAR  a grid whose intersections are moved by up to a third of a block, with a random spanning tree of its roads
+ *              and a random share of the others. no two roads cross and every intersection can reach every other
+ *
+ *  the length of a road is either its straight length made longer by a random detour (STRAIGHT), or is drawn without
+ *  looking at where the intersections are (UNIFORM, EXPONENTIAL). the positions are written to the "coordinates" section
+ *  and the hospitals, a given share of the intersections and always at least one, to the "hospitals" section
+ *  @author Matthew Lovick
+ */
+class MapGenerator {
+
+public:
+    enum Layout {
+        GRID, RADIAL, PLANAR
+    };
+
+    enum Lengths {
+        STRAIGHT, /**< straight length times a detour drawn between 1 and first */
+        UNIFORM, /**< drawn between first and second */
+        EXPONENTIAL /**< first plus an exponential with mean second */
+    };
+
+    /** @struct Settings
+     *  @brief what kind of map to make
+     */
+    struct Settings {
+        Layout layout = GRID;
+        int intersections = 10000; /**< the map has about this many, the layouts round it to whole rows or rings */
+        float blockLength = 50; /**< straight distance between neighboring intersections of the grid, or between two rings */
+        int hospitalsPerThousand = 2;
+        Lengths lengths = STRAIGHT;
+        float first = 1.5f; /**< first parameter of the lengths */
+        float second = 0; /**< second parameter of the lengths */
+        float keptRoads = 0.6f; /**< PLANAR only, the share of the roads outside the spanning tree that are kept */
+        unsigned seed = 42;
+    };
+
+    /** @struct Road
+     *  @brief a road of the map, the one back is implied
+     */
+    struct Road {
+        int from;
+        int to;
+        float length;
+        traffictrack::Direction direction; /**< from the first intersection to the second */
+    };
+
+protected:
+    Settings settings_;
+    std::vector<std::pair<float, float>> positions_;
+    std::vector<Road> roads_;
+    std::vector<int> hospitals_;
+    std::mt19937 random_;
+
+    void addRoad(int from, int to, traffictrack::Direction direction);
+    void writeSections(std::ostream& out) const;
+
+public:
+    MapGenerator(const Settings& settings);
+    virtual ~MapGenerator();
+    static bool parseLayout(const std::string& name, Layout& layout);
+    static bool parseLengths(const std::string& description, Settings& settings);
+    void generate();
+    int size() const;
+    int roads() const;
+    const std::vector<int>& hospitals() const;
+    bool writeQuick(const std::string& filename) const;
+    bool writeExplicit(const std::string& filename) const;
+
+};
+
+#endif /* MapGenerator_hpp */
@@ -0,0 +1,266 @@
+//
+//  MpscRingQueue.hpp
+//  TraffikTrak
+//
+//  Created by Matt Lovick on 2026-10-19.
+//  Copyright © 2026 Matt Lovick. All rights reserved.
+//
+
+#ifndef MpscRingQueue_hpp
+#define MpscRingQueue_hpp
+
+#include <atomic>
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+
+
+/** @struct MpscQueueCounters
+ *  @brief totals since an MpscRingQueue was created, shared by every element type
+ */
+struct MpscQueueCounters {
+    long long enqueued; /**< items accepted */
+    long long dequeued;
+    long long dropped; /**< items rejected because the ring was full */
+};
+
+
+/** @class MpscRingQueue
+ *  @brief bounded lock-free queue with many producers and a single consumer
+ *
+ *  producers claim a slot with a compare-and-swap on the enqueue position and publish it through the slot's sequence
+ *  number (a bounded ring in the style of Dmitry Vyukov's queue), so a producer never waits for the consumer or for
+ *  another producer that is holding a lock. when the ring is full the new item is rejected and counted, so the queue
+ *  never grows and items come out in the order they were claimed. the two positions are kept on separate cache lines
+ *  with padding rather than alignas, so a class holding the queue can still be allocated with plain new.
+ *  only one thread may call the consumer methods (tryPop, popBatch, empty)
+ *  @author Matthew Lovick
+ */
+template <typename T>
+class MpscRingQueue {
+
+public:
+    typedef MpscQueueCounters Counters;
+
+protected:
+    static const size_t CACHE_LINE = 64;
+
+    struct Slot {
+        std::atomic<size_t> sequence;
+        T value;
+    };
+
+    const size_t capacity_;
+    const size_t mask_;
+    Slot* slots_;
+    char padding0_[CACHE_LINE];
+    std::atomic<size_t> enqueuePosition_; /**< shared by the producers */
+    char padding1_[CACHE_LINE];
+    size_t dequeuePosition_; /**< only used by the consumer */
+    char padding2_[CACHE_LINE];
+    std::atomic<long long> enqueued_;
+    std::atomic<long long> dequeued_;
+    std::atomic<long long> dropped_;
+
+    static size_t roundUpToPowerOfTwo(size_t value);
+    bool tryPushRing(T& value);
+    bool tryPopRing(T& value);
+
+public:
+    MpscRingQueue(size_t capacity);
+    virtual ~MpscRingQueue();
+    bool push(T value);
+    bool tryPop(T& value);
+    size_t popBatch(std::vector<T>& out, size_t max);
+    bool empty() const;
+    size_t capacity() const;
+    Counters counters() const;
+
+};
+
+
+/**
+ *  \brief smallest power of two that is at least value (and at least 2)
+ */
+template <typename T>
+size_t MpscRingQueue<T>::roundUpToPowerOfTwo(size_t value) {
+
+    size_t power = 2;
+    while (power < value) {
+        power <<= 1;
+    }
+    return power;
+
+}
+
+
+/**
+ *  \brief claims the next free slot and publishes the value in it
+ *  \return false if the ring is full
+ */
+template <typename T>
+bool MpscRingQueue<T>::tryPushRing(T& value) {
+
+    size_t position = enqueuePosition_.load(std::memory_order_relaxed);
+
+    while (true) {
+
+        Slot& slot = slots_[position & mask_];
+        size_t sequence = slot.sequence.load(std::memory_order_acquire);
+        intptr_t difference = static_cast<intptr_t>(sequence) - static_cast<intptr_t>(position);
+
+        if (difference == 0) {
+            //the slot is free for this lap, try to claim it
+            if (enqueuePosition_.compare_exchange_weak(position, position + 1, std::memory_order_relaxed)) {
+                slot.value = std::move(value);
+                slot.sequence.store(position + 1, std::memory_order_release);
+                return true;
+            }
+        }
+        else if (difference < 0) {
+            //the consumer has not freed the slot from the previous lap yet
+            return false;
+        }
+        else {
+            //another producer claimed the slot first
+            position = enqueuePosition_.load(std::memory_order_relaxed);
+        }
+
+    }
+
+}
+
+
+/**
+ *  \brief takes the value at the head of the ring, if it has been published
+ */
+template <typename T>
+bool MpscRingQueue<T>::tryPopRing(T& value) {
+
+    Slot& slot = slots_[dequeuePosition_ & mask_];
+    size_t sequence = slot.sequence.load(std::memory_order_acquire);
+
+    if (static_cast<intptr_t>(sequence) - static_cast<intptr_t>(dequeuePosition_ + 1) < 0) {
+        return false;
+    }
+
+    value = std::move(slot.value);
+    slot.sequence.store(dequeuePosition_ + capacity_, std::memory_order_release);
+    dequeuePosition_++;
+    return true;
+
+}
+
+
+/**
+ *  \brief constructor allocates the ring, the capacity is rounded up to a power of two
+ */
+template <typename T>
+MpscRingQueue<T>::MpscRingQueue(size_t capacity) : capacity_(roundUpToPowerOfTwo(capacity)), mask_(roundUpToPowerOfTwo(capacity) - 1), enqueuePosition_(0), dequeuePosition_(0), enqueued_(0), dequeued_(0), dropped_(0) {
+
+    slots_ = new Slot[capacity_];
+    for (size_t i = 0; i < capacity_; i++) {
+        slots_[i].sequence.store(i, std::memory_order_relaxed);
+    }
+
+}
+
+
+/**
+ *  \brief destructor frees the ring
+ */
+template <typename T>
+MpscRingQueue<T>::~MpscRingQueue() {
+    delete [] slots_;
+}
+
+
+/**
+ *  \brief adds an item without ever waiting for the consumer
+ *  \return false if the ring was full and the item was dropped
+ */
+template <typename T>
+bool MpscRingQueue<T>::push(T value) {
+
+    if (tryPushRing(value)) {
+        enqueued_.fetch_add(1, std::memory_order_relaxed);
+        return true;
+    }
+
+    dropped_.fetch_add(1, std::memory_order_relaxed);
+    return false;
+
+}
+
+
+/**
+ *  \brief consumer only: takes the oldest item
+ */
+template <typename T>
+bool MpscRingQueue<T>::tryPop(T& value) {
+
+    if (!tryPopRing(value)) {
+        return false;
+    }
+    dequeued_.fetch_add(1, std::memory_order_relaxed);
+    return true;
+
+}
+
+
+/**
+ *  \brief consumer only: appends up to max items to out
+ *  \return the number of items taken
+ */
+template <typename T>
+size_t MpscRingQueue<T>::popBatch(std::vector<T>& out, size_t max) {
+
+    size_t count = 0;
+    T value;
+    while (count < max && tryPop(value)) {
+        out.push_back(std::move(value));
+        count++;
+    }
+    return count;
+
+}
+
+
+/**
+ *  \brief consumer only: whether there is nothing left to pop. producers may add items right after this returns
+ */
+template <typename T>
+bool MpscRingQueue<T>::empty() const {
+
+    const Slot& slot = slots_[dequeuePosition_ & mask_];
+    size_t sequence = slot.sequence.load(std::memory_order_acquire);
+    return static_cast<intptr_t>(sequence) - static_cast<intptr_t>(dequeuePosition_ + 1) < 0;
+
+}
+
+
+/**
+ *  \brief getter for the number of slots in the ring
+ */
+template <typename T>
+size_t MpscRingQueue<T>::capacity() const {
+    return capacity_;
+}
+
+
+/**
+ *  \brief snapshot of the counters
+ */
+template <typename T>
+typename MpscRingQueue<T>::Counters MpscRingQueue<T>::counters() const {
+
+    Counters c;
+    c.enqueued = enqueued_.load(std::memory_order_relaxed);
+    c.dequeued = dequeued_.load(std::memory_order_relaxed);
+    c.dropped = dropped_.load(std::memory_order_relaxed);
+    return c;
+
+}
+
+#endif /* MpscRingQueue_hpp */
@@ -0,0 +1,51 @@
+//
+//  NodeHeap.cpp
+//  TraffikTrak
+//
+//  Created by Matt Lovick on 2026-10-19.
+//  Copyright © 2026 Matt Lovick. All rights reserved.
+//
+
+#include <vector>
+#include <utility>
+#include "NodeHeap.hpp"
+
+using namespace std;
+
+
+/** @fn NodeHeap()
+ *  @brief constructor for a heap of no intersections, resize() before use
+ */
+NodeHeap::NodeHeap() { }
+
+
+/** @fn ~NodeHeap()
+ *  @brief destructor that does nothing
+ */
+NodeHeap::~NodeHeap() { }
+
+
+/** @fn resize(int nodes)
+ *  @brief empties the heap and makes room for intersections 0 to nodes-1
+ *  @param nodes the number of intersections
+ */
+void NodeHeap::resize(int nodes) {
+
+    entries_.clear();
+    entries_.reserve(nodes);
+    position_.assign(nodes, -1);
+
+}
+
+
+/** @fn clear()
+ *  @brief empties the heap, in time proportional to the entries left in it
+ */
+void NodeHeap::clear() {
+
+    for (const pair<float, int>& entry : entries_) {
+        position_[entry.second] = -1;
+    }
+    entries_.clear();
+
+}
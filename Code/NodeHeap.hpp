@@ -0,0 +1,159 @@
+//
+//  NodeHeap.hpp
+//  TraffikTrak
+//
+//  Created by Matt Lovick on 2026-10-19.
+//  Copyright © 2026 Matt Lovick. All rights reserved.
+//
+
+#ifndef NodeHeap_hpp
+#define NodeHeap_hpp
+
+#include <vector>
+#include <utility>
+#include <cstddef>
+
+
+/** @class NodeHeap
+ *  @brief 4-ary min heap of intersection numbers (RoadGraph) ordered by a float key, that can lower the key of an
+ *      intersection already in it
+ *
+ *  every intersection is in the heap at most once, so a search never pops an entry that was overtaken by a shorter path.
+ *  a node has four children instead of two, which halves the depth and keeps the children of a node in one cache line.
+ *  the arrays are sized once with resize() and kept, so pushing and popping never allocates
+ *  @author Matthew Lovick
+ */
+class NodeHeap {
+
+protected:
+    std::vector<std::pair<float, int>> entries_; /**< the heap, key and intersection */
+    std::vector<int> position_; /**< where each intersection is in entries_, -1 if it is not in the heap */
+
+    void siftUp(int index);
+    void siftDown(int index);
+
+public:
+    NodeHeap();
+    virtual ~NodeHeap();
+    void resize(int nodes);
+    void clear();
+    bool empty() const { return entries_.empty(); }
+    int size() const { return static_cast<int>(entries_.size()); }
+    bool contains(int node) const { return position_[node] >= 0; }
+    int top() const { return entries_.front().second; }
+    float topKey() const { return entries_.front().first; }
+    void push(int node, float key);
+    int pop();
+    size_t memory() const { return entries_.capacity()*sizeof(std::pair<float, int>) + position_.capacity()*sizeof(int); }
+
+};
+
+
+/**
+ *  \brief adds an intersection, or lowers its key if it is already in the heap with a higher one
+ */
+inline void NodeHeap::push(int node, float key) {
+
+    int index = position_[node];
+
+    if (index < 0) {
+        index = static_cast<int>(entries_.size());
+        entries_.push_back(std::make_pair(key, node));
+        position_[node] = index;
+    }
+    else if (key < entries_[index].first) {
+        entries_[index].first = key;
+    }
+    else {
+        return;
+    }
+
+    siftUp(index);
+
+}
+
+
+/**
+ *  \brief removes the intersection with the lowest key and returns it
+ */
+inline int NodeHeap::pop() {
+
+    const int node = entries_.front().second;
+    position_[node] = -1;
+
+    std::pair<float, int> last = entries_.back();
+    entries_.pop_back();
+
+    if (!entries_.empty()) {
+        entries_.front() = last;
+        position_[last.second] = 0;
+        siftDown(0);
+    }
+
+    return node;
+
+}
+
+
+/**
+ *  \brief moves an entry towards the root until its parent's key is not higher
+ */
+inline void NodeHeap::siftUp(int index) {
+
+    const std::pair<float, int> moving = entries_[index];
+
+    while (index > 0) {
+        int parent = (index - 1) / 4;
+        if (!(moving.first < entries_[parent].first)) {
+            break;
+        }
+        entries_[index] = entries_[parent];
+        position_[entries_[index].second] = index;
+        index = parent;
+    }
+
+    entries_[index] = moving;
+    position_[moving.second] = index;
+
+}
+
+
+/**
+ *  \brief moves an entry away from the root until none of its children has a lower key
+ */
+inline void NodeHeap::siftDown(int index) {
+
+    const std::pair<float, int> moving = entries_[index];
+    const int size = static_cast<int>(entries_.size());
+
+    while (true) {
+
+        int first = 4*index + 1;
+        if (first >= size) {
+            break;
+        }
+
+        int smallest = first;
+        int last = first + 4 < size ? first + 4 : size;
+        for (int child = first + 1; child < last; child++) {
+            if (entries_[child].first < entries_[smallest].first) {
+                smallest = child;
+            }
+        }
+
+        if (!(entries_[smallest].first < moving.first)) {
+            break;
+        }
+
+        entries_[index] = entries_[smallest];
+        position_[entries_[index].second] = index;
+        index = smallest;
+
+    }
+
+    entries_[index] = moving;
+    position_[moving.second] = index;
+
+}
+
+#endif /* NodeHeap_hpp */
@@ -6,7 +6,6 @@
 //  Copyright © 2020 Matt Lovick. All rights reserved.
 //
 
-#include <thread>
 #include <mutex>
 #include "NorthSouthState.hpp"
 #include "Intersection.hpp"
@@ -20,33 +19,33 @@
 NorthSouthState::~NorthSouthState() { }
 
 
-/** @fn changeLights(Intersection* intersection)
- *  @brief changes the state of the intersection by changing the interval time and changing the lights
+/** @fn beginChange(Intersection* intersection)
+ *  @brief turns the north/south lights yellow without waiting
  *  @param intersection the intersection that owns this state object
  */
-void NorthSouthState::changeLights(Intersection* intersection) {
-    
-    std::thread* northLight;
-    std::thread* southLight;
+void NorthSouthState::beginChange(Intersection* intersection) {
     
     std::lock_guard<std::mutex> lightsGuard(intersection->lightsMutex_);
-    //change the green lights to red
-    //since they turn yellow first and wait for a few seconds, use threads to do this in parallel
-    northLight = new std::thread(&TrafficLight::changeLight, intersection->lights_[0]);
-    southLight = new std::thread(&TrafficLight::changeLight, intersection->lights_[2]);
-    
-    northLight->join();
-    southLight->join();
+    intersection->lights_[0]->beginChange();
+    intersection->lights_[2]->beginChange();
     
-    delete northLight;
-    delete southLight;
+}
+
 
-    //now that the other lights are red, make the east/west lights green
+/** @fn finishChange(Intersection* intersection)
+ *  @brief turns the yellow north/south lights red and the east/west lights green, once the lights have been yellow long enough
+ *  @param intersection the intersection that owns this state object
+ */
+void NorthSouthState::finishChange(Intersection* intersection) {
+    
+    std::lock_guard<std::mutex> lightsGuard(intersection->lightsMutex_);
+    intersection->lights_[0]->finishChange();
+    intersection->lights_[2]->finishChange();
     intersection->lights_[1]->changeLight();
     intersection->lights_[3]->changeLight();
     
     std::lock_guard<std::mutex> nextStateGuard(intersection->nextStateMutex_);
-    intersection->nextState_ = new EastWestState(intersection->eastWestIntervalTime_);
+    intersection->nextState_ = new EastWestState(intersection->currentIntervals().second);
     
 }
 
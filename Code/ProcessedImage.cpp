@@ -1,22 +1,14 @@
 
 #include "ProcessedImage.hpp"
+#include <ctime>
+#include <future>
+#include "InferencePool.hpp"
 
 using namespace cv;
 using namespace dnn;
 using namespace std;
 using namespace traffictrack;
 
-vector<yolo_obj> northResult;
-vector<yolo_obj> southResult;
-vector<yolo_obj> eastResult;
-vector<yolo_obj> westResult;
-//vector<vector<yolo_obj>> results;
-Mat img1;
-Mat img2;
-Mat img3;
-Mat img4;
-String priority;
-
 
 /**
 * @fn ProcessedImage()
@@ -25,80 +17,86 @@ String priority;
 * @param simage - image file name for the south traffic light
 * @param eimage - image file name for the east traffic light
 * @param wimage - image file name for the west traffic light
+* The approaches are processed on the InferencePool, so this must not be called from one of its workers
 * @returns void - nothing 
 */
-ProcessedImage::ProcessedImage(String northImage, String southImage, String eastImage, String westImage){
-    yolo new_yolo = yolo("yolov3.weights","coco.names","yolov3.cfg",416,416, 0.30);
-    img1 = imread(northImage);
-    northResult = new_yolo.processImage(img1);
-    img2 = imread(southImage);
-    southResult = new_yolo.processImage(img2);
-    img3 = imread(eastImage);
-    eastResult = new_yolo.processImage(img3);
-    img4 = imread(westImage);
-    westResult = new_yolo.processImage(img4);
-
+ProcessedImage::ProcessedImage(String northImage, String southImage, String eastImage, String westImage)
+    : ProcessedImage(northImage, southImage, eastImage, westImage, vector<FrameQualityGate*>(4, nullptr)){
 }
 
-/** @fn carCount()
-*  @brief counts the number of cars turning left, right, or going straight 
-*  
-* This function uses the yolov3 models to count the cars in the left turning lanes, right turning lanes, 
-* and the through lanes. It creates a congestionScore object to store this information and then 
-* returns the object alongside the time as a DateScorePair.
-* @return - returns a DateScorePair that stores the time and congestionScore
+/**
+* @fn ProcessedImage()
+* @brief constructor that checks every frame with its camera's quality gate before running it through yolo
+* @param nimage - image file name for the north traffic light
+* @param simage - image file name for the south traffic light
+* @param eimage - image file name for the east traffic light
+* @param wimage - image file name for the west traffic light
+* @param gates - the quality gates of the north, south, east and west cameras, in that order (nullptr skips the check)
+* The approaches are processed on the InferencePool, so this must not be called from one of its workers
+* @returns void - nothing 
 */
-DateScorePair ProcessedImage::carCount(){
-     CongestionScore congestion;
-    //north
-    static int count[3] = {0,0,0};
-   
-    for(int i = 0; i < northResult.size(); i++){
-        if(northResult[i].classID == "car" || northResult[i].classID == "bus" || northResult[i].classID == "truck" || northResult[i].classID == "motorbike"){
-            if(northResult[i].boundingBox.y <= 333){
-                count[0] = count[0]+1;
-            }
-            else if(northResult[i].boundingBox.y <=1000){
-                count[1] = count[1]+1;
-            }
-            else{
-                count[2] = count[2]+1;
-            }
-        }
-    }
-    congestion.setNorth(count[0],count[1],count[2]);
-
-
-    count[0]=0;
-    count[1]=0;
-    count[2]=0;
-    for(int i = 0; i < southResult.size(); i++){
-        if(northResult[i].classID == "car"|| northResult[i].classID == "bus" || northResult[i].classID == "truck" ){
-            if(southResult[i].boundingBox.y <= 333){
-                count[0] = count[0]+1;
-            }
-            else if(southResult[i].boundingBox.y <=000){
-                count[1] = count[1]+1;
-            }
-            else{
-                count[2] = count[2]+1;
-            }
-        }
-    }
-    congestion.setSouth(count[0],count[1],count[2]);
+ProcessedImage::ProcessedImage(String northImage, String southImage, String eastImage, String westImage, const vector<FrameQualityGate*>& gates){
+    //the four approaches are read and run through the network in parallel on the shared pool
+    //each one comes back through its own future, so the results need no locking
+    InferencePool* pool = InferencePool::instance();
+    future<timed_detection> north = pool->detectTimed(northImage, gates.at(0));
+    future<timed_detection> south = pool->detectTimed(southImage, gates.at(1));
+    future<timed_detection> east = pool->detectTimed(eastImage, gates.at(2));
+    future<timed_detection> west = pool->detectTimed(westImage, gates.at(3));
+
+    timed_detection detection = north.get();
+    northResult = detection.objects;
+    northQuality = detection.quality;
+
+    detection = south.get();
+    southResult = detection.objects;
+    southQuality = detection.quality;
+
+    detection = east.get();
+    eastResult = detection.objects;
+    eastQuality = detection.quality;
+
+    detection = west.get();
+    westResult = detection.objects;
+    westQuality = detection.quality;
 
+}
 
+/**
+* @fn ProcessedImage()
+* @brief constructor for photos that were already run through the InferencePool, used when the results arrive through callbacks
+* @param detections - the results for the north, south, east and west traffic lights, in that order
+* @returns void - nothing 
+*/
+ProcessedImage::ProcessedImage(const vector<timed_detection>& detections){
+    northResult = detections.at(0).objects;
+    northQuality = detections.at(0).quality;
+    southResult = detections.at(1).objects;
+    southQuality = detections.at(1).quality;
+    eastResult = detections.at(2).objects;
+    eastQuality = detections.at(2).quality;
+    westResult = detections.at(3).objects;
+    westQuality = detections.at(3).quality;
+}
 
+/** @fn countLanes()
+*  @brief counts the vehicles in the left turning lane, the through lanes and the right turning lane of one image
+*
+* The image is split by the y position of each bounding box into 3 parts [left lane, straight lane, right lane]
+* and every car, bus, truck or motorbike is counted in the part it falls in.
+* @param objects - the objects identified in the image by yolo
+* @return - returns a vector with the number of vehicles in the left lane in index 0, straight lanes in index 1
+* and right lane in index 2
+*/
+vector<int> ProcessedImage::countLanes(const vector<yolo_obj>& objects){
+    vector<int> count = {0,0,0};
 
-    count[0]=0;
-    count[1]=0;
-    count[2]=0;
-    for(int i = 0; i < eastResult.size(); i++){
-        if(northResult[i].classID == "car" || northResult[i].classID == "bus" || northResult[i].classID == "truck"){
-            if(eastResult[i].boundingBox.y <= 333){
+    for(int i = 0; i < objects.size(); i++){
+        if(objects[i].classID == "car" || objects[i].classID == "bus" || objects[i].classID == "truck" || objects[i].classID == "motorbike"){
+            if(objects[i].boundingBox.y <= 333){
                 count[0] = count[0]+1;
             }
-            else if(eastResult[i].boundingBox.y <=1000){
+            else if(objects[i].boundingBox.y <=1000){
                 count[1] = count[1]+1;
             }
             else{
@@ -106,38 +104,70 @@ DateScorePair ProcessedImage::carCount(){
             }
         }
     }
-    congestion.setEast(count[0],count[1],count[2]);
-
+    return count;
+}
 
+/** @fn carCount()
+*  @brief counts the number of cars turning left, right, or going straight 
+*  
+* This function uses the yolov3 models to count the cars in the left turning lanes, right turning lanes, 
+* and the through lanes. It creates a congestionScore object to store this information and then 
+* returns the object alongside the time as a DateScorePair.
+* Approaches whose frame was skipped by the quality gate are counted as 0.
+* @return - returns a DateScorePair that stores the time and congestionScore
+*/
+DateScorePair ProcessedImage::carCount() const{
+    CongestionScore empty;
+    empty.setNorth(0,0,0);
+    empty.setSouth(0,0,0);
+    empty.setEast(0,0,0);
+    empty.setWest(0,0,0);
+    return carCount(empty);
+}
 
+/** @fn carCount(const CongestionScore& fallback)
+*  @brief counts the number of cars turning left, right, or going straight, using the fallback for skipped approaches
+*
+* Same as carCount(), except an approach whose frame was skipped by the quality gate takes its lane counts from the
+* fallback, normally the last good score of the intersection.
+* @param fallback - the score to use for approaches without a usable frame
+* @return - returns a DateScorePair that stores the time and congestionScore
+*/
+DateScorePair ProcessedImage::carCount(const CongestionScore& fallback) const{
+    CongestionScore congestion;
 
-    count[0]=0;
-    count[1]=0;
-    count[2]=0;
-    for(int i = 0; i < westResult.size(); i++){
-        if(northResult[i].classID == "car" || northResult[i].classID == "bus" || northResult[i].classID == "truck"){
-            if(westResult[i].boundingBox.y <=333){
-                count[0] = count[0]+1;
-            }
-            else if(westResult[i].boundingBox.y <= 1000){
-                count[1] = count[1]+1;
-            }
-            else{
-                count[2] = count[2]+1;
-            }
-        }
-    }
-    congestion.setWest(count[0],count[1],count[2]);
+    vector<int> count = northQuality == FrameQuality::GOOD ? countLanes(northResult) : fallback.getNorth();
+    congestion.setNorth(count.at(0),count.at(1),count.at(2));
 
-DateScorePair databaseResult;
-time_t now = std::time(NULL);
-string time = std::ctime(&now);
-databaseResult.first = time;
-databaseResult.second = congestion;
-return databaseResult;
+    count = southQuality == FrameQuality::GOOD ? countLanes(southResult) : fallback.getSouth();
+    congestion.setSouth(count.at(0),count.at(1),count.at(2));
 
+    count = eastQuality == FrameQuality::GOOD ? countLanes(eastResult) : fallback.getEast();
+    congestion.setEast(count.at(0),count.at(1),count.at(2));
 
-}
+    count = westQuality == FrameQuality::GOOD ? countLanes(westResult) : fallback.getWest();
+    congestion.setWest(count.at(0),count.at(1),count.at(2));
 
+    //ctime_r instead of ctime, which returns a pointer to a buffer shared by every thread
+    DateScorePair databaseResult;
+    time_t now = std::time(NULL);
+    char buffer[26];
+    string time = ctime_r(&now, buffer);
+    databaseResult.first = time;
+    databaseResult.second = congestion;
+    return databaseResult;
 
+}
 
+/** @fn skippedApproaches()
+*  @brief the number of approaches whose frame was not run through yolo because it failed the quality check
+*  @return - between 0 and 4
+*/
+int ProcessedImage::skippedApproaches() const{
+    int skipped = 0;
+    skipped += northQuality == FrameQuality::GOOD ? 0 : 1;
+    skipped += southQuality == FrameQuality::GOOD ? 0 : 1;
+    skipped += eastQuality == FrameQuality::GOOD ? 0 : 1;
+    skipped += westQuality == FrameQuality::GOOD ? 0 : 1;
+    return skipped;
+}
@@ -8,6 +8,10 @@
 #include <sstream>
 
 #include "DateScorePair.hpp"
+#include "FrameQuality.h"
+#include "InferencePool.hpp"
+
+class FrameQualityGate;
 
 
 
@@ -24,18 +28,36 @@ using namespace traffictrack;
      * Receives 4 images [north, south, east, west] through the constructor and uses the carCount function
      * to identify all objects in the photos and split the image into 3 parts [left lane, straight lane, right lane] 
      * and count the number of cars in each lane. 
+     * When each camera's FrameQualityGate is given, frames that fail the check are not run through yolo,
+     * and carCount(fallback) uses the fallback score for those approaches instead.
      * @author Harkirat Bassi & Maanasa Pillai
      */
 class ProcessedImage{
     private:
-        vector<yolo_obj> result;
-        Mat img;
+        vector<yolo_obj> northResult;
+        vector<yolo_obj> southResult;
+        vector<yolo_obj> eastResult;
+        vector<yolo_obj> westResult;
+        FrameQuality northQuality;
+        FrameQuality southQuality;
+        FrameQuality eastQuality;
+        FrameQuality westQuality;
     public:
 
         ProcessedImage(String nimage, String simage, String eimage, String wimage);
 
+        ProcessedImage(String nimage, String simage, String eimage, String wimage, const vector<FrameQualityGate*>& gates);
+
+        ProcessedImage(const vector<timed_detection>& detections);
+
+
+        DateScorePair carCount() const;
+
+        DateScorePair carCount(const CongestionScore& fallback) const;
+
+        int skippedApproaches() const;
 
-        DateScorePair carCount();
+        static vector<int> countLanes(const vector<yolo_obj>& objects);
 };
 
 #endif
\ No newline at end of file
@@ -1,8 +1,10 @@
 #include "RandomPhotoTaker.hpp"
 #include <time.h>
+#include <mutex>
 
 
-vector<String> fn;
+//rand() is not guaranteed to be thread safe, and every traffic light calls takePhoto from its intersection's thread
+static std::mutex randMutex;
 
 /**
 * @fn takePhoto()
@@ -15,7 +17,11 @@ vector<String> fn;
 
 String RandomPhotoTaker::takePhoto(){
     glob("./photos/*.jpg", fn, false);
-    int randNum = rand() % fn.size();
+    int randNum;
+    {
+        std::lock_guard<std::mutex> guard(randMutex);
+        randNum = rand() % fn.size();
+    }
     return fn.at(randNum);
 
 
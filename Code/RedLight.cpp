@@ -32,3 +32,19 @@ void RedLight::changeLight(TrafficLight* light) {
     light->nextState_ = new GreenLight();
     
 }
+
+
+/** @fn beginChange(TrafficLight* light)
+ *  @brief does nothing, a red light turns green in one step
+ *  @param light the traffic light whose state this is
+ */
+void RedLight::beginChange(TrafficLight* /* light */) { }
+
+
+/** @fn finishChange(TrafficLight* light)
+ *  @brief same as changeLight(), turns the light green
+ *  @param light the traffic light whose state this is, whose state needs to be changed
+ */
+void RedLight::finishChange(TrafficLight* light) {
+    changeLight(light);
+}
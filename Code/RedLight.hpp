@@ -22,6 +22,8 @@ class RedLight : public AbstractTrafficLightState {
 public:
     virtual ~RedLight();
     virtual void changeLight(TrafficLight* light);
+    virtual void beginChange(TrafficLight* light);
+    virtual void finishChange(TrafficLight* light);
 };
 
 #endif /* RedLight_hpp */
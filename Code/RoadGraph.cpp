@@ -0,0 +1,173 @@
+//
+//  RoadGraph.cpp
+//  TraffikTrak
+//
+//  Created by Matt Lovick on 2026-10-19.
+//  Copyright © 2026 Matt Lovick. All rights reserved.
+//
+
+#include <vector>
+#include <unordered_map>
+#include <algorithm>
+#include "RoadGraph.hpp"
+#include "Intersection.hpp"
+#include "IntersectionID.h"
+#include "Road.hpp"
+
+using namespace std;
+using namespace traffictrack;
+
+
+/** @fn RoadGraph()
+ *  @brief constructor for an empty graph, it is never current()
+ */
+RoadGraph::RoadGraph() : offsets_(1, 0), version_(~0ULL) { }
+
+
+/** @fn RoadGraph(const std::unordered_map<traffictrack::IntersectionID, Intersection*>& intersections)
+ *  @brief takes a snapshot of the map. roads to intersections that are not in the map are left out
+ *  @param intersections the map
+ */
+RoadGraph::RoadGraph(const std::unordered_map<traffictrack::IntersectionID, Intersection*>& intersections) {
+
+    //read the version first, a change made while copying makes the snapshot out of date right away
+    version_ = Intersection::mapVersion();
+
+    nodes_.reserve(intersections.size());
+    for (auto it = intersections.begin(); it != intersections.end(); ++it) {
+        nodes_.push_back(it->second);
+    }
+    sort(nodes_.begin(), nodes_.end(), [](Intersection* a, Intersection* b) { return a->ID() < b->ID(); });
+
+    const int size = static_cast<int>(nodes_.size());
+    index_.reserve(size);
+    hospitals_.resize(size);
+    for (int i = 0; i < size; i++) {
+        index_[nodes_[i]] = i;
+        hospitals_[i] = nodes_[i]->hospital();
+    }
+
+    offsets_.reserve(size + 1);
+    for (int i = 0; i < size; i++) {
+
+        offsets_.push_back(static_cast<int>(targets_.size()));
+
+        for (const Road& r : nodes_[i]->neighbors()) {
+            auto target = index_.find(r.secondIntersection());
+            if (target != index_.end()) {
+                targets_.push_back(target->second);
+                lengths_.push_back(r.distance());
+                directions_.push_back(r.direction());
+            }
+        }
+
+    }
+    offsets_.push_back(static_cast<int>(targets_.size()));
+
+}
+
+
+/** @fn ~RoadGraph()
+ *  @brief destructor that does nothing
+ */
+RoadGraph::~RoadGraph() { }
+
+
+/** @fn reversed() const
+ *  @brief the same graph with every road turned around, the roads "leaving" an intersection are then the roads arriving at it.
+ *      the intersections keep their numbers and the roads keep their direction of travel, original() gives the number a
+ *      road has in this graph
+ *  @return RoadGraph
+ */
+RoadGraph RoadGraph::reversed() const {
+
+    RoadGraph graph;
+    graph.nodes_ = nodes_;
+    graph.index_ = index_;
+    graph.hospitals_ = hospitals_;
+    graph.version_ = version_;
+
+    const int size = this->size();
+    const int roads = this->roads();
+
+    //count the roads arriving at each intersection, then place every road in the slot of its target
+    graph.offsets_.assign(size + 1, 0);
+    for (int road = 0; road < roads; road++) {
+        graph.offsets_[targets_[road] + 1]++;
+    }
+    for (int i = 0; i < size; i++) {
+        graph.offsets_[i + 1] += graph.offsets_[i];
+    }
+
+    graph.targets_.resize(roads);
+    graph.lengths_.resize(roads);
+    graph.directions_.resize(roads);
+    graph.originals_.resize(roads);
+    vector<int> next(graph.offsets_.begin(), graph.offsets_.end() - 1);
+
+    for (int from = 0; from < size; from++) {
+        for (int road = offsets_[from]; road < offsets_[from + 1]; road++) {
+            int slot = next[targets_[road]]++;
+            graph.targets_[slot] = from;
+            graph.lengths_[slot] = lengths_[road];
+            graph.directions_[slot] = directions_[road];
+            graph.originals_[slot] = road;
+        }
+    }
+
+    return graph;
+
+}
+
+
+/** @fn current() const
+ *  @brief whether the map is still the way it was when the snapshot was taken
+ *  @return bool
+ */
+bool RoadGraph::current() const {
+    return version_ == Intersection::mapVersion();
+}
+
+
+/** @fn size() const
+ *  @brief the number of intersections
+ *  @return int
+ */
+int RoadGraph::size() const {
+    return static_cast<int>(nodes_.size());
+}
+
+
+/** @fn roads() const
+ *  @brief the number of roads
+ *  @return int
+ */
+int RoadGraph::roads() const {
+    return static_cast<int>(targets_.size());
+}
+
+
+/** @fn index(Intersection* intersection) const
+ *  @brief the number of an intersection in the graph
+ *  @param intersection the intersection
+ *  @return int its number, -1 if it is not in the graph
+ */
+int RoadGraph::index(Intersection* intersection) const {
+
+    auto it = index_.find(intersection);
+    return it != index_.end() ? it->second : -1;
+
+}
+
+
+/** @fn memory() const
+ *  @brief roughly how many bytes the snapshot takes, the index from intersection to number included
+ *  @return size_t
+ */
+size_t RoadGraph::memory() const {
+
+    return nodes_.capacity()*sizeof(Intersection*) + offsets_.capacity()*sizeof(int) + targets_.capacity()*sizeof(int)
+        + lengths_.capacity()*sizeof(float) + directions_.capacity()*sizeof(Direction) + hospitals_.capacity() + originals_.capacity()*sizeof(int)
+        + index_.size()*(sizeof(Intersection*) + sizeof(int) + 2*sizeof(void*)) + index_.bucket_count()*sizeof(void*);
+
+}
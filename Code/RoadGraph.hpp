@@ -0,0 +1,63 @@
+//
+//  RoadGraph.hpp
+//  TraffikTrak
+//
+//  Created by Matt Lovick on 2026-10-19.
+//  Copyright © 2026 Matt Lovick. All rights reserved.
+//
+
+#ifndef RoadGraph_hpp
+#define RoadGraph_hpp
+
+#include <vector>
+#include <unordered_map>
+#include <cstddef>
+#include "Intersection.hpp"
+#include "IntersectionID.h"
+#include "Direction.h"
+
+/** @class RoadGraph
+ *  @brief compact snapshot of the map for the path finders, in compressed sparse row form
+ *
+ *  the intersections are numbered 0 to size()-1 in the order of their IDs. the roads leaving intersection i are the roads
+ *  firstRoad(i) to endRoad(i)-1, and the target, length and direction of each road are kept in arrays of their own, so a
+ *  search walks through contiguous memory instead of following the nodes of every intersection's std::set<Road>. per-search
+ *  state can then be a flat array indexed by the intersection's number. the snapshot does not change, build a new one once
+ *  current() returns false
+ *  @author Matthew Lovick
+ */
+class RoadGraph {
+
+protected:
+    std::vector<Intersection*> nodes_;
+    std::unordered_map<Intersection*, int> index_;
+    std::vector<int> offsets_; /**< size()+1 entries, the roads leaving intersection i start at offsets_[i] */
+    std::vector<int> targets_;
+    std::vector<float> lengths_;
+    std::vector<traffictrack::Direction> directions_;
+    std::vector<char> hospitals_;
+    std::vector<int> originals_; /**< only for a reversed() graph, the number of each road in the graph it was reversed from */
+    unsigned long long version_; /**< Intersection::mapVersion() when the snapshot was taken */
+
+public:
+    RoadGraph();
+    RoadGraph(const std::unordered_map<traffictrack::IntersectionID, Intersection*>& intersections);
+    virtual ~RoadGraph();
+    RoadGraph reversed() const;
+    bool current() const;
+    int size() const;
+    int roads() const;
+    int index(Intersection* intersection) const;
+    size_t memory() const;
+    Intersection* intersection(int node) const { return nodes_[node]; }
+    bool hospital(int node) const { return hospitals_[node] != 0; }
+    int firstRoad(int node) const { return offsets_[node]; }
+    int endRoad(int node) const { return offsets_[node + 1]; }
+    int target(int road) const { return targets_[road]; }
+    float length(int road) const { return lengths_[road]; }
+    traffictrack::Direction direction(int road) const { return directions_[road]; }
+    int original(int road) const { return originals_[road]; }
+
+};
+
+#endif /* RoadGraph_hpp */
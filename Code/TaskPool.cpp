@@ -0,0 +1,389 @@
+//
+//  TaskPool.cpp
+//  TraffikTrak
+//
+//  Created by Matt Lovick on 2026-10-19.
+//  Copyright © 2026 Matt Lovick. All rights reserved.
+//
+
+#include <mutex>
+#include <thread>
+#include <functional>
+#include <chrono>
+#include <vector>
+#include <deque>
+#include <algorithm>
+#include "TaskPool.hpp"
+
+#ifdef __linux__
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+using namespace std;
+using namespace std::chrono;
+
+
+//the pool and index of the worker running on the current thread, so a task can find out which worker it is on
+static thread_local const TaskPool* currentPool = nullptr;
+static thread_local int currentIndex = -1;
+
+
+TaskPool* TaskPool::shared_ = nullptr;
+std::mutex TaskPool::staticMutex_;
+int TaskPool::sharedThreads_ = 0;
+std::vector<int> TaskPool::sharedCpus_;
+
+
+/** @fn take(int index, QueuedTask& queued)
+ *  @brief finds the next task for a worker: the oldest task of its own deque, otherwise the newest task of another
+ *      worker's deque, trying every priority in order before the next one
+ *  @param index the index of the worker
+ *  @param queued set to the task that was taken
+ *  @return bool false if every deque was empty
+ */
+bool TaskPool::take(int index, QueuedTask& queued) {
+
+    const int workers = static_cast<int>(workers_.size());
+
+    for (int priority = 0; priority < PRIORITIES; priority++) {
+
+        {
+            Worker* own = workers_[index];
+            lock_guard<mutex> guard(own->mutex);
+            if (!own->tasks[priority].empty()) {
+                queued = std::move(own->tasks[priority].front());
+                own->tasks[priority].pop_front();
+                return true;
+            }
+        }
+
+        //the owner works from the front, so thieves take from the back and rarely touch the same end
+        for (int i = 1; i < workers; i++) {
+            Worker* victim = workers_[(index + i) % workers];
+            lock_guard<mutex> guard(victim->mutex);
+            if (!victim->tasks[priority].empty()) {
+                queued = std::move(victim->tasks[priority].back());
+                victim->tasks[priority].pop_back();
+                steals_++;
+                return true;
+            }
+        }
+
+    }
+
+    return false;
+
+}
+
+
+/** @fn work(int index)
+ *  @brief worker loop that runs tasks until the pool is stopping and every deque is empty
+ *  @param index the index of the worker, between 0 and size()-1
+ */
+void TaskPool::work(int index) {
+
+    currentPool = this;
+    currentIndex = index;
+
+    while (true) {
+
+        QueuedTask queued;
+
+        if (!take(index, queued)) {
+
+            //same handshake as the submitters: announce the wait, then check for work under the lock
+            unique_lock<mutex> lock(idleMutex_);
+            sleeping_++;
+            idleCondition_.wait(lock, [this]() { return stopping_ || queued_ > 0; });
+            sleeping_--;
+
+            if (stopping_ && queued_ == 0) {
+                return;
+            }
+            continue;
+
+        }
+
+        queued_--;
+        queuedByPriority_[queued.priority]--;
+
+        if (maxQueued_ > 0) {
+            { lock_guard<mutex> guard(spaceMutex_); }
+            spaceCondition_.notify_one();
+        }
+
+        clock::time_point start = clock::now();
+        queued.task();
+        clock::time_point end = clock::now();
+
+        long long wait = duration_cast<microseconds>(start - queued.submitted).count();
+        long long run = duration_cast<microseconds>(end - start).count();
+        waitTotal_[queued.priority] += wait;
+        runTotal_[queued.priority] += run;
+        updateMaximum(waitMax_[queued.priority], wait);
+        updateMaximum(runMax_[queued.priority], run);
+        tasksFinished_[queued.priority]++;
+
+    }
+
+}
+
+
+/** @fn enqueue(std::function<void()> task, Priority priority)
+ *  @brief adds a task to a worker's deque and wakes up a sleeping worker. a caller outside the pool first waits for a
+ *      free place if the queue is bounded and full, a worker never waits so a full queue cannot stall the pool
+ *  @param task the task to run
+ *  @param priority the priority of the task
+ */
+void TaskPool::enqueue(std::function<void()> task, Priority priority) {
+
+    int index = currentWorker();
+
+    if (index < 0) {
+        if (maxQueued_ > 0) {
+            unique_lock<mutex> lock(spaceMutex_);
+            spaceCondition_.wait(lock, [this]() { return stopping_ || queued_ < static_cast<long long>(maxQueued_); });
+        }
+        index = nextWorker_++ % workers_.size();
+    }
+
+    QueuedTask queued;
+    queued.task = std::move(task);
+    queued.submitted = clock::now();
+    queued.priority = priority;
+
+    {
+        Worker* worker = workers_[index];
+        lock_guard<mutex> guard(worker->mutex);
+        worker->tasks[priority].push_back(std::move(queued));
+    }
+
+    queued_++;
+    updateMaximum(queuedMax_[priority], ++queuedByPriority_[priority]);
+
+    //a worker that announced it is going to sleep either sees the task or is woken up here
+    if (sleeping_ > 0) {
+        { lock_guard<mutex> guard(idleMutex_); }
+        idleCondition_.notify_one();
+    }
+
+}
+
+
+/** @fn pin(int index, const std::vector<int>& cpus)
+ *  @brief restricts a worker to one CPU, worker i gets cpus[i % cpus.size()]. only supported on Linux, elsewhere it does nothing
+ *  @param index the index of the worker
+ *  @param cpus the CPUs to spread the workers over, empty to leave the workers unpinned
+ */
+void TaskPool::pin(int index, const std::vector<int>& cpus) {
+
+    if (cpus.empty()) {
+        return;
+    }
+
+#ifdef __linux__
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    CPU_SET(cpus[index % cpus.size()], &set);
+    pthread_setaffinity_np(workers_[index]->thread->native_handle(), sizeof(set), &set);
+#endif
+
+}
+
+
+/** @fn updateMaximum(std::atomic<long long>& maximum, long long value)
+ *  @brief raises maximum to value, several workers may update it at once
+ */
+void TaskPool::updateMaximum(std::atomic<long long>& maximum, long long value) {
+
+    long long current = maximum.load();
+    while (value > current && !maximum.compare_exchange_weak(current, value)) { }
+
+}
+
+
+/** @fn TaskPool(int threads, size_t maxQueued, const std::vector<int>& cpus)
+ *  @brief starts the worker threads
+ *  @param threads the number of workers, at least one worker is always started
+ *  @param maxQueued the most tasks that can wait in the queue, 0 for no limit
+ *  @param cpus optional, the CPUs the workers are pinned to
+ */
+TaskPool::TaskPool(int threads, size_t maxQueued, const std::vector<int>& cpus) : sleeping_(0), queued_(0), nextWorker_(0), maxQueued_(maxQueued), stopping_(false), steals_(0) {
+
+    if (threads < 1) {
+        threads = 1;
+    }
+
+    for (int p = 0; p < PRIORITIES; p++) {
+        queuedByPriority_[p] = 0;
+        tasksFinished_[p] = 0;
+        waitTotal_[p] = 0;
+        waitMax_[p] = 0;
+        runTotal_[p] = 0;
+        runMax_[p] = 0;
+        queuedMax_[p] = 0;
+    }
+
+    //every deque exists before any worker starts looking for something to steal
+    for (int i = 0; i < threads; i++) {
+        workers_.push_back(new Worker());
+    }
+
+    for (int i = 0; i < threads; i++) {
+        workers_[i]->thread = new thread(&TaskPool::work, this, i);
+        pin(i, cpus);
+    }
+
+}
+
+
+/** @fn ~TaskPool()
+ *  @brief lets the workers finish the tasks already submitted, then joins and frees them
+ */
+TaskPool::~TaskPool() {
+
+    {
+        lock_guard<mutex> guard(idleMutex_);
+        stopping_ = true;
+    }
+    idleCondition_.notify_all();
+
+    {
+        lock_guard<mutex> guard(spaceMutex_);
+    }
+    spaceCondition_.notify_all();
+
+    for (Worker* worker : workers_) {
+        if (worker->thread->joinable()) {
+            worker->thread->join();
+        }
+        delete worker->thread;
+    }
+
+    for (Worker* worker : workers_) {
+        delete worker;
+    }
+
+}
+
+
+/** @fn shared()
+ *  @brief the pool shared by the whole program, created with the configured size the first time it is used
+ *  @return TaskPool*
+ */
+TaskPool* TaskPool::shared() {
+
+    lock_guard<mutex> guard(staticMutex_);
+
+    if (shared_ == nullptr) {
+        int threads = sharedThreads_ > 0 ? sharedThreads_ : static_cast<int>(thread::hardware_concurrency());
+        shared_ = new TaskPool(threads, 0, sharedCpus_);
+    }
+
+    return shared_;
+
+}
+
+
+/** @fn configureShared(int threads, const std::vector<int>& cpus)
+ *  @brief sets the size and CPU affinity of the shared pool, only possible before it is first used
+ *  @param threads the number of workers, 0 for one per hardware thread
+ *  @param cpus the CPUs to pin the workers to, empty to leave them unpinned
+ *  @return bool false if the shared pool already exists
+ */
+bool TaskPool::configureShared(int threads, const std::vector<int>& cpus) {
+
+    lock_guard<mutex> guard(staticMutex_);
+
+    if (shared_ != nullptr) {
+        return false;
+    }
+
+    sharedThreads_ = threads;
+    sharedCpus_ = cpus;
+    return true;
+
+}
+
+
+/** @fn size() const
+ *  @brief getter for the number of workers
+ *  @return int
+ */
+int TaskPool::size() const {
+    return static_cast<int>(workers_.size());
+}
+
+
+/** @fn currentWorker() const
+ *  @brief the index of the worker of this pool that is running the calling thread
+ *  @return int the worker index, or -1 if the caller is not one of this pool's workers
+ */
+int TaskPool::currentWorker() const {
+    return currentPool == this ? currentIndex : -1;
+}
+
+
+/** @fn metrics() const
+ *  @brief latencies of all the tasks finished so far
+ *  @return TaskPool::Metrics
+ */
+TaskPool::Metrics TaskPool::metrics() const {
+
+    Metrics m = { 0, 0, 0, 0, 0, 0 };
+    long long waitTotal = 0;
+    long long runTotal = 0;
+
+    for (int p = 0; p < PRIORITIES; p++) {
+        m.tasks += tasksFinished_[p];
+        waitTotal += waitTotal_[p];
+        runTotal += runTotal_[p];
+        m.maxWaitMicroseconds = max(m.maxWaitMicroseconds, waitMax_[p].load());
+        m.maxRunMicroseconds = max(m.maxRunMicroseconds, runMax_[p].load());
+        m.maxQueued = max(m.maxQueued, queuedMax_[p].load());
+    }
+
+    m.meanWaitMicroseconds = m.tasks > 0 ? static_cast<double>(waitTotal) / m.tasks : 0;
+    m.meanRunMicroseconds = m.tasks > 0 ? static_cast<double>(runTotal) / m.tasks : 0;
+    return m;
+
+}
+
+
+/** @fn metrics(Priority priority) const
+ *  @brief latencies of the tasks of one priority finished so far
+ *  @param priority the priority
+ *  @return TaskPool::Metrics
+ */
+TaskPool::Metrics TaskPool::metrics(Priority priority) const {
+
+    Metrics m;
+    m.tasks = tasksFinished_[priority];
+    m.meanWaitMicroseconds = m.tasks > 0 ? static_cast<double>(waitTotal_[priority]) / m.tasks : 0;
+    m.maxWaitMicroseconds = waitMax_[priority];
+    m.meanRunMicroseconds = m.tasks > 0 ? static_cast<double>(runTotal_[priority]) / m.tasks : 0;
+    m.maxRunMicroseconds = runMax_[priority];
+    m.maxQueued = queuedMax_[priority];
+    return m;
+
+}
+
+
+/** @fn steals() const
+ *  @brief the number of tasks a worker took from another worker's deque
+ *  @return long long
+ */
+long long TaskPool::steals() const {
+    return steals_;
+}
+
+
+/** @fn post(std::function<void()> task, Priority priority)
+ *  @brief submits a task without a future, for tasks whose result nobody waits for
+ *  @param task the task to run
+ *  @param priority the priority of the task
+ */
+void TaskPool::post(std::function<void()> task, Priority priority) {
+    enqueue(std::move(task), priority);
+}
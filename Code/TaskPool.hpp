@@ -0,0 +1,228 @@
+//
+//  TaskPool.hpp
+//  TraffikTrak
+//
+//  Created by Matt Lovick on 2026-10-19.
+//  Copyright © 2026 Matt Lovick. All rights reserved.
+//
+
+#ifndef TaskPool_hpp
+#define TaskPool_hpp
+
+#include <vector>
+#include <deque>
+#include <mutex>
+#include <condition_variable>
+#include <thread>
+#include <future>
+#include <functional>
+#include <memory>
+#include <atomic>
+#include <chrono>
+#include <utility>
+#include <algorithm>
+#include <exception>
+
+
+/** @class TaskPool
+ *  @brief fixed number of worker threads with work stealing, the common runtime of the program
+ *
+ *  every worker owns a deque per priority. a task submitted from outside the pool goes to the workers in turn, a task
+ *  submitted by a worker goes to its own deque, so a task's follow-up work stays on the same core. a worker takes the
+ *  oldest task of its own deque and, when that is empty, steals the newest task of another worker's deque. higher
+ *  priorities are always taken first, across all workers. results are returned through a std::future, and then() chains
+ *  a continuation that runs once a task is done without any thread waiting for it. a task must not wait on the future
+ *  of another task in the same pool, since all workers could end up waiting. the queue can be bounded, in which case
+ *  callers outside the pool block until a worker frees a place
+ *
+ *  shared() is the pool used by the whole program, its size and CPU affinity are set once with configureShared()
+ *  @author Matthew Lovick
+ */
+class TaskPool {
+
+public:
+    enum Priority {
+        HIGH, NORMAL, LOW
+    };
+
+    static const int PRIORITIES = 3;
+
+    /** @struct Metrics
+     *  @brief per-task latencies since the pool was created
+     */
+    struct Metrics {
+        long long tasks; /**< number of tasks finished */
+        double meanWaitMicroseconds; /**< time between submit() and a worker starting the task */
+        long long maxWaitMicroseconds;
+        double meanRunMicroseconds; /**< time the task itself took */
+        long long maxRunMicroseconds;
+        long long maxQueued; /**< deepest the queue has been */
+    };
+
+protected:
+    typedef std::chrono::steady_clock clock;
+
+    /** @struct QueuedTask
+     *  @brief a task and the time it was submitted
+     */
+    struct QueuedTask {
+        std::function<void()> task;
+        clock::time_point submitted;
+        Priority priority;
+    };
+
+    /** @struct Worker
+     *  @brief a worker thread and the tasks waiting for it
+     */
+    struct Worker {
+        std::mutex mutex; /**< synchronize access to tasks, held by the owner and by thieves */
+        std::deque<QueuedTask> tasks[PRIORITIES];
+        std::thread* thread;
+    };
+
+    static TaskPool* shared_;
+    static std::mutex staticMutex_;
+    static int sharedThreads_;
+    static std::vector<int> sharedCpus_;
+
+    std::vector<Worker*> workers_;
+    std::mutex idleMutex_; /**< only held by workers around their wait, and briefly by submitters to wake them */
+    std::condition_variable idleCondition_;
+    std::mutex spaceMutex_;
+    std::condition_variable spaceCondition_; /**< signals blocked submitters that a worker took a task off a full queue */
+    std::atomic<int> sleeping_; /**< workers that are (about to be) waiting on idleCondition_ */
+    std::atomic<long long> queued_; /**< tasks waiting in any deque */
+    std::atomic<unsigned> nextWorker_; /**< worker that gets the next task submitted from outside the pool */
+    const size_t maxQueued_; /**< most tasks waiting at once, 0 for no limit */
+    std::atomic<bool> stopping_; /**< set when the pool is destroyed, workers exit once the queue is empty */
+    std::atomic<long long> steals_;
+    std::atomic<long long> queuedByPriority_[PRIORITIES];
+    std::atomic<long long> tasksFinished_[PRIORITIES];
+    std::atomic<long long> waitTotal_[PRIORITIES]; /**< microseconds */
+    std::atomic<long long> waitMax_[PRIORITIES]; /**< microseconds */
+    std::atomic<long long> runTotal_[PRIORITIES]; /**< microseconds */
+    std::atomic<long long> runMax_[PRIORITIES]; /**< microseconds */
+    std::atomic<long long> queuedMax_[PRIORITIES];
+
+    void work(int index);
+    bool take(int index, QueuedTask& queued);
+    void enqueue(std::function<void()> task, Priority priority);
+    void pin(int index, const std::vector<int>& cpus);
+    static void updateMaximum(std::atomic<long long>& maximum, long long value);
+
+public:
+    TaskPool(int threads, size_t maxQueued = 0, const std::vector<int>& cpus = std::vector<int>());
+    virtual ~TaskPool();
+    static TaskPool* shared();
+    static bool configureShared(int threads, const std::vector<int>& cpus = std::vector<int>());
+    int size() const;
+    int currentWorker() const;
+    Metrics metrics() const;
+    Metrics metrics(Priority priority) const;
+    long long steals() const;
+    void post(std::function<void()> task, Priority priority = NORMAL);
+    template <typename F> auto submit(F task, Priority priority = NORMAL) -> std::future<decltype(task())>;
+    template <typename F, typename C> auto then(F task, C continuation, Priority priority = NORMAL) -> std::future<decltype(continuation(std::declval<std::future<decltype(task())>>()))>;
+    template <typename F> void forEach(size_t count, size_t grain, F work, Priority priority = NORMAL);
+
+};
+
+
+/**
+ *  \brief submits a task to the pool
+ *
+ *  the callable is wrapped in a packaged_task so its return value (or exception) is delivered through the returned future
+ */
+template <typename F>
+auto TaskPool::submit(F task, Priority priority) -> std::future<decltype(task())> {
+
+    typedef decltype(task()) result_type;
+
+    //std::function needs a copyable callable, so the packaged task is shared
+    std::shared_ptr<std::packaged_task<result_type()>> packaged = std::make_shared<std::packaged_task<result_type()>>(std::move(task));
+    std::future<result_type> result = packaged->get_future();
+    enqueue([packaged]() { (*packaged)(); }, priority);
+    return result;
+
+}
+
+
+/**
+ *  \brief submits a task and a continuation that is given the task's (ready) future once the task is done
+ *
+ *  the continuation is queued as a task of its own on the worker that ran the task, so nothing blocks between the two.
+ *  calling get() on the future it is given returns the result of the task or rethrows its exception
+ */
+template <typename F, typename C>
+auto TaskPool::then(F task, C continuation, Priority priority) -> std::future<decltype(continuation(std::declval<std::future<decltype(task())>>()))> {
+
+    typedef decltype(task()) first_type;
+    typedef decltype(continuation(std::declval<std::future<first_type>>())) result_type;
+
+    std::shared_ptr<std::packaged_task<first_type()>> first = std::make_shared<std::packaged_task<first_type()>>(std::move(task));
+    std::shared_ptr<std::future<first_type>> firstResult = std::make_shared<std::future<first_type>>(first->get_future());
+    std::shared_ptr<std::packaged_task<result_type(std::future<first_type>)>> second = std::make_shared<std::packaged_task<result_type(std::future<first_type>)>>(std::move(continuation));
+    std::future<result_type> result = second->get_future();
+
+    enqueue([this, first, firstResult, second, priority]() {
+        (*first)();
+        enqueue([firstResult, second]() { (*second)(std::move(*firstResult)); }, priority);
+    }, priority);
+    return result;
+
+}
+
+
+/**
+ *  \brief calls work(begin, end, slot) on ranges that together cover 0 to count-1, and returns once all of them are done
+ *
+ *  the ranges are at least grain long, up to four per worker so idle workers can steal what a slow one has not started,
+ *  and the calling thread runs the first one itself instead of only waiting. slot is the index of the worker running a range, or size() on the calling thread, so a caller that keeps
+ *  size()+1 workspaces can give every range its own. when the caller is one of the pool's workers everything runs on it,
+ *  in one range, since a task must not wait for other tasks. the first exception thrown by work is rethrown
+ */
+template <typename F>
+void TaskPool::forEach(size_t count, size_t grain, F work, Priority priority) {
+
+    const size_t ranges = std::min(count / std::max<size_t>(grain, 1), 4 * workers_.size() + 1);
+
+    if (ranges <= 1 || currentWorker() >= 0) {
+        if (count > 0) {
+            work(static_cast<size_t>(0), count, currentWorker() >= 0 ? currentWorker() : size());
+        }
+        return;
+    }
+
+    std::vector<std::future<void>> done;
+    done.reserve(ranges - 1);
+    for (size_t range = 1; range < ranges; range++) {
+        size_t begin = count * range / ranges;
+        size_t end = count * (range + 1) / ranges;
+        done.push_back(submit([this, &work, begin, end]() { work(begin, end, currentWorker()); }, priority));
+    }
+
+    //the futures are waited for even if the calling thread's range throws, work refers to the caller's stack
+    std::exception_ptr failure;
+    try {
+        work(static_cast<size_t>(0), count / ranges, size());
+    }
+    catch (...) {
+        failure = std::current_exception();
+    }
+    for (std::future<void>& f : done) {
+        try {
+            f.get();
+        }
+        catch (...) {
+            if (!failure) {
+                failure = std::current_exception();
+            }
+        }
+    }
+    if (failure) {
+        std::rethrow_exception(failure);
+    }
+
+}
+
+#endif /* TaskPool_hpp */
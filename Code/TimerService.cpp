@@ -0,0 +1,216 @@
+//
+//  TimerService.cpp
+//  TraffikTrak
+//
+//  Created by Matt Lovick on 2026-10-19.
+//  Copyright © 2026 Matt Lovick. All rights reserved.
+//
+
+#include <map>
+#include <mutex>
+#include <thread>
+#include <chrono>
+#include <functional>
+#include "TimerService.hpp"
+
+using namespace std;
+using namespace std::chrono;
+
+
+TimerService* TimerService::instance_ = nullptr;
+std::mutex TimerService::staticMutex_;
+
+
+/** @fn TimerService()
+ *  @brief default constructor, timer IDs start at 1
+ */
+TimerService::TimerService() : nextID_(1), runningTimer_(0), fired_(0) { }
+
+
+/** @fn dispatch()
+ *  @brief internal looping thread that sleeps until the earliest deadline and runs the callbacks that are due
+ */
+void TimerService::dispatch() {
+    
+    unique_lock<mutex> lock(timersMutex_);
+    timerThreadID_ = this_thread::get_id();
+    
+    while (!stopRequested()) {
+        
+        if (timers_.empty()) {
+            timersCondition_.wait(lock);
+            continue;
+        }
+        
+        auto earliest = timers_.begin();
+        if (clock::now() < earliest->first.first) {
+            //copy the deadline, cancel() may erase the timer while this thread waits
+            clock::time_point deadline = earliest->first.first;
+            timersCondition_.wait_until(lock, deadline);
+            continue;
+        }
+        
+        TimerID ID = earliest->first.second;
+        function<void()> callback = std::move(earliest->second);
+        timers_.erase(earliest);
+        deadlines_.erase(ID);
+        runningTimer_ = ID;
+        
+        //run the callback without the lock, so it can schedule or cancel timers itself
+        lock.unlock();
+        callback();
+        lock.lock();
+        
+        runningTimer_ = 0;
+        fired_++;
+        finishedCondition_.notify_all();
+        
+    }
+    
+}
+
+
+/** @fn wakeUp()
+ *  @brief wakes the timer thread so it sees the stop signal
+ */
+void TimerService::wakeUp() {
+    
+    {
+        lock_guard<mutex> guard(timersMutex_);
+    }
+    timersCondition_.notify_all();
+    
+}
+
+
+/** @fn instance()
+ *  @brief returns the singleton instance of the timer service, starting its thread the first time
+ *  @return TimerService* pointer to the sole instance of the class
+ */
+TimerService* TimerService::instance() {
+    
+    lock_guard<mutex> guard(staticMutex_);
+    if (instance_ == nullptr) {
+        instance_ = new TimerService();
+        instance_->run();
+    }
+    return instance_;
+    
+}
+
+
+/** @fn ~TimerService()
+ *  @brief stops the timer thread, pending timers are dropped without being called
+ */
+TimerService::~TimerService() {
+    
+    //stop the thread here, the base class destructor can no longer reach the overridden wakeUp()
+    stop();
+    
+}
+
+
+/** @fn schedule(clock::time_point deadline, std::function<void()> callback)
+ *  @brief registers a callback to run once the deadline has passed
+ *  @param deadline the time on the monotonic clock
+ *  @param callback the function to run on the timer thread
+ *  @return TimerService::TimerID the ID used to cancel the timer
+ */
+TimerService::TimerID TimerService::schedule(clock::time_point deadline, std::function<void()> callback) {
+    
+    TimerID ID;
+    bool earliest;
+    
+    {
+        lock_guard<mutex> guard(timersMutex_);
+        ID = nextID_++;
+        timers_[make_pair(deadline, ID)] = std::move(callback);
+        deadlines_[ID] = deadline;
+        earliest = timers_.begin()->first.second == ID;
+    }
+    
+    //the timer thread only needs to wake up if it is sleeping until a later deadline
+    if (earliest) {
+        timersCondition_.notify_one();
+    }
+    
+    return ID;
+    
+}
+
+
+/** @fn scheduleAfter(clock::duration delay, std::function<void()> callback)
+ *  @brief registers a callback to run once the delay has passed from now
+ *  @param delay the time to wait
+ *  @param callback the function to run on the timer thread
+ *  @return TimerService::TimerID the ID used to cancel the timer
+ */
+TimerService::TimerID TimerService::scheduleAfter(clock::duration delay, std::function<void()> callback) {
+    return schedule(clock::now() + delay, std::move(callback));
+}
+
+
+/** @fn cancel(TimerID ID)
+ *  @brief removes a pending timer. if its callback is running right now, waits for it to return (unless called from the callback)
+ *      so the caller can free anything the callback uses once cancel returns
+ *  @param ID the timer to cancel
+ *  @return bool whether the timer was still pending
+ */
+bool TimerService::cancel(TimerID ID) {
+    
+    unique_lock<mutex> lock(timersMutex_);
+    
+    auto it = deadlines_.find(ID);
+    if (it != deadlines_.end()) {
+        timers_.erase(make_pair(it->second, ID));
+        deadlines_.erase(it);
+        return true;
+    }
+    
+    if (ID != 0 && runningTimer_ == ID && this_thread::get_id() != timerThreadID_) {
+        finishedCondition_.wait(lock, [this, ID]() { return runningTimer_ != ID; });
+    }
+    
+    return false;
+    
+}
+
+
+/** @fn pending()
+ *  @brief the number of timers waiting for their deadline
+ *  @return size_t
+ */
+size_t TimerService::pending() {
+    
+    lock_guard<mutex> guard(timersMutex_);
+    return timers_.size();
+    
+}
+
+
+/** @fn fired() const
+ *  @brief the number of callbacks that have run
+ *  @return long long
+ */
+long long TimerService::fired() const {
+    return fired_;
+}
+
+
+/** @fn run()
+ *  @brief starts the timer thread
+ *  @return bool returns whether the run was successful. fails if the thread is already running
+ */
+bool TimerService::run() {
+    
+    lock_guard<mutex> threadGuard(threadMutex_);
+    
+    if (thread_ == nullptr) {
+        thread_ = new thread(&TimerService::dispatch, this);
+        running_ = true;
+        return true;
+    }
+    
+    return false;
+    
+}
@@ -0,0 +1,68 @@
+//
+//  TimerService.hpp
+//  TraffikTrak
+//
+//  Created by Matt Lovick on 2026-10-19.
+//  Copyright © 2026 Matt Lovick. All rights reserved.
+//
+
+#ifndef TimerService_hpp
+#define TimerService_hpp
+
+#include <map>
+#include <unordered_map>
+#include <utility>
+#include <functional>
+#include <mutex>
+#include <condition_variable>
+#include <thread>
+#include <chrono>
+#include <atomic>
+#include "AbstractStoppableThread.hpp"
+
+/** @class TimerService
+ *  @brief one thread for the whole program that calls back components when their deadlines expire
+ *
+ *  deadlines are points on the monotonic clock, so they do not drift the way counted one second ticks do and are not affected
+ *  by changes to the wall clock. callbacks run on the timer thread and must be short, anything slow should be handed off to
+ *  another thread. the pending timers are kept ordered by deadline, so scheduling and cancelling are O(log n)
+ *  @author Matthew Lovick
+ */
+class TimerService : public AbstractStoppableThread {
+    
+public:
+    typedef std::chrono::steady_clock clock;
+    typedef unsigned long long TimerID; /**< 0 is never used, so it can mark "no timer" */
+    
+private:
+    TimerService();
+    static TimerService* instance_; /**< static instance for singleton */
+    static std::mutex staticMutex_;
+    
+protected:
+    std::mutex timersMutex_; /**< synchronize access to the timers and runningTimer_ */
+    std::condition_variable timersCondition_; /**< wakes the timer thread when an earlier deadline is added or it is stopped */
+    std::condition_variable finishedCondition_; /**< signals cancel() that the callback it is waiting for returned */
+    std::map<std::pair<clock::time_point, TimerID>, std::function<void()>> timers_; /**< pending timers ordered by deadline */
+    std::unordered_map<TimerID, clock::time_point> deadlines_; /**< deadline of each pending timer, to find it when it is cancelled */
+    TimerID nextID_;
+    TimerID runningTimer_; /**< the timer whose callback is running, 0 if none */
+    std::thread::id timerThreadID_;
+    std::atomic<long long> fired_;
+    
+    void dispatch();
+    virtual void wakeUp();
+    
+public:
+    static TimerService* instance();
+    virtual ~TimerService();
+    TimerID schedule(clock::time_point deadline, std::function<void()> callback);
+    TimerID scheduleAfter(clock::duration delay, std::function<void()> callback);
+    bool cancel(TimerID ID);
+    size_t pending();
+    long long fired() const;
+    virtual bool run();
+    
+};
+
+#endif /* TimerService_hpp */
@@ -8,12 +8,14 @@
 
 #include <string>
 #include <unordered_map>
+#include <unordered_set>
 #include <mutex>
 #include <unistd.h>
 #include <stdio.h>
 #include <thread>
 #include <vector>
 #include <future>
+#include <memory>
 #include <utility>
 #include <sstream>
 #include "IntersectionDatabase.hpp"
@@ -22,6 +24,7 @@
 #include "AverageCongestionScores.hpp"
 #include "IntersectionID.h"
 #include "DateScorePair.hpp"
+#include "TaskPool.hpp"
 
 using namespace std;
 using namespace traffictrack;
@@ -51,7 +54,7 @@ std::mutex TrafficDatabase::staticMutex_;
  *  @param database_directory the location of the database
  *  @param prediction_level the number of data points that will be used to calculate the averages
  */
-TrafficDatabase::TrafficDatabase(const std::unordered_map<traffictrack::IntersectionID, Intersection*>& intersections, l_seconds time_between_saves, traffictrack::TimeBlock number_of_time_blocks, traffictrack::TempFile tmp_filename, traffictrack::DatabaseLocation database_directory, traffictrack::PredictionLevel prediction_level) : active_(true), timeBetweenSaves_(time_between_saves) {
+TrafficDatabase::TrafficDatabase(const std::unordered_map<traffictrack::IntersectionID, Intersection*>& intersections, l_seconds time_between_saves, traffictrack::TimeBlock number_of_time_blocks, traffictrack::TempFile tmp_filename, traffictrack::DatabaseLocation database_directory, traffictrack::PredictionLevel prediction_level) : active_(true), timeBetweenSaves_(time_between_saves), numberOfTimeBlocks_(number_of_time_blocks), flushTimer_(0), writesInFlight_(0) {
     
     std::string current_directory = "\"" + getCurrentDirectory() + "\"";
     system(("mkdir " + current_directory + "/" + "\"" + static_cast<std::string>(database_directory) + "\"").c_str());
@@ -60,6 +63,7 @@ TrafficDatabase::TrafficDatabase(const std::unordered_map<traffictrack::Intersec
         IntersectionDatabase* database = IntersectionDatabase::create(it->first, number_of_time_blocks, tmp_filename + traffictrack::TempFile(std::to_string(it->first)), database_directory, prediction_level);
         if (database != nullptr) {
             intersectionDatabases_.insert( { it->first, database } );
+            changedDatabases_.insert(it->first);
         }
         else {
             std::cerr << "failure to create database " << it->first << std::endl;
@@ -91,40 +95,103 @@ std::string TrafficDatabase::getCurrentDirectory() const {
 }
 
 
-/** @fn periodicallyWriteCache()
- *  @brief looping internal thread that writes to cache to files every so often
+/** @fn scheduleFlush()
+ *  @brief sets the timer of the next flush of the caches, timeBetweenSaves_ from now. the caller holds flushMutex_
  */
-void TrafficDatabase::periodicallyWriteCache() {
+void TrafficDatabase::scheduleFlush() {
+    
+    //the timer thread only hands the flush to the shared pool, the writes themselves are posted from there. the flush
+    //counts as a write in flight until it has posted them, so stop() also waits for a flush that has not started yet
+    flushTimer_ = TimerService::instance()->scheduleAfter(std::chrono::duration_cast<TimerService::clock::duration>(timeBetweenSaves_), [this]() {
+        {
+            lock_guard<mutex> guard(flushMutex_);
+            flushTimer_ = 0;
+            writesInFlight_++;
+        }
+        TaskPool::shared()->post([this]() { flushCaches(); });
+    });
     
-    waitFor(timeBetweenSaves_);
+}
+
+
+/** @fn flushCaches()
+ *  @brief writes the caches of all intersection databases to their files at the same time on the shared pool. nothing
+ *      waits for the writes, the last one to finish sets the timer of the next flush
+ */
+void TrafficDatabase::flushCaches() {
     
-    unique_lock<mutex> lock(databaseMutex_);
+    vector<pair<IntersectionID, IntersectionDatabase*>> all = databases();
     
-    while (stopRequested() == false) {
-        
-        //write to all files simultaneously using threads
-        vector<thread*> threads;
-        
-        for (unordered_map<IntersectionID, IntersectionDatabase*>::iterator it = intersectionDatabases_.begin(); it != intersectionDatabases_.end(); ++it) {
-            thread* thread_1 = new thread(&IntersectionDatabase::writeCache, it->second);
-            threads.push_back(thread_1);
+    {
+        lock_guard<mutex> guard(flushMutex_);
+        if (stopRequested()) {
+            all.clear();
         }
-        
-        //join the threads
-        for (thread* thread_1 : threads) {
-            if (thread_1->joinable()) {
-                thread_1->join();
-                delete thread_1;
-            }
+        writesInFlight_ += all.size();
+    }
+    
+    for (auto& entry : all) {
+        IntersectionDatabase* database = entry.second;
+        TaskPool::shared()->post([this, database]() {
+            database->writeCache();
+            finishWrite();
+        });
+    }
+    
+    finishWrite();
+    
+}
+
+
+/** @fn finishWrite()
+ *  @brief counts a cache write, or the flush that posted them, as done. the last one sets the timer of the next flush
+ *      unless the database is stopping
+ */
+void TrafficDatabase::finishWrite() {
+    
+    lock_guard<mutex> guard(flushMutex_);
+    if (--writesInFlight_ == 0) {
+        if (!stopRequested()) {
+            scheduleFlush();
         }
-        
-        //release the lock and wait
-        lock.unlock();
-        waitFor(timeBetweenSaves_);
-        lock.lock();
-        
+        flushCondition_.notify_all();
     }
-        
+    
+}
+
+
+/** @fn wakeUp()
+ *  @brief called by stop(), cancels the next flush and waits for the cache writes of a flush that already started
+ */
+void TrafficDatabase::wakeUp() {
+    
+    TimerService::TimerID timer;
+    {
+        lock_guard<mutex> guard(flushMutex_);
+        timer = flushTimer_;
+    }
+    
+    //cancel() also waits for the timer's callback if it is running, which is why flushMutex_ is not held meanwhile
+    if (timer != 0) {
+        TimerService::instance()->cancel(timer);
+    }
+    
+    unique_lock<mutex> guard(flushMutex_);
+    flushCondition_.wait(guard, [this]() { return writesInFlight_ == 0; });
+    
+}
+
+
+/** @fn databases()
+ *  @brief copies the intersection databases under databaseMutex_, so they can be handed to the shared pool and waited
+ *      for without holding it. each IntersectionDatabase locks itself, and none is deleted before the database is closed
+ *  @return std::vector<std::pair<traffictrack::IntersectionID, IntersectionDatabase*>>
+ */
+std::vector<std::pair<traffictrack::IntersectionID, IntersectionDatabase*>> TrafficDatabase::databases() {
+    
+    lock_guard<mutex> guard(databaseMutex_);
+    return vector<pair<IntersectionID, IntersectionDatabase*>>(intersectionDatabases_.begin(), intersectionDatabases_.end());
+    
 }
 
 
@@ -195,12 +262,7 @@ bool TrafficDatabase::log(traffictrack::IntersectionID intersection_ID, traffict
         throw TrafficDatabaseAccessException("called log on inactive database");
     }
     
-    string date = date_score_pair.first;
-    istringstream ss(date);
-    string formatted_date;
-    getline(ss, formatted_date);
-    
-    DateScorePair formatted_pair(formatted_date, date_score_pair.second);
+    DateScorePair formatted_pair(formatDate(date_score_pair.first), date_score_pair.second);
     
     lock_guard<mutex> guard(databaseMutex_);
     
@@ -209,7 +271,8 @@ bool TrafficDatabase::log(traffictrack::IntersectionID intersection_ID, traffict
     bool success = false;
     
     if (node != intersectionDatabases_.end()) {
-        if (node->second->log(formatted_pair)) {
+        if (node->second->log(std::move(formatted_pair))) {
+            changedDatabases_.insert(intersection_ID);
             success = true;
         }
     }
@@ -219,6 +282,51 @@ bool TrafficDatabase::log(traffictrack::IntersectionID intersection_ID, traffict
 }
 
 
+/** @fn logBatch(const std::vector<LogRecord>& records)
+ *  @brief logs several congestion scores at once, grouped by intersection so each intersection database is locked once
+ *  @param records the intersections and the scores to log for them
+ *  @return int the number of scores that were logged
+ */
+int TrafficDatabase::logBatch(const std::vector<LogRecord>& records) {
+    
+    if (!active()) {
+        throw TrafficDatabaseAccessException("called logBatch on inactive database");
+    }
+    
+    unordered_map<IntersectionID, vector<DateScorePair>> grouped;
+    for (const LogRecord& record : records) {
+        grouped[record.first].push_back(DateScorePair(formatDate(record.second.first), record.second.second));
+    }
+    
+    lock_guard<mutex> guard(databaseMutex_);
+    
+    int logged = 0;
+    for (auto it = grouped.begin(); it != grouped.end(); ++it) {
+        unordered_map<IntersectionID, IntersectionDatabase*>::iterator node = intersectionDatabases_.find(it->first);
+        if (node != intersectionDatabases_.end()) {
+            int count = node->second->logBatch(it->second);
+            if (count > 0) {
+                changedDatabases_.insert(it->first);
+            }
+            logged += count;
+        }
+    }
+    
+    return logged;
+    
+}
+
+
+/** @fn formatDate(const std::string& date)
+ *  @brief strips everything from the first line break on, ctime timestamps end with a newline
+ *  @param date the timestamp
+ *  @return std::string the first line of the timestamp
+ */
+std::string TrafficDatabase::formatDate(const std::string& date) {
+    return date.substr(0, date.find('\n'));
+}
+
+
 /** @fn calculateAverages()
  *  @brief calculates the average congestion scores for each time block across all intersections
  *  @return const std::unordered_map<traffictrack::IntersectionID, traffictrack::AverageCongestionScores> the average congestion scores
@@ -229,43 +337,74 @@ const std::unordered_map<traffictrack::IntersectionID, traffictrack::AverageCong
         throw TrafficDatabaseAccessException("calculating averages on inactive database");
     }
     
-    lock_guard<mutex> guard(databaseMutex_);
-        
-    vector<thread*> threads;
     unordered_map<IntersectionID, future<AverageCongestionScores>> return_values;
     
-    //calls calculateAverage() for each intersection database asychronously
-    for (unordered_map<IntersectionID, IntersectionDatabase*>::const_iterator it = intersectionDatabases_.begin(); it != intersectionDatabases_.end(); ++it) {
+    //calls calculateAverages() for each intersection database on the shared pool, without holding databaseMutex_ while
+    //waiting for them
+    for (auto& entry : databases()) {
         
-        promise<AverageCongestionScores> p;
-        future<AverageCongestionScores> f = p.get_future();
+        shared_ptr<promise<AverageCongestionScores>> p = make_shared<promise<AverageCongestionScores>>();
+        return_values.insert( { entry.first, p->get_future() } );
         
-        return_values.insert( { it->first, std::move(f) } );
+        IntersectionDatabase* database = entry.second;
+        TaskPool::shared()->post([database, p]() { database->calculateAverages(std::move(*p)); });
         
-        thread* thread_1 = new thread(&IntersectionDatabase::calculateAverages, it->second, std::move(p));
-        threads.push_back(thread_1);
+    }
+    
+    //move the return values from the tasks into an object and return it
+    unordered_map<IntersectionID, AverageCongestionScores> averages;
+    
+    for (auto it = return_values.begin(); it != return_values.end(); ++it) {
         
-        thread_1->join();
+        AverageCongestionScores average = it->second.get();
+        averages.insert( { it->first, average } );
         
     }
     
-    //join the threads
-    for (thread* thread_1 : threads) {
-        
-        if (thread_1->joinable()) {
-            thread_1->join();
-            delete thread_1;
+    return averages;
+    
+}
+
+
+/** @fn calculateChangedAverages()
+ *  @brief calculates the average congestion scores of the time blocks that were logged to since the last call, the first
+ *      call covers every time block of every intersection. intersections without new data are not touched
+ *  @return const std::unordered_map<traffictrack::IntersectionID, traffictrack::AverageCongestionScores> the changed averages,
+ *      only the intersections and time blocks with new data are in it
+ */
+const std::unordered_map<traffictrack::IntersectionID, traffictrack::AverageCongestionScores> TrafficDatabase::calculateChangedAverages() {
+    
+    if (!active()) {
+        throw TrafficDatabaseAccessException("calculating averages on inactive database");
+    }
+    
+    //take the changed intersections under databaseMutex_ and release it before waiting on the shared pool, the log
+    //batches running on it take the mutex too
+    vector<pair<IntersectionID, IntersectionDatabase*>> changed;
+    {
+        lock_guard<mutex> guard(databaseMutex_);
+        changed.reserve(changedDatabases_.size());
+        for (IntersectionID ID : changedDatabases_) {
+            changed.push_back( { ID, intersectionDatabases_[ID] } );
         }
-        
+        changedDatabases_.clear();
+    }
+    
+    unordered_map<IntersectionID, future<AverageCongestionScores>> return_values;
+    
+    for (auto& entry : changed) {
+        IntersectionDatabase* database = entry.second;
+        return_values.insert( { entry.first, TaskPool::shared()->submit([database]() { return database->calculateChangedAverages(); }) } );
     }
     
-    //move the return values from the threads into an object and return it
     unordered_map<IntersectionID, AverageCongestionScores> averages;
     
     for (auto it = return_values.begin(); it != return_values.end(); ++it) {
         
         AverageCongestionScores average = it->second.get();
-        averages.insert( { it->first, average } );
+        if (!average.empty()) {
+            averages.insert( { it->first, std::move(average) } );
+        }
         
     }
     
@@ -274,6 +413,15 @@ const std::unordered_map<traffictrack::IntersectionID, traffictrack::AverageCong
 }
 
 
+/** @fn numberOfTimeBlocks() const
+ *  @brief getter for the number of time blocks that the day is separated into, the schedules use the same blocks
+ *  @return traffictrack::TimeBlock
+ */
+traffictrack::TimeBlock TrafficDatabase::numberOfTimeBlocks() const {
+    return numberOfTimeBlocks_;
+}
+
+
 /** @fn active() const
  *  @brief getter for active member.
  *  @return bool whether or not the database is active or not
@@ -293,21 +441,23 @@ void TrafficDatabase::close() {
 
 
 /** @fn run()
- *  @brief starts the internal looping thread
- *  @return bool whether or not the thread was started. fails if the thread was already running
+ *  @brief starts writing the caches to files every timeBetweenSaves_, as a timer of the TimerService whose writes run on
+ *      the shared pool. the database has no thread of its own
+ *  @return bool whether or not the flushes were started. fails if they were already running
  */
 bool TrafficDatabase::run() {
     
     lock_guard<mutex> guard(threadMutex_);
     
-    if (thread_ != nullptr || !active()) {
+    if (running_ || !active()) {
         return false;
     }
     
-    thread_ = new thread(&TrafficDatabase::periodicallyWriteCache, this);
-    
     running_ = true;
     
+    lock_guard<mutex> flushGuard(flushMutex_);
+    scheduleFlush();
+    
     return true;
     
 }
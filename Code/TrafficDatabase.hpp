@@ -10,11 +10,15 @@
 #define TrafficDatabase_hpp
 
 #include <mutex>
+#include <condition_variable>
 #include <unordered_map>
+#include <unordered_set>
 #include <string>
 #include <chrono>
 #include <ratio>
 #include <atomic>
+#include <vector>
+#include <utility>
 #include "AbstractTrafficDatabase.hpp"
 #include "DateScorePair.hpp"
 #include "AverageCongestionScores.hpp"
@@ -24,6 +28,7 @@
 #include "TempFile.h"
 #include "DatabaseLocation.h"
 #include "PredictionLevel.h"
+#include "TimerService.hpp"
 
 class Intersection;
 class IntersectionDatabase;
@@ -40,18 +45,32 @@ protected:
     std::mutex databaseMutex_;
     std::atomic_bool active_;
     const l_seconds timeBetweenSaves_;
+    const traffictrack::TimeBlock numberOfTimeBlocks_; /**< the number of time blocks that the day is separated into */
     std::unordered_map<traffictrack::IntersectionID, IntersectionDatabase*> intersectionDatabases_;
+    std::unordered_set<traffictrack::IntersectionID> changedDatabases_; /**< intersections logged to since the last calculateChangedAverages(), guarded by databaseMutex_ */
+    std::mutex flushMutex_; /**< synchronize access to flushTimer_ and writesInFlight_ */
+    std::condition_variable flushCondition_; /**< signals wakeUp() that the last cache write of a flush is done */
+    TimerService::TimerID flushTimer_; /**< timer of the next flush of the caches, 0 if none */
+    size_t writesInFlight_; /**< cache writes of the current flush still on the shared pool, and the flush itself until it posted them */
     TrafficDatabase(const std::unordered_map<traffictrack::IntersectionID, Intersection*>& intersections, l_seconds time_between_saves, traffictrack::TimeBlock number_of_time_blocks, traffictrack::TempFile tmp_filename, traffictrack::DatabaseLocation database_directory, traffictrack::PredictionLevel prediction_level);
     void deactivate();
     std::string getCurrentDirectory() const;
-    void periodicallyWriteCache();
+    void scheduleFlush();
+    void flushCaches();
+    void finishWrite();
+    virtual void wakeUp();
+    std::vector<std::pair<traffictrack::IntersectionID, IntersectionDatabase*>> databases();
+    static std::string formatDate(const std::string& date);
     
 public:
     static TrafficDatabase* create(const std::unordered_map<traffictrack::IntersectionID, Intersection*>& intersections, l_seconds time_between_saves, traffictrack::TimeBlock number_of_time_blocks, traffictrack::TempFile tmp_filename, traffictrack::DatabaseLocation database_directory, traffictrack::PredictionLevel prediction_level);
     static TrafficDatabase* instance();
     virtual ~TrafficDatabase();
     virtual bool log(traffictrack::IntersectionID intersection, traffictrack::DateScorePair date_score_pair);
+    virtual int logBatch(const std::vector<LogRecord>& records);
     virtual const std::unordered_map<traffictrack::IntersectionID, traffictrack::AverageCongestionScores> calculateAverages();
+    virtual const std::unordered_map<traffictrack::IntersectionID, traffictrack::AverageCongestionScores> calculateChangedAverages();
+    virtual traffictrack::TimeBlock numberOfTimeBlocks() const;
     bool active() const;
     virtual void close();
     virtual bool run();
@@ -71,6 +71,17 @@ std::string TrafficLight::takePhoto() {
 }
 
 
+/** @fn qualityGate()
+ *  @brief returns the quality gate of the light's camera, which also holds the camera's skip counters
+ *  @return FrameQualityGate*
+ */
+FrameQualityGate* TrafficLight::qualityGate() {
+    
+    return camera_->qualityGate();
+    
+}
+
+
 /** @fn changeLight()
  *  @brief changes the lights and the states by delegating to the state object
  */
@@ -85,3 +96,28 @@ void TrafficLight::changeLight() {
     
 }
 
+
+/** @fn beginChange()
+ *  @brief starts a change without blocking (a green light turns yellow), finishChange() completes it
+ */
+void TrafficLight::beginChange() {
+    
+    lock_guard<mutex> stateGuard(stateMutex_);
+    state_->beginChange(this);
+    
+}
+
+
+/** @fn finishChange()
+ *  @brief completes a change started by beginChange() and moves to the next state
+ */
+void TrafficLight::finishChange() {
+    
+    lock_guard<mutex> stateGuard(stateMutex_);
+    state_->finishChange(this);
+    delete state_;
+    lock_guard<mutex> nextStateGuard(nextStateMutex_);
+    state_ = nextState_;
+    nextState_= nullptr;
+    
+}
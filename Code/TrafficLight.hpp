@@ -14,6 +14,7 @@
 #include "LightColour.h"
 
 class Camera;
+class FrameQualityGate;
 class AbstractTrafficLightState;
 class RedLight;
 class GreenLight;
@@ -38,7 +39,10 @@ public:
     virtual ~TrafficLight();
     traffictrack::LightColour colour() const;
     virtual std::string takePhoto();
+    FrameQualityGate* qualityGate();
     virtual void changeLight();
+    virtual void beginChange();
+    virtual void finishChange();
     friend class RedLight;
     friend class GreenLight;
     
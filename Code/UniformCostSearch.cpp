@@ -8,115 +8,213 @@
 
 #include <vector>
 #include <unordered_map>
-#include <queue>
-#include <map>
+#include <algorithm>
 #include <utility>
 #include "UniformCostSearch.hpp"
 #include "Intersection.hpp"
 #include "IntersectionID.h"
+#include "RoadGraph.hpp"
+#include "NodeHeap.hpp"
+#include "TaskPool.hpp"
 
 using namespace std;
 using namespace traffictrack;
 
 
+/** @fn UniformCostSearch()
+ *  @brief constructor, the snapshot of the map is taken by prepare() or by the first search
+ */
+UniformCostSearch::UniformCostSearch() : workspaces_(1) { }
+
+
 /** @fn ~UniformCostSearch()
  *  @brief destructor that does nothing
  */
 UniformCostSearch::~UniformCostSearch() { }
 
 
+/** @fn prepare(std::unordered_map<traffictrack::IntersectionID, Intersection*>& intersections)
+ *  @brief takes the snapshot of the map ahead of the first search. the arrays of the searches are sized to it by the
+ *      first search of every thread, so workers that never search take no memory
+ *  @param intersections the map
+ */
+void UniformCostSearch::prepare(std::unordered_map<traffictrack::IntersectionID, Intersection*>& intersections) {
+    
+    graph_ = RoadGraph(intersections);
+    workspaces_.assign(TaskPool::shared()->size() + 1, Workspace());
+    
+}
+
+
+/** @fn expanded() const
+ *  @brief the number of intersections the last search expanded, which shows how much of the map it had to look at
+ *  @return int
+ */
+int UniformCostSearch::expanded() const {
+    return workspaces_.back().expanded;
+}
+
+
+/** @fn memory() const
+ *  @brief the bytes taken by the snapshot, the estimates and the arrays of every thread that searched
+ *  @return size_t
+ */
+size_t UniformCostSearch::memory() const {
+    
+    size_t bytes = graph_.memory() + estimates_.capacity()*sizeof(float);
+    for (const Workspace& workspace : workspaces_) {
+        bytes += workspace.queue.memory() + workspace.distance.capacity()*sizeof(float) + workspace.predecessor.capacity()*sizeof(int)
+            + workspace.stamp.capacity()*sizeof(unsigned);
+    }
+    return bytes;
+    
+}
+
+
 /** @fn search(Intersection* startState, std::unordered_map<traffictrack::IntersectionID, Intersection*>& intersections)
  *  @brief performs a uniform cost search algorithm on the graph and returns the path
  *  @return std::pair<std::vector<Intersection*>, float> the path as a vector
  */
 std::pair<std::vector<Intersection*>, float> UniformCostSearch::search(Intersection* startState, std::unordered_map<traffictrack::IntersectionID, Intersection*>& intersections) {
     
-    //float is the distance from the starting node, and the Intersection* is a pointer to the predecessor along the shortest path
-    typedef pair<float, Intersection*> node;
+    //the searches run on a snapshot of the map, take a new one if a road or hospital was added since
+    if (!graph_.current()) {
+        prepare(intersections);
+    }
+    
+    return search(graph_.index(startState), workspaces_.back());
+    
+}
+
+
+/** @fn searchBatch(const std::vector<Intersection*>& starts, std::unordered_map<traffictrack::IntersectionID, Intersection*>& intersections)
+ *  @brief searches from all the starts at once on the shared TaskPool, the calling thread takes part
+ *  @return std::vector<std::pair<std::vector<Intersection*>, float>> the path from every start, in the same order
+ */
+std::vector<std::pair<std::vector<Intersection*>, float>> UniformCostSearch::searchBatch(const std::vector<Intersection*>& starts, std::unordered_map<traffictrack::IntersectionID, Intersection*>& intersections) {
+    
+    //the snapshot is only ever replaced here, before the workers start reading it
+    if (!graph_.current()) {
+        prepare(intersections);
+    }
+    
+    vector<pair<vector<Intersection*>, float>> routes(starts.size());
+    TaskPool::shared()->forEach(starts.size(), 4, [this, &starts, &routes](size_t begin, size_t end, int slot) {
+        for (size_t i = begin; i < end; i++) {
+            routes[i] = search(graph_.index(starts[i]), workspaces_[slot]);
+        }
+    }, TaskPool::HIGH);
+    
+    return routes;
+    
+}
+
+
+/** @fn search(int startNode, Workspace& workspace) const
+ *  @brief the search itself, it only reads the snapshot and writes to the workspace, so threads with workspaces of
+ *      their own can search at the same time
+ *  @param startNode the number of the start in graph_, -1 if it is not on the map
+ *  @param workspace the arrays of the calling thread
+ *  @return std::pair<std::vector<Intersection*>, float> the path and its length, an empty path and -1 if no hospital can be reached
+ */
+std::pair<std::vector<Intersection*>, float> UniformCostSearch::search(int startNode, Workspace& workspace) const {
+    
+    const bool estimated = !estimates_.empty();
+    workspace.expanded = 0;
     
-    //auxiliary data structures to help with the search
     vector<Intersection*> path; //will be used at the end to return the final path
-    map<Intersection*, bool> expanded; //tracks whether a node has already been expanded
-    map<Intersection*, node> predecessor; //tracks the current shortest path to a node and the parent node that got to the node
-    priority_queue<node, vector<node>, std::greater<node>> queue; //min priority queue to pop nodes with the smallest paths
+    int goal = -1; //the goal node
     
-    bool found_goal_state = false; //tracks whether or not we have found the goal state or not
-    Intersection* goal = nullptr; //pointer to the goal Intersection
+    if (startNode < 0) {
+        return make_pair(path, -1);
+    }
     
-    //start with the starting state in the queue
-    predecessor[startState] = make_pair(0, nullptr); //starting state has no predecessor and is 0 distance from itself
-    node start(0, startState);
-    queue.push(start);
+    //the first search of a thread on this snapshot sizes its arrays
+    const int size = graph_.size();
+    if (static_cast<int>(workspace.stamp.size()) != size) {
+        workspace.queue.resize(size);
+        workspace.distance.assign(size, 0);
+        workspace.predecessor.assign(size, -1);
+        workspace.stamp.assign(size, 0);
+        workspace.search = 0;
+    }
+    
+    NodeHeap& queue = workspace.queue;
+    vector<float>& best = workspace.distance;
+    vector<int>& predecessor = workspace.predecessor;
+    vector<unsigned>& stamp = workspace.stamp;
+    unsigned& number = workspace.search;
     
-    //represents the current node being analyzed in the search
-    node current;
+    //a new search number makes every entry of the arrays out of date at once. when the number wraps around, the stamps
+    //are cleared for real so an entry from 2^32 searches ago cannot pass for a current one
+    if (++number == 0) {
+        std::fill(stamp.begin(), stamp.end(), 0);
+        number = 1;
+    }
+    
+    //start with the starting state in the queue
+    stamp[startNode] = number;
+    best[startNode] = 0; //starting state has no predecessor and is 0 distance from itself
+    predecessor[startNode] = -1;
+    queue.push(startNode, estimated ? estimates_[startNode] : 0);
     
-    //loop until we have either found teh goal state or we have searched the entire graph and the goal state was not found
-    while (!found_goal_state && !queue.empty()){
+    //loop until we have either found the goal state or we have searched the entire graph and the goal state was not found
+    while (!queue.empty()) {
         
-        //get the node that is currently the shortest distance from the starting node
-        current = queue.top();
-        queue.pop();
-        float currentDistance = predecessor[current.second].first;
+        //get the node that is currently the shortest distance from the starting node. every node is in the queue once, with
+        //its shortest distance, and leaves it for good: a node that was reached and is not in the queue was expanded
+        int current = queue.pop();
+        float currentDistance = best[current];
         
         //if we find the goal state, quit
-        if (current.second->hospital()) {
-            found_goal_state = true;
-            goal = current.second;
-            continue;
+        if (graph_.hospital(current)) {
+            goal = current;
+            break;
         }
         
-        //only expand a node if it hasn't been expanded already
-        //due to the order of expansion, a node will only be dequeued when its distance from the start state is the smallest of all paths being searched
-        //therefore, we only need to expand each node once
-        if (expanded.find(current.second) == expanded.end()) {
+        workspace.expanded++;
+        
+        //expand the node by analyzing each of the neighbors, the roads of a node are next to each other in the graph
+        for (int road = graph_.firstRoad(current); road < graph_.endRoad(current); road++) {
             
-            //expand the node by getting analyzing each of the neighbors
-            for (Road r : current.second->neighbors()) {
-                
-                int roadLength = r.distance(); //arc cost
-                Intersection* neighbor = r.secondIntersection(); //pointer to the neighbor being analyzed
+            int neighbor = graph_.target(road); //the neighbor being analyzed
+            float distance = currentDistance + graph_.length(road); //arc cost
+            bool seen = stamp[neighbor] == number;
+            
+            //if the neighbor has not been seen in this search, add it to the queue. if it is still in the queue and the path
+            //through the current node is shorter, lower its place in the queue and make the current node its predecessor
+            if (!seen || (queue.contains(neighbor) && distance < best[neighbor])) {
                 
-                //the neighbor might already be in the queue so we need to test whether or not to update its references
-                //if the neighbor is not in predecessor, then it has not been seen before, so we can add it to the queue
-                //if the neighbor has been seen before but the current path to the node is shorter than the existing path, update the precessor to
-                //      reflect the new shortest path and add the new shortest path information to the predecessor
-                if ((predecessor.find(neighbor) == predecessor.end()) || ((currentDistance + roadLength) < predecessor.find(neighbor)->second.first)) {
-                    
-                    predecessor[neighbor] = make_pair(currentDistance + roadLength, current.second); //set current shortest distance, and parent=current node
-                    node newNode(currentDistance + roadLength, neighbor); //create a new node and add it to the queue
-                    queue.push(newNode);
-                    
-                }
+                stamp[neighbor] = number;
+                best[neighbor] = distance;
+                predecessor[neighbor] = current;
+                queue.push(neighbor, distance + (estimated ? estimates_[neighbor] : 0));
                 
             }
             
-            //signal that the node was expanded so it will not be expanded in the future
-            expanded[current.second]= true;
-            
         }
         
     }
     
+    queue.clear();
+    
     //if we found the goal state then rebuild the path and return it
-    if (found_goal_state){
-        
-        float distance = predecessor.at(goal).first; //distance from start to goal
-        Intersection* current = goal; //start at the goal and work backwards using the predecessor pointer to the parent
+    if (goal >= 0) {
         
-        //build the path from the goal state until we reach the starting state
-        //the predecessor of the starting state is null, so we stop once we have processed the starting state
-        while(current != nullptr) {
-            path.insert(path.begin(), current); //insert at the beginning so that the order is reversed (since we are starting at the end)
-            current = predecessor[current].second; //go to the predecessor and repeat
+        //start at the goal and work backwards using the predecessor of each node, the predecessor of the starting state is -1
+        int length = 0;
+        for (int node = goal; node != -1; node = predecessor[node]) {
+            length++;
         }
-        return make_pair(path, distance); //return the path and the total path distance
+        path.resize(length);
+        for (int node = goal; node != -1; node = predecessor[node]) {
+            path[--length] = graph_.intersection(node); //filled from the back, so the path does not have to be turned around
+        }
+        
+        return make_pair(std::move(path), best[goal]); //return the path and the total path distance
     }
     else { //else return an empty path
         return make_pair(path, -1);
     }
     
-    
-    
 }
-
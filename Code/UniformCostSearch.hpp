@@ -15,17 +15,52 @@
 #include "Intersection.hpp"
 #include "IntersectionID.h"
 #include "AbstractPathFinder.hpp"
+#include "RoadGraph.hpp"
+#include "NodeHeap.hpp"
 
 
 /** @class UniformCostSearch
  *  @brief implements the AbstractPathFinder using a uniform cost search algorithm
+ *
+ *  the queue is ordered by the distance from the start plus estimates_, so a subclass that fills in estimates_ turns the
+ *  search into A* (AStarSearch). the estimates must never be more than the real distance to the nearest hospital, and
+ *  must not drop by more than the length of a road along it, or the first hospital reached is not the nearest
+ *
+ *  the arrays of a search are kept between searches and sized to the map, an array entry only counts if its stamp is
+ *  the number of the current search, so nothing has to be cleared and a search does not allocate except for the path.
+ *  searchBatch() runs the searches on the shared TaskPool, every worker with arrays of its own
  *  @author Matthew Lovick
  */
 class UniformCostSearch : public AbstractPathFinder {
     
+protected:
+    
+    /** @struct Workspace
+     *  @brief the arrays of one thread's searches, sized to the map by its first search
+     */
+    struct Workspace {
+        NodeHeap queue; /**< the intersections reached and not yet expanded, by distance from the start plus estimate */
+        std::vector<float> distance; /**< shortest distance from the start found so far */
+        std::vector<int> predecessor; /**< the intersection before on that path, -1 for the start */
+        std::vector<unsigned> stamp; /**< the search that last reached each intersection, the entries above are left over from an older search otherwise */
+        unsigned search = 0; /**< the number of the current search */
+        int expanded = 0; /**< intersections expanded by the last search */
+    };
+    
+    RoadGraph graph_; /**< snapshot of the map the searches run on, taken again when the map changes */
+    std::vector<float> estimates_; /**< lower bound on the distance from each intersection to a hospital, empty for a plain uniform cost search */
+    std::vector<Workspace> workspaces_; /**< one per worker of the shared TaskPool, the last one for the calling thread */
+    
+    std::pair<std::vector<Intersection*>, float> search(int startNode, Workspace& workspace) const;
+    
 public:
+    UniformCostSearch();
     virtual ~UniformCostSearch();
+    int expanded() const;
+    virtual size_t memory() const;
     virtual std::pair<std::vector<Intersection*>, float> search(Intersection* startState, std::unordered_map<traffictrack::IntersectionID, Intersection*>& intersections);
+    virtual std::vector<std::pair<std::vector<Intersection*>, float>> searchBatch(const std::vector<Intersection*>& starts, std::unordered_map<traffictrack::IntersectionID, Intersection*>& intersections);
+    virtual void prepare(std::unordered_map<traffictrack::IntersectionID, Intersection*>& intersections);
     
 };
 
@@ -0,0 +1,143 @@
+//
+//  WeeklySchedule.cpp
+//  TraffikTrak
+//
+//  Created by Matt Lovick on 2026-10-19.
+//  Copyright © 2026 Matt Lovick. All rights reserved.
+//
+
+#include <vector>
+#include <string>
+#include <utility>
+#include <chrono>
+#include <ctime>
+#include <algorithm>
+#include "WeeklySchedule.hpp"
+#include "LightSchedule.hpp"
+#include "DayTimeBlockPair.hpp"
+
+using namespace std;
+using namespace std::chrono;
+using namespace traffictrack;
+
+
+/** @fn WeeklySchedule(Intervals intervals)
+ *  @brief constructor for a schedule that uses the same interval times all week
+ *  @param intervals the north/south and east/west interval times
+ */
+WeeklySchedule::WeeklySchedule(Intervals intervals) : timeBlocks_(1), blockLength_(24), intervals_(DAYS, intervals) {
+    findWeekStart();
+}
+
+
+/** @fn WeeklySchedule(const traffictrack::LightSchedule& schedule, traffictrack::TimeBlock timeBlocks, Intervals fallback)
+ *  @brief compiles a LightSchedule. the day is split the way the database splits it: 24/timeBlocks hours each, the last
+ *      block also gets what is left of the day
+ *  @param schedule the interval times of each day time block
+ *  @param timeBlocks the number of time blocks per day the database was configured with, the schedule may only have some
+ *  @param fallback the interval times of any day time block that is not in schedule
+ */
+WeeklySchedule::WeeklySchedule(const traffictrack::LightSchedule& schedule, traffictrack::TimeBlock timeBlocks, Intervals fallback) : timeBlocks_(min(max(static_cast<int>(timeBlocks), 1), 24)), blockLength_(24/timeBlocks_) {
+
+    intervals_.assign(DAYS*timeBlocks_, fallback);
+    for (auto it = schedule.begin(); it != schedule.end(); ++it) {
+        int day = dayIndex(it->first.first);
+        if (day >= 0 && it->first.second >= 0 && it->first.second < timeBlocks_) {
+            intervals_[day*timeBlocks_ + it->first.second] = it->second;
+        }
+    }
+
+    findWeekStart();
+
+}
+
+
+/** @fn ~WeeklySchedule()
+ *  @brief destructor does nothing
+ */
+WeeklySchedule::~WeeklySchedule() { }
+
+
+/** @fn findWeekStart()
+ *  @brief sets weekStart_ from the local time. a change to or from daylight saving time only shows once the table is rebuilt
+ */
+void WeeklySchedule::findWeekStart() {
+
+    clock::time_point now = clock::now();
+    time_t wall = time(NULL);
+    tm local;
+    localtime_r(&wall, &local);
+
+    //tm_wday counts from Sunday, the schedule from Monday
+    long long sinceMonday = ((local.tm_wday + 6) % DAYS)*24*3600LL + local.tm_hour*3600LL + local.tm_min*60LL + local.tm_sec;
+    weekStart_ = now - seconds(sinceMonday);
+
+}
+
+
+/** @fn dayIndex(const std::string& day)
+ *  @brief converts the three letter shorthand the database uses for a day of the week
+ *  @param day "Mon" to "Sun"
+ *  @return int 0 for Monday to 6 for Sunday, -1 if day is not one of them
+ */
+int WeeklySchedule::dayIndex(const std::string& day) {
+
+    static const string days[DAYS] = { "Mon", "Tue", "Wed", "Thu", "Fri", "Sat", "Sun" };
+    for (int i = 0; i < DAYS; i++) {
+        if (days[i] == day) {
+            return i;
+        }
+    }
+    return -1;
+
+}
+
+
+/** @fn timeBlocks() const
+ *  @brief getter for the number of time blocks per day
+ *  @return int
+ */
+int WeeklySchedule::timeBlocks() const {
+    return timeBlocks_;
+}
+
+
+/** @fn index(clock::time_point time) const
+ *  @brief the entry of the table that applies at a time
+ *  @param time the time on the monotonic clock
+ *  @return int day*timeBlocks() + time block
+ */
+int WeeklySchedule::index(clock::time_point time) const {
+
+    const long long week = DAYS*24*3600LL;
+    long long sinceMonday = duration_cast<seconds>(time - weekStart_).count() % week;
+    if (sinceMonday < 0) {
+        sinceMonday += week;
+    }
+
+    int day = static_cast<int>(sinceMonday / (24*3600));
+    int hour = static_cast<int>(sinceMonday % (24*3600)) / 3600;
+    int block = min(hour / static_cast<int>(blockLength_.count()), timeBlocks_ - 1);
+    return day*timeBlocks_ + block;
+
+}
+
+
+/** @fn at(int day, int timeBlock) const
+ *  @brief the interval times of a day time block
+ *  @param day 0 for Monday to 6 for Sunday
+ *  @param timeBlock between 0 and timeBlocks()-1
+ *  @return const Intervals&
+ */
+const WeeklySchedule::Intervals& WeeklySchedule::at(int day, int timeBlock) const {
+    return intervals_[day*timeBlocks_ + timeBlock];
+}
+
+
+/** @fn current() const
+ *  @brief the interval times of the time block the week is in right now
+ *  @return const Intervals&
+ */
+const WeeklySchedule::Intervals& WeeklySchedule::current() const {
+    return intervals_[index(clock::now())];
+}
@@ -0,0 +1,54 @@
+//
+//  WeeklySchedule.hpp
+//  TraffikTrak
+//
+//  Created by Matt Lovick on 2026-10-19.
+//  Copyright © 2026 Matt Lovick. All rights reserved.
+//
+
+#ifndef WeeklySchedule_hpp
+#define WeeklySchedule_hpp
+
+#include <vector>
+#include <string>
+#include <utility>
+#include <chrono>
+#include "LightSchedule.hpp"
+#include "TimeBlock.h"
+
+/** @class WeeklySchedule
+ *  @brief an intersection's LightSchedule compiled into a dense table with one entry per day and time block
+ *
+ *  the table never changes once it is built, so any number of threads can read it without locks. the current time block is
+ *  worked out from the monotonic clock: the start of the week (Monday 00:00 local time) is converted to the monotonic clock
+ *  once, when the table is built, and every lookup only does integer arithmetic from there
+ *  @author Matthew Lovick
+ */
+class WeeklySchedule {
+
+public:
+    typedef std::chrono::steady_clock clock;
+    typedef std::pair<std::chrono::seconds, std::chrono::seconds> Intervals; /**< north/south and east/west interval times */
+    static const int DAYS = 7;
+
+protected:
+    int timeBlocks_; /**< time blocks per day */
+    std::chrono::hours blockLength_;
+    clock::time_point weekStart_; /**< Monday 00:00 local time, on the monotonic clock */
+    std::vector<Intervals> intervals_; /**< DAYS*timeBlocks_ entries, all the blocks of Monday first */
+
+    void findWeekStart();
+    static int dayIndex(const std::string& day);
+
+public:
+    WeeklySchedule(Intervals intervals);
+    WeeklySchedule(const traffictrack::LightSchedule& schedule, traffictrack::TimeBlock timeBlocks, Intervals fallback);
+    virtual ~WeeklySchedule();
+    int timeBlocks() const;
+    int index(clock::time_point time) const;
+    const Intervals& at(int day, int timeBlock) const;
+    const Intervals& current() const;
+
+};
+
+#endif /* WeeklySchedule_hpp */
@@ -1,4 +1,5 @@
 #include "Yolo.hpp"
+#include <chrono>
 
 using namespace cv;
 using namespace dnn;
@@ -25,7 +26,7 @@ yolo::yolo(const String weightsFile, const String classesFile, const String conf
     
     ifstream file; //file to read
     String line; //variable to store strings
-    file.open("coco.names"); //open classes file coco.names
+    file.open(classesFile); //open classes file coco.names
 
     //read every line in file and store in vector classes
     while(getline(file,line)){
@@ -55,68 +56,163 @@ yolo::~yolo(){}
 
 
 /**
-* @fn processImage()
-* @brief processes the image to return identify all objects in the image
-* @param img - a jpg image
-* @returns A list of yolo_obj (refer to struct above) that were identified from the image)
+* @fn elapsedMilliseconds()
+* @brief helper for the stage timings: milliseconds between two points in time
+* @param start - when the stage started
+* @param end - when the stage ended
+* @returns the elapsed time in milliseconds
 */
-std::vector<yolo_obj> yolo::processImage(Mat img){
-    Mat blob; //variable to store image converted to blob
-    blobFromImage(img, blob, 1/255.0, Size(this->width, this->height),Scalar(0,0,0), true, false ); //convert image to blob
-    net.setInput(blob);
-    std::vector<cv::Mat> net_output; //vector to store predictions
-    net.forward(net_output,unconnected_layers); //run netowrk
+static double elapsedMilliseconds(std::chrono::steady_clock::time_point start, std::chrono::steady_clock::time_point end){
+    return std::chrono::duration<double, std::milli>(end - start).count();
+}
 
-    //vectors to store information
-    vector <float> confidences;
-    vector <int> classIDs;
-    vector <cv::Rect> boundingBoxes;
-
-    //iterate through predictions in net_output to store predictions with confidence >confidence threshold
-    for(int i = 0; i < net_output.size(); i++) {
-        float* data = (float*)net_output[i].data;
-        for(int j = 0; j < net_output[i].rows; j++) {
-            float objectConfidence= data[4];
-            if (objectConfidence > this->confidence_threshold){
-                Mat classPredictions = net_output[i].row(j).colRange(5,net_output[i].cols);
-                Point maxPoint;
-                double maxVal;
-                minMaxLoc(classPredictions, 0, &maxVal, 0, &maxPoint);
-
-                int centerX = (int)(data[0] * img.cols);
-                int centerY = (int)(data[1] * img.rows);
-                int boxWidth = (int)(data[2] * img.cols);
-                int boxHeight = (int)(data[3] * img.rows);
-
-                confidences.push_back(maxVal);
-                classIDs.push_back(maxPoint.x);
-                boundingBoxes.push_back(Rect(centerX, centerY, boxWidth, boxHeight));
 
-            }
-            data += net_output[i].cols; 
+
+/**
+* @fn decodeOutput()
+* @brief stores every prediction in one output layer with confidence > confidence threshold as a candidate box
+* @param output - the predictions of one output layer for one image (one row per prediction)
+* @param imageSize - size of the original image, used to scale the boxes back to pixels
+* @param confidences - candidate confidences are appended here
+* @param classIDs - candidate class indices are appended here
+* @param boundingBoxes - candidate boxes are appended here
+* @returns void
+*/
+void yolo::decodeOutput(const Mat& output, const Size& imageSize, vector<float>& confidences, vector<int>& classIDs, vector<Rect>& boundingBoxes) const{
+    const float* data = (const float*)output.data;
+    for(int j = 0; j < output.rows; j++) {
+        float objectConfidence= data[4];
+        if (objectConfidence > this->confidence_threshold){
+            Mat classPredictions = output.row(j).colRange(5,output.cols);
+            Point maxPoint;
+            double maxVal;
+            minMaxLoc(classPredictions, 0, &maxVal, 0, &maxPoint);
+
+            int centerX = (int)(data[0] * imageSize.width);
+            int centerY = (int)(data[1] * imageSize.height);
+            int boxWidth = (int)(data[2] * imageSize.width);
+            int boxHeight = (int)(data[3] * imageSize.height);
+
+            confidences.push_back(maxVal);
+            classIDs.push_back(maxPoint.x);
+            boundingBoxes.push_back(Rect(centerX, centerY, boxWidth, boxHeight));
+
+        }
+        data += output.cols;
     }
 }
 
-  // remove the bounding boxes indicate the same object using NMS
+
+
+/**
+* @fn suppress()
+* @brief removes the bounding boxes that indicate the same object using NMS and builds the final objects
+* @param boundingBoxes - candidate boxes from decodeOutput
+* @param confidences - candidate confidences from decodeOutput
+* @param classIDs - candidate class indices from decodeOutput
+* @returns A list of yolo_obj that survived NMS
+*/
+std::vector<yolo_obj> yolo::suppress(const vector<Rect>& boundingBoxes, const vector<float>& confidences, const vector<int>& classIDs) const{
     std::vector<int> indices;
     NMSBoxes(boundingBoxes, confidences, this->confidence_threshold, 0.3, indices);
     // save bounding boxes
-    this->final_objects_list.resize(indices.size());
+    std::vector<yolo_obj> objects(indices.size());
     for(int i = 0; i < indices.size(); i++) {
         int idx = indices[i];
         CV_Assert(classIDs[idx] < this->classes.size());
-		yolo_obj object;
-		object.boundingBox = boundingBoxes[idx];
-		object.classID = this->classes[classIDs[idx]];
-		object.confidence = confidences[idx];
-        
-        this->final_objects_list[i] = object;
+        yolo_obj object;
+        object.boundingBox = boundingBoxes[idx];
+        object.classID = this->classes[classIDs[idx]];
+        object.confidence = confidences[idx];
+
+        objects[i] = object;
     }
+    return objects;
+}
+
+
+
+/**
+* @fn processImage()
+* @brief processes the image to return identify all objects in the image
+* @param img - a jpg image
+* @param timings - optional, receives the time spent in each stage
+* @returns A list of yolo_obj (refer to struct above) that were identified from the image)
+*/
+std::vector<yolo_obj> yolo::processImage(Mat img, yolo_timings* timings){
+    std::vector<std::vector<yolo_obj>> results = processImages(std::vector<Mat>(1, img), timings);
+    this->final_objects_list = results[0];
     return this->final_objects_list;
 }
 
 
 
+/**
+* @fn processImages()
+* @brief processes a batch of images with a single forward pass of the network
+* @param imgs - the images to process, they do not need to be the same size
+* @param timings - optional, receives the time spent in each stage for the whole batch
+* @returns one list of yolo_obj per image, in the same order as imgs
+*/
+std::vector<std::vector<yolo_obj>> yolo::processImages(const std::vector<Mat>& imgs, yolo_timings* timings){
+    using clock = std::chrono::steady_clock;
+    std::vector<std::vector<yolo_obj>> results(imgs.size());
+    if (imgs.empty()) {
+        return results;
+    }
+
+    clock::time_point start = clock::now();
+    Mat blob; //variable to store images converted to blob
+    blobFromImages(imgs, blob, 1/255.0, Size(this->width, this->height),Scalar(0,0,0), true, false ); //convert images to blob
+    clock::time_point preprocessed = clock::now();
+
+    net.setInput(blob);
+    std::vector<cv::Mat> net_output; //vector to store predictions
+    net.forward(net_output,unconnected_layers); //run netowrk
+    clock::time_point forwarded = clock::now();
+
+    double decodeTime = 0;
+    double nmsTime = 0;
+    for(size_t b = 0; b < imgs.size(); b++) {
+        clock::time_point decodeStart = clock::now();
+
+        //vectors to store information
+        vector <float> confidences;
+        vector <int> classIDs;
+        vector <cv::Rect> boundingBoxes;
+
+        //a batch comes back as [batch x predictions x values], a single image as [predictions x values]
+        for(size_t i = 0; i < net_output.size(); i++) {
+            const Mat& output = net_output[i];
+            if (output.dims == 3) {
+                Mat slice(output.size[1], output.size[2], CV_32F, (void*)output.ptr<float>(b));
+                decodeOutput(slice, imgs[b].size(), confidences, classIDs, boundingBoxes);
+            }
+            else {
+                int rowsPerImage = output.rows / (int)imgs.size();
+                decodeOutput(output.rowRange(b*rowsPerImage, (b+1)*rowsPerImage), imgs[b].size(), confidences, classIDs, boundingBoxes);
+            }
+        }
+        clock::time_point decoded = clock::now();
+
+        results[b] = suppress(boundingBoxes, confidences, classIDs);
+        clock::time_point suppressed = clock::now();
+
+        decodeTime += elapsedMilliseconds(decodeStart, decoded);
+        nmsTime += elapsedMilliseconds(decoded, suppressed);
+    }
+
+    if (timings != nullptr) {
+        timings->preprocess = elapsedMilliseconds(start, preprocessed);
+        timings->forward = elapsedMilliseconds(preprocessed, forwarded);
+        timings->decode = decodeTime;
+        timings->nms = nmsTime;
+    }
+    return results;
+}
+
+
+
 /**
 * @fn processImage()
 * @brief getter method: extra method so you dont have to process image every time you want to access the list;
@@ -5,6 +5,7 @@
 #include <fstream>
 #include <istream>
 #include <sstream>
+#include <vector>
 
 // opencv
 #include <opencv2/dnn.hpp>
@@ -20,6 +21,17 @@ typedef struct yolo_obj
     float confidence; 
 }yolo_obj;
 
+/*time spent in each stage of processing a frame (or a batch of frames) in milliseconds -
+preprocess - converting the image(s) to a blob, forward - running the network,
+decode - turning the network output into candidate boxes, nms - removing duplicate boxes*/
+typedef struct yolo_timings
+{
+    double preprocess = 0;
+    double forward = 0;
+    double decode = 0;
+    double nms = 0;
+}yolo_timings;
+
 /**
  * @class yolo
  * @brief This class calls the yolo API to send images to the darknet (OPENCV) and receive a vector of yolo_obj 
@@ -37,13 +49,18 @@ class yolo
         std::vector <cv::String> unconnected_layers; //last layer - need this as param for forward() so that the netowrk uses all layers until the last layer
         std::vector <yolo_obj> final_objects_list; //stores the final yolo objects  post-processing
 
+        void decodeOutput(const cv::Mat& output, const cv::Size& imageSize, std::vector<float>& confidences, std::vector<int>& classIDs, std::vector<cv::Rect>& boundingBoxes) const;
+        std::vector<yolo_obj> suppress(const std::vector<cv::Rect>& boundingBoxes, const std::vector<float>& confidences, const std::vector<int>& classIDs) const;
+
     public:
  
         yolo(const cv::String weightsFile, const cv::String classesFile, const cv::String configFile, const int width = 608, const int height = 608, const float confidenceThreshold = 0.5);
         
         ~yolo(); 
 
-        std::vector<yolo_obj> processImage(cv::Mat img);
+        std::vector<yolo_obj> processImage(cv::Mat img, yolo_timings* timings = nullptr);
+
+        std::vector<std::vector<yolo_obj>> processImages(const std::vector<cv::Mat>& imgs, yolo_timings* timings = nullptr);
 
         std::vector<yolo_obj> getYoloObjs();
 
@@ -0,0 +1,434 @@
+//
+//  bench_executor.cpp
+//  TraffikTrak
+//
+//  Created by Matt Lovick on 2026-10-19.
+//  Copyright © 2026 Matt Lovick. All rights reserved.
+//
+
+/*  Benchmark for the TaskPool, the runtime every subsystem submits its work to. Two parts:
+ *
+ *      dispatch    cost per task of an empty task, for post() from outside the pool, submit() with a future, then()
+ *                  with a continuation, and a fan-out where one task posts all the others from inside the pool so the
+ *                  other workers have to steal them. starting a std::thread per task, which is what the subsystems did
+ *                  before, is measured once for comparison
+ *      workloads   the database work the subsystems hand to the pool: logging a batch of scores into every intersection
+ *                  database, and calculating the averages of every intersection database, as a TrafficDatabase does it.
+ *                  run once per round with a thread per database, and once per round on the pool
+ *
+ *  every part is run with 1, 2, 4, ... max threads. results are printed as a table and written as JSON so two builds can be diffed.
+ *
+ *  usage: bench_executor [-t max_threads] [-n tasks] [-d databases] [-s scores_per_round] [-r rounds] [-o output.json]
+ */
+
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <iomanip>
+#include <string>
+#include <vector>
+#include <map>
+#include <thread>
+#include <mutex>
+#include <atomic>
+#include <chrono>
+#include <future>
+#include <memory>
+#include <functional>
+#include <algorithm>
+#include <ctime>
+#include "TaskPool.hpp"
+#include "IntersectionDatabase.hpp"
+#include "DateScorePair.hpp"
+#include "CongestionScore.hpp"
+
+using namespace std;
+using namespace std::chrono;
+using namespace traffictrack;
+
+typedef steady_clock bench_clock;
+
+
+/** @struct BenchOptions
+ *  @brief command line options of the benchmark
+ */
+struct BenchOptions {
+    int maxThreads = max(1, static_cast<int>(thread::hardware_concurrency()));
+    int tasks = 200000;
+    int databases = 64;
+    int scoresPerRound = 128;
+    int rounds = 10;
+    string output = "bench_executor.json";
+};
+
+
+/** @struct RunResult
+ *  @brief result of one part of the benchmark at one thread count
+ */
+struct RunResult {
+    string name;
+    int threads;
+    long long operations; /**< tasks, or rounds for the workloads */
+    double seconds;
+    double nanosecondsPerOperation;
+    long long steals;
+};
+
+
+/** @fn steps(int maximum)
+ *  @brief the values 1, 2, 4, ... up to and always including maximum
+ *  @param maximum the largest value
+ *  @return vector<int>
+ */
+static vector<int> steps(int maximum) {
+
+    vector<int> values;
+    for (int i = 1; i < maximum; i *= 2) {
+        values.push_back(i);
+    }
+    values.push_back(maximum);
+    return values;
+
+}
+
+
+/** @fn parseOptions(int argc, const char* argv[], BenchOptions& options)
+ *  @brief reads the flag/value pairs from the command line
+ *  @return bool whether or not the arguments were valid
+ */
+static bool parseOptions(int argc, const char* argv[], BenchOptions& options) {
+
+    map<string, int*> integers = {
+        { "-t", &options.maxThreads }, { "-n", &options.tasks }, { "-d", &options.databases },
+        { "-s", &options.scoresPerRound }, { "-r", &options.rounds }
+    };
+
+    for (int i = 1; i + 1 < argc; i += 2) {
+
+        string flag = argv[i];
+        if (flag == "-o") {
+            options.output = argv[i+1];
+        }
+        else if (integers.find(flag) != integers.end()) {
+            istringstream ss(argv[i+1]);
+            if (!(ss >> *integers[flag]) || *integers[flag] <= 0) {
+                cerr << "invalid value for " << flag << endl;
+                return false;
+            }
+        }
+        else {
+            cerr << "invalid argument type: " << flag << endl;
+            return false;
+        }
+
+    }
+
+    return argc % 2 == 1;
+
+}
+
+
+/** @fn result(const string& name, int threads, long long operations, bench_clock::time_point start, long long steals)
+ *  @brief builds the result of a run that started at start and just finished
+ *  @return RunResult
+ */
+static RunResult result(const string& name, int threads, long long operations, bench_clock::time_point start, long long steals) {
+
+    RunResult r;
+    r.name = name;
+    r.threads = threads;
+    r.operations = operations;
+    r.seconds = duration<double>(bench_clock::now() - start).count();
+    r.nanosecondsPerOperation = operations > 0 ? r.seconds * 1e9 / operations : 0;
+    r.steals = steals;
+    return r;
+
+}
+
+
+/** @fn runDispatch(int threads, int tasks, vector<RunResult>& results)
+ *  @brief measures the cost of dispatching empty tasks on a pool of the given size
+ */
+static void runDispatch(int threads, int tasks, vector<RunResult>& results) {
+
+    TaskPool pool(threads);
+
+    //post: no future, the last task to finish releases the caller
+    {
+        atomic<int> remaining(tasks);
+        promise<void> done;
+        bench_clock::time_point start = bench_clock::now();
+        for (int i = 0; i < tasks; i++) {
+            pool.post([&]() {
+                if (--remaining == 0) {
+                    done.set_value();
+                }
+            });
+        }
+        done.get_future().wait();
+        results.push_back(result("post", threads, tasks, start, pool.steals()));
+    }
+
+    //submit: one future per task
+    {
+        long long steals = pool.steals();
+        vector<future<int>> futures;
+        futures.reserve(tasks);
+        bench_clock::time_point start = bench_clock::now();
+        for (int i = 0; i < tasks; i++) {
+            futures.push_back(pool.submit([i]() { return i; }));
+        }
+        for (future<int>& f : futures) {
+            f.get();
+        }
+        results.push_back(result("submit", threads, tasks, start, pool.steals() - steals));
+    }
+
+    //then: a task and its continuation count as two tasks
+    {
+        long long steals = pool.steals();
+        vector<future<int>> futures;
+        futures.reserve(tasks / 2);
+        bench_clock::time_point start = bench_clock::now();
+        for (int i = 0; i < tasks / 2; i++) {
+            futures.push_back(pool.then([i]() { return i; }, [](future<int> previous) { return previous.get() + 1; }));
+        }
+        for (future<int>& f : futures) {
+            f.get();
+        }
+        results.push_back(result("then", threads, (tasks / 2) * 2, start, pool.steals() - steals));
+    }
+
+    //fan-out: every task lands in one worker's deque, the others only get work by stealing
+    {
+        long long steals = pool.steals();
+        atomic<int> remaining(tasks);
+        promise<void> done;
+        bench_clock::time_point start = bench_clock::now();
+        pool.post([&]() {
+            for (int i = 0; i < tasks; i++) {
+                pool.post([&]() {
+                    if (--remaining == 0) {
+                        done.set_value();
+                    }
+                });
+            }
+        });
+        done.get_future().wait();
+        results.push_back(result("fan-out", threads, tasks, start, pool.steals() - steals));
+    }
+
+}
+
+
+/** @fn runThreadPerTask(int tasks, vector<RunResult>& results)
+ *  @brief measures starting and joining a thread for every empty task
+ */
+static void runThreadPerTask(int tasks, vector<RunResult>& results) {
+
+    bench_clock::time_point start = bench_clock::now();
+    for (int i = 0; i < tasks; i++) {
+        thread* t = new thread([]() { });
+        t->join();
+        delete t;
+    }
+    results.push_back(result("thread-per-task", 1, tasks, start, 0));
+
+}
+
+
+/** @fn makeBatch(int scores, int round)
+ *  @brief scores spread over the time blocks of the day, a different hour every round
+ *  @return vector<DateScorePair>
+ */
+static vector<DateScorePair> makeBatch(int scores, int round) {
+
+    CongestionScore score;
+    score.setNorth(10, 10, 10);
+    score.setEast(10, 10, 10);
+    score.setSouth(10, 10, 10);
+    score.setWest(10, 10, 10);
+
+    vector<DateScorePair> batch;
+    batch.reserve(scores);
+    time_t now = time(NULL);
+    char buffer[32];
+    for (int i = 0; i < scores; i++) {
+        time_t stamp = now + round * 3600 + i * 3;
+        batch.push_back(DateScorePair(ctime_r(&stamp, buffer), score));
+    }
+    return batch;
+
+}
+
+
+/** @fn runWorkloads(const vector<IntersectionDatabase*>& databases, TaskPool* pool, int threads, const BenchOptions& options, vector<RunResult>& results)
+ *  @brief logs a batch into every database and calculates the averages of every database, on the pool or with a thread per
+ *      database when pool is nullptr
+ */
+static void runWorkloads(const vector<IntersectionDatabase*>& databases, TaskPool* pool, int threads, const BenchOptions& options, vector<RunResult>& results) {
+
+    string suffix = pool == nullptr ? " (thread per database)" : "";
+    long long steals = pool == nullptr ? 0 : pool->steals();
+
+    //every database gets its own copy of the batch, built before the clock starts
+    vector<vector<vector<DateScorePair>>> batches(options.rounds);
+    for (int round = 0; round < options.rounds; round++) {
+        vector<DateScorePair> batch = makeBatch(options.scoresPerRound, round);
+        batches[round].assign(databases.size(), batch);
+    }
+
+    bench_clock::time_point start = bench_clock::now();
+    for (int round = 0; round < options.rounds; round++) {
+
+        if (pool == nullptr) {
+            vector<thread*> workers;
+            for (size_t i = 0; i < databases.size(); i++) {
+                workers.push_back(new thread(&IntersectionDatabase::logBatch, databases[i], std::ref(batches[round][i])));
+            }
+            for (thread* t : workers) {
+                t->join();
+                delete t;
+            }
+        }
+        else {
+            vector<future<int>> logged;
+            for (size_t i = 0; i < databases.size(); i++) {
+                IntersectionDatabase* database = databases[i];
+                vector<DateScorePair>* batch = &batches[round][i];
+                logged.push_back(pool->submit([database, batch]() { return database->logBatch(*batch); }, TaskPool::LOW));
+            }
+            for (future<int>& f : logged) {
+                f.get();
+            }
+        }
+
+    }
+    results.push_back(result("log" + suffix, threads, options.rounds, start, pool == nullptr ? 0 : pool->steals() - steals));
+
+    steals = pool == nullptr ? 0 : pool->steals();
+    start = bench_clock::now();
+    for (int round = 0; round < options.rounds; round++) {
+
+        vector<future<AverageCongestionScores>> averages;
+        vector<thread*> workers;
+
+        for (IntersectionDatabase* database : databases) {
+            shared_ptr<promise<AverageCongestionScores>> p = make_shared<promise<AverageCongestionScores>>();
+            averages.push_back(p->get_future());
+            if (pool == nullptr) {
+                workers.push_back(new thread([database, p]() { database->calculateAverages(std::move(*p)); }));
+            }
+            else {
+                pool->post([database, p]() { database->calculateAverages(std::move(*p)); });
+            }
+        }
+
+        for (future<AverageCongestionScores>& f : averages) {
+            f.get();
+        }
+        for (thread* t : workers) {
+            t->join();
+            delete t;
+        }
+
+    }
+    results.push_back(result("averages" + suffix, threads, options.rounds, start, pool == nullptr ? 0 : pool->steals() - steals));
+
+}
+
+
+/** @fn printTable(const vector<RunResult>& results)
+ *  @brief prints the cost per operation of every run
+ */
+static void printTable(const vector<RunResult>& results) {
+
+    cout << left << setw(34) << "run" << setw(9) << "threads" << setw(12) << "ops" << setw(12) << "seconds" << setw(14) << "ns/op" << setw(10) << "steals" << endl;
+
+    cout << fixed << setprecision(2);
+    for (const RunResult& r : results) {
+        cout << left << setw(34) << r.name << setw(9) << r.threads << setw(12) << r.operations << setw(12) << r.seconds
+             << setw(14) << r.nanosecondsPerOperation << setw(10) << r.steals << endl;
+    }
+
+}
+
+
+/** @fn writeJson(const string& filename, const BenchOptions& options, const vector<RunResult>& results)
+ *  @brief writes the results to a JSON file so runs of different builds can be diffed
+ *  @return bool whether or not the file was written
+ */
+static bool writeJson(const string& filename, const BenchOptions& options, const vector<RunResult>& results) {
+
+    ofstream out(filename);
+    if (!out.is_open()) {
+        return false;
+    }
+
+    out << fixed << setprecision(4);
+    out << "{" << endl;
+    out << "  \"tasks\": " << options.tasks << "," << endl;
+    out << "  \"databases\": " << options.databases << "," << endl;
+    out << "  \"scores_per_round\": " << options.scoresPerRound << "," << endl;
+    out << "  \"rounds\": " << options.rounds << "," << endl;
+    out << "  \"unit\": \"ns\"," << endl;
+    out << "  \"runs\": [" << endl;
+
+    for (size_t i = 0; i < results.size(); i++) {
+        const RunResult& r = results[i];
+        out << "    { \"run\": \"" << r.name << "\", \"threads\": " << r.threads << ", \"operations\": " << r.operations
+            << ", \"seconds\": " << r.seconds << ", \"ns_per_operation\": " << r.nanosecondsPerOperation << ", \"steals\": " << r.steals << " }"
+            << (i + 1 < results.size() ? "," : "") << endl;
+    }
+
+    out << "  ]" << endl;
+    out << "}" << endl;
+    return true;
+
+}
+
+
+int main(int argc, const char * argv[]) {
+
+    BenchOptions options;
+    if (!parseOptions(argc, argv, options)) {
+        cerr << "usage: bench_executor [-t max_threads] [-n tasks] [-d databases] [-s scores_per_round] [-r rounds] [-o output.json]" << endl;
+        return 1;
+    }
+
+    vector<RunResult> results;
+
+    runThreadPerTask(min(options.tasks, 2000), results);
+    for (int threads : steps(options.maxThreads)) {
+        runDispatch(threads, options.tasks, results);
+    }
+
+    //the databases are loaded once, loading reads their files and is not part of any measurement
+    vector<IntersectionDatabase*> databases;
+    for (int i = 0; i < options.databases; i++) {
+        IntersectionDatabase* database = IntersectionDatabase::create(IntersectionID(i), TimeBlock(3), TempFile("bench_temp_file"), DatabaseLocation("BenchDatabase"), PredictionLevel(64));
+        if (database != nullptr) {
+            databases.push_back(database);
+        }
+    }
+
+    runWorkloads(databases, nullptr, static_cast<int>(databases.size()), options, results);
+    for (int threads : steps(options.maxThreads)) {
+        TaskPool pool(threads);
+        runWorkloads(databases, &pool, threads, options, results);
+    }
+
+    printTable(results);
+
+    if (!writeJson(options.output, options, results)) {
+        cerr << "could not write " << options.output << endl;
+    }
+    else {
+        cout << "results written to " << options.output << endl;
+    }
+
+    //the databases are not deleted, deleting one writes its cache to disk
+
+    return 0;
+
+}
@@ -0,0 +1,739 @@
+//
+//  bench_routing.cpp
+//  TraffikTrak
+//
+//  Created by Matt Lovick on 2026-10-19.
+//  Copyright © 2026 Matt Lovick. All rights reserved.
+//
+
+/*  Benchmark for the emergency vehicle routing. Makes up cities of growing size (100, 400, 1600, ... intersections) in
+ *  every layout of MapGenerator, writes each one in both map file formats next to the JSON output and reads it back with
+ *  QuickMapFileParser and ExplicitMapFileParser. For every map it reports:
+ *
+ *      parse       the time each parser takes to read the map file, and the file size. the scan is a MapFileReader pass
+ *                  over the same file that reads every number without making the map, and its rate on the largest map
+ *                  of each layout is printed first as the parse rate. the rest of a parse is mostly the cost of
+ *                  constructing the intersections
+ *      graph       the time to take the RoadGraph snapshot of the map, that the path finders search, and its size
+ *      rss         the most memory the process has used so far
+ *
+ *  and for every path finder:
+ *
+ *      prepare     the time the path finder needs before the first alert (AbstractPathFinder::prepare()), snapshot included
+ *      memory      what the path finder keeps between searches (AbstractPathFinder::memory())
+ *      alert       the time from an alert to the first light that has to be preempted: the search, then the same walk along
+ *                  the path as Controller::preemptLights() up to the first intersection whose light is not green for
+ *                  the vehicle. the lights themselves are not changed, that takes seconds of yellow light
+ *      expanded    the mean number of intersections a search expanded, for UniformCostSearch, AStarSearch and
+ *                  ContractionHierarchySearch
+ *      burst       alerts per second when all of them arrive at once: one after the other as above, and as one
+ *                  AbstractPathFinder::searchBatch() on the shared TaskPool followed by the walks, the way
+ *                  Controller::handleEmergencyAlerts() handles a burst. routes of the batch that differ in length from
+ *                  the ones found one at a time are counted
+ *
+ *  ContractionHierarchySearch runs twice on every map: first it builds its hierarchy and saves it next to the JSON output,
+ *  then a second one loads it from there, so the prepare time of the second is the cost of reading the cache.
+ *
+ *  the alerts start at the same random intersections for every path finder, and the sum of the route lengths is printed
+ *  so the path finders can be checked against each other. every route is also compared with the one UniformCostSearch
+ *  found from the same start, and the routes whose length differs are counted.
+ *
+ *  on every map, HospitalRouteTree then takes batches of random congestion scores the way Controller::handleDataLogRequests()
+ *  passes them on, and the time it takes to repair its tree is compared with building a new one with the same delays. the
+ *  distances of the repaired tree are checked against the new one. results are printed as tables and written as JSON.
+ *
+ *  usage: bench_routing [-n max_intersections] [-k grid,radial,planar] [-l lengths] [-q alerts] [-h hospitals_per_1000]
+ *                       [-s seed] [-t threads] [-b congestion_batches] [-u scores_per_batch] [-o output.json]
+ *
+ *  the lengths are given like for gen_map: straight[:detour], uniform:min:max or exponential:min:mean
+ */
+
+#include <iostream>
+#include <fstream>
+#include <iomanip>
+#include <string>
+#include <vector>
+#include <unordered_map>
+#include <utility>
+#include <chrono>
+#include <random>
+#include <algorithm>
+#include <cstdlib>
+#include <cstdio>
+#include <cmath>
+#include <sstream>
+#include <sys/resource.h>
+#include "Intersection.hpp"
+#include "IntersectionID.h"
+#include "Direction.h"
+#include "LightColour.h"
+#include "Road.hpp"
+#include "CongestionScore.hpp"
+#include "DateScorePair.hpp"
+#include "AbstractPathFinder.hpp"
+#include "UniformCostSearch.hpp"
+#include "AStarSearch.hpp"
+#include "ContractionHierarchySearch.hpp"
+#include "HospitalRouteTree.hpp"
+#include "RoadGraph.hpp"
+#include "TaskPool.hpp"
+#include "MapGenerator.hpp"
+#include "MapFileReader.hpp"
+#include "QuickMapFileParser.hpp"
+#include "ExplicitMapFileParser.hpp"
+#include "BaseException.hpp"
+#include "IOException.hpp"
+
+using namespace std;
+using namespace std::chrono;
+using namespace traffictrack;
+
+typedef steady_clock bench_clock;
+typedef pair<IntersectionID, DateScorePair> CongestionRecord;
+
+
+/** @struct BenchOptions
+ *  @brief command line options of the benchmark
+ */
+struct BenchOptions {
+    int maxIntersections = 40000;
+    vector<string> layouts = { "grid", "radial", "planar" };
+    MapGenerator::Settings map; /**< the lengths of the roads, the rest is set for every map */
+    int alerts = 2000;
+    int hospitalsPerThousand = 2;
+    unsigned seed = 42;
+    int threads = 0;
+    int batches = 20;
+    int batchSize = 256;
+    string output = "bench_routing.json";
+};
+
+
+/** @struct MapResult
+ *  @brief size of one map, the time it takes to read and the cost of its RoadGraph snapshot
+ */
+struct MapResult {
+    string layout;
+    int intersections;
+    int roads;
+    int hospitals;
+    size_t fileBytes; /**< of the QuickMapFileParser file */
+    double scanMilliseconds; /**< MapFileReader alone over the QuickMapFileParser file */
+    double quickMilliseconds; /**< QuickMapFileParser::parse() */
+    double explicitMilliseconds; /**< ExplicitMapFileParser::parse() */
+    double buildMilliseconds;
+    size_t bytes;
+    double maxResidentMegabytes; /**< of the whole process so far */
+};
+
+
+/** @struct RunResult
+ *  @brief result of one path finder on one map
+ */
+struct RunResult {
+    string name;
+    string layout;
+    int intersections;
+    double prepareMilliseconds;
+    size_t memoryBytes;
+    long long alerts;
+    double meanMicroseconds;
+    double p50Microseconds;
+    double p90Microseconds;
+    double p99Microseconds;
+    double maxMicroseconds;
+    double meanExpanded; /**< intersections expanded per search, -1 if the path finder does not count them */
+    double routeLengthSum; /**< sum of the lengths of every route found, equal for path finders that agree */
+    long long unreachable; /**< alerts without a route to a hospital */
+    long long preempted; /**< alerts that found a light to change */
+    double serialPerSecond; /**< alerts handled one after the other */
+    double batchPerSecond; /**< alerts handled as one batch */
+    long long batchMismatches; /**< routes of the batch whose length differs from the one found alone */
+    long long mismatches; /**< routes whose length differs from the one UniformCostSearch found from the same start */
+};
+
+
+/** @struct CongestionResult
+ *  @brief cost of repairing the HospitalRouteTree of one map after congestion scores come in
+ */
+struct CongestionResult {
+    string layout;
+    int intersections;
+    int batches;
+    int batchSize;
+    double meanMicroseconds; /**< per batch */
+    double p99Microseconds;
+    double rebuildMilliseconds; /**< building a new tree with the same delays */
+    long long mismatches; /**< intersections whose repaired distance differs from the new tree */
+};
+
+
+/** @fn parseOptions(int argc, const char* argv[], BenchOptions& options)
+ *  @brief reads the command line options
+ *  @return bool false if an option is unknown or its value is missing
+ */
+static bool parseOptions(int argc, const char* argv[], BenchOptions& options) {
+
+    for (int i = 1; i < argc; i++) {
+
+        string flag = argv[i];
+        if (i + 1 >= argc) {
+            return false;
+        }
+        string value = argv[++i];
+
+        if (flag == "-n") {
+            options.maxIntersections = max(4, atoi(value.c_str()));
+        }
+        else if (flag == "-k") {
+            options.layouts.clear();
+            istringstream names(value);
+            string name;
+            MapGenerator::Layout layout;
+            while (getline(names, name, ',')) {
+                if (!MapGenerator::parseLayout(name, layout)) {
+                    return false;
+                }
+                options.layouts.push_back(name);
+            }
+        }
+        else if (flag == "-l") {
+            if (!MapGenerator::parseLengths(value, options.map)) {
+                return false;
+            }
+        }
+        else if (flag == "-q") {
+            options.alerts = max(1, atoi(value.c_str()));
+        }
+        else if (flag == "-h") {
+            options.hospitalsPerThousand = max(0, atoi(value.c_str()));
+        }
+        else if (flag == "-s") {
+            options.seed = static_cast<unsigned>(atoi(value.c_str()));
+        }
+        else if (flag == "-t") {
+            options.threads = max(0, atoi(value.c_str()));
+        }
+        else if (flag == "-b") {
+            options.batches = max(1, atoi(value.c_str()));
+        }
+        else if (flag == "-u") {
+            options.batchSize = max(1, atoi(value.c_str()));
+        }
+        else if (flag == "-o") {
+            options.output = value;
+        }
+        else {
+            return false;
+        }
+
+    }
+
+    return true;
+
+}
+
+
+/** @fn scanMap(const std::string& filename)
+ *  @brief reads every line of a map file with MapFileReader, numbers as numbers and the rest as words, without making
+ *      the map
+ *  @return double milliseconds
+ */
+static double scanMap(const string& filename) {
+
+    bench_clock::time_point start = bench_clock::now();
+
+    MapFileReader reader(filename);
+    float number = 0, sum = 0;
+    const char* word = nullptr;
+    size_t length = 0, letters = 0;
+
+    while (reader.nextLine()) {
+        while (!reader.blank()) {
+            if (reader.readFloat(number)) {
+                sum += number;
+            }
+            else if (reader.readWord(word, length)) {
+                letters += length;
+            }
+        }
+    }
+
+    double milliseconds = duration_cast<nanoseconds>(bench_clock::now() - start).count() / 1e6;
+
+    //so the reads cannot be left out, the sink is read back once so it is not only ever written
+    static volatile size_t sink = 0;
+    sink = letters + static_cast<size_t>(sum);
+    (void)sink;
+
+    return milliseconds;
+
+}
+
+
+/** @fn loadMap(const std::string& layout, int wanted, const BenchOptions& options, std::unordered_map<IntersectionID, Intersection*>& intersections)
+ *  @brief makes up a map, writes it in both formats and times reading it back with both parsers
+ *  @param layout the name of the MapGenerator layout
+ *  @param wanted about how many intersections
+ *  @param options the lengths, the hospital density, the seed and where to put the map files
+ *  @param intersections filled with the map read by QuickMapFileParser, the caller deletes them
+ *  @return MapResult
+ */
+static MapResult loadMap(const string& layout, int wanted, const BenchOptions& options, unordered_map<IntersectionID, Intersection*>& intersections) {
+
+    MapGenerator::Settings settings = options.map;
+    MapGenerator::parseLayout(layout, settings.layout);
+    settings.intersections = wanted;
+    settings.hospitalsPerThousand = options.hospitalsPerThousand;
+    settings.seed = options.seed + wanted;
+
+    MapGenerator generator(settings);
+    generator.generate();
+
+    const string quickFile = options.output + ".quick.txt";
+    const string explicitFile = options.output + ".explicit.txt";
+    if (!generator.writeQuick(quickFile) || !generator.writeExplicit(explicitFile)) {
+        throw IOException("could not write the map files next to " + options.output);
+    }
+
+    MapResult result;
+    result.layout = layout;
+    result.hospitals = static_cast<int>(generator.hospitals().size());
+    result.fileBytes = static_cast<size_t>(ifstream(quickFile, ios::binary | ios::ate).tellg());
+
+    result.scanMilliseconds = scanMap(quickFile);
+
+    unordered_map<IntersectionID, Intersection*> explicitMap;
+    bench_clock::time_point start = bench_clock::now();
+    ExplicitMapFileParser().parse(explicitFile, explicitMap);
+    result.explicitMilliseconds = duration_cast<nanoseconds>(bench_clock::now() - start).count() / 1e6;
+    for (auto it = explicitMap.begin(); it != explicitMap.end(); ++it) {
+        delete it->second;
+    }
+
+    start = bench_clock::now();
+    QuickMapFileParser().parse(quickFile, intersections);
+    result.quickMilliseconds = duration_cast<nanoseconds>(bench_clock::now() - start).count() / 1e6;
+
+    remove(quickFile.c_str());
+    remove(explicitFile.c_str());
+
+    start = bench_clock::now();
+    RoadGraph graph(intersections);
+    result.buildMilliseconds = duration_cast<nanoseconds>(bench_clock::now() - start).count() / 1e6;
+    result.intersections = graph.size();
+    result.roads = graph.roads();
+    result.bytes = graph.memory();
+
+    struct rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+    result.maxResidentMegabytes = usage.ru_maxrss / 1024.0; //kilobytes on linux
+
+    return result;
+
+}
+
+
+/** @fn firstPreemption(const std::vector<Intersection*>& path)
+ *  @brief walks the route like Controller::preemptLights() and stops at the first light it would change
+ *  @param path the route
+ *  @return Intersection* the intersection whose lights would be changed first, nullptr if every light is already green
+ */
+static Intersection* firstPreemption(const vector<Intersection*>& path) {
+
+    for (size_t i = 1; i < path.size(); i++) {
+
+        Direction direction = Direction::DEFAULT;
+        for (const Road& r : path[i - 1]->neighbors()) {
+            if (r.secondIntersection() == path[i]) {
+                direction = r.direction();
+                break;
+            }
+        }
+
+        if (direction != Direction::DEFAULT) {
+            LightColour colour = (direction == Direction::NORTH || direction == Direction::SOUTH) ? path[i]->northSouthColour() : path[i]->eastWestColour();
+            if (colour != LightColour::GREEN) {
+                return path[i];
+            }
+        }
+
+    }
+
+    return nullptr;
+
+}
+
+
+/** @fn percentile(const std::vector<double>& sorted, double fraction)
+ *  @brief the value below which the given fraction of the sorted samples lie
+ */
+static double percentile(const vector<double>& sorted, double fraction) {
+
+    if (sorted.empty()) {
+        return 0;
+    }
+    size_t index = min(sorted.size() - 1, static_cast<size_t>(fraction * sorted.size()));
+    return sorted[index];
+
+}
+
+
+/** @fn sameLength(float found, float expected)
+ *  @brief whether two route lengths agree up to float rounding, -1 for no route only matches itself
+ */
+static bool sameLength(float found, float expected) {
+    return fabs(found - expected) <= 1e-3f * max(1.0f, expected);
+}
+
+
+/** @fn runAlerts(const std::string& name, AbstractPathFinder* finder, std::unordered_map<IntersectionID, Intersection*>& intersections, const std::vector<Intersection*>& sources, std::vector<float>& reference)
+ *  @brief prepares one path finder on a map and times an alert from every source
+ *  @param reference the route lengths the routes are checked against, filled with the ones found here if it is empty
+ *  @return RunResult
+ */
+static RunResult runAlerts(const string& name, AbstractPathFinder* finder, unordered_map<IntersectionID, Intersection*>& intersections, const vector<Intersection*>& sources, vector<float>& reference) {
+
+    RunResult result;
+    result.name = name;
+    result.intersections = static_cast<int>(intersections.size());
+    result.alerts = static_cast<long long>(sources.size());
+    result.routeLengthSum = 0;
+    result.unreachable = 0;
+
+    bench_clock::time_point start = bench_clock::now();
+    finder->prepare(intersections);
+    result.prepareMilliseconds = duration_cast<nanoseconds>(bench_clock::now() - start).count() / 1e6;
+
+    vector<double> latencies;
+    latencies.reserve(sources.size());
+    result.preempted = 0;
+
+    UniformCostSearch* counting = dynamic_cast<UniformCostSearch*>(finder);
+    ContractionHierarchySearch* climbing = dynamic_cast<ContractionHierarchySearch*>(finder);
+    long long expanded = 0;
+    vector<float> lengths;
+    lengths.reserve(sources.size());
+
+    bench_clock::time_point serial = bench_clock::now();
+    for (Intersection* source : sources) {
+
+        bench_clock::time_point alert = bench_clock::now();
+        pair<vector<Intersection*>, float> path = finder->search(source, intersections);
+        Intersection* first = path.second > 0 ? firstPreemption(path.first) : nullptr;
+        latencies.push_back(duration_cast<nanoseconds>(bench_clock::now() - alert).count() / 1e3);
+
+        if (counting != nullptr) {
+            expanded += counting->expanded();
+        }
+        else if (climbing != nullptr) {
+            expanded += climbing->expanded();
+        }
+
+        if (path.second < 0) {
+            result.unreachable++;
+        }
+        else {
+            result.routeLengthSum += path.second;
+        }
+        if (first != nullptr) {
+            result.preempted++;
+        }
+        lengths.push_back(path.second);
+
+    }
+    double serialSeconds = duration_cast<nanoseconds>(bench_clock::now() - serial).count() / 1e9;
+
+    //the same alerts as one burst
+    bench_clock::time_point batch = bench_clock::now();
+    vector<pair<vector<Intersection*>, float>> paths = finder->searchBatch(sources, intersections);
+    for (const pair<vector<Intersection*>, float>& path : paths) {
+        if (path.second > 0) {
+            firstPreemption(path.first);
+        }
+    }
+    double batchSeconds = duration_cast<nanoseconds>(bench_clock::now() - batch).count() / 1e9;
+
+    result.serialPerSecond = serialSeconds > 0 ? sources.size() / serialSeconds : 0;
+    result.batchPerSecond = batchSeconds > 0 ? sources.size() / batchSeconds : 0;
+    result.batchMismatches = 0;
+    result.memoryBytes = finder->memory();
+    for (size_t i = 0; i < paths.size(); i++) {
+        if (!sameLength(paths[i].second, lengths[i])) {
+            result.batchMismatches++;
+        }
+    }
+
+    if (reference.empty()) {
+        reference = lengths;
+    }
+    result.mismatches = 0;
+    for (size_t i = 0; i < lengths.size(); i++) {
+        if (!sameLength(lengths[i], reference[i])) {
+            result.mismatches++;
+        }
+    }
+
+    double total = 0;
+    for (double latency : latencies) {
+        total += latency;
+    }
+    sort(latencies.begin(), latencies.end());
+
+    result.meanMicroseconds = latencies.empty() ? 0 : total / latencies.size();
+    result.p50Microseconds = percentile(latencies, 0.50);
+    result.p90Microseconds = percentile(latencies, 0.90);
+    result.p99Microseconds = percentile(latencies, 0.99);
+    result.maxMicroseconds = latencies.empty() ? 0 : latencies.back();
+    result.meanExpanded = (counting != nullptr || climbing != nullptr) && !sources.empty() ? static_cast<double>(expanded) / sources.size() : -1;
+
+    return result;
+
+}
+
+
+/** @fn runCongestion(std::unordered_map<IntersectionID, Intersection*>& intersections, const BenchOptions& options)
+ *  @brief passes batches of random congestion scores to a HospitalRouteTree, and checks the repaired tree against a new one
+ *  @return CongestionResult
+ */
+static CongestionResult runCongestion(unordered_map<IntersectionID, Intersection*>& intersections, const BenchOptions& options) {
+
+    CongestionResult result;
+    result.intersections = static_cast<int>(intersections.size());
+    result.batches = options.batches;
+    result.batchSize = options.batchSize;
+
+    HospitalRouteTree tree;
+    tree.prepare(intersections);
+
+    //most intersections are quiet, a few are backed up past the point where more vehicles make no difference
+    mt19937 random(options.seed + 1);
+    uniform_int_distribution<int> pick(0, result.intersections - 1);
+    uniform_int_distribution<int> quiet(0, 2);
+    uniform_int_distribution<int> busy(0, 12);
+    bernoulli_distribution backedUp(0.2);
+
+    vector<CongestionRecord> all;
+    vector<double> latencies;
+
+    for (int b = 0; b < options.batches; b++) {
+
+        vector<CongestionRecord> batch;
+        for (int i = 0; i < options.batchSize; i++) {
+            uniform_int_distribution<int>& lane = backedUp(random) ? busy : quiet;
+            CongestionScore score;
+            score.setNorth(lane(random), lane(random), lane(random));
+            score.setSouth(lane(random), lane(random), lane(random));
+            score.setEast(lane(random), lane(random), lane(random));
+            score.setWest(lane(random), lane(random), lane(random));
+            batch.push_back(CongestionRecord(IntersectionID(pick(random)), DateScorePair("", score)));
+        }
+
+        bench_clock::time_point start = bench_clock::now();
+        tree.updateCongestion(batch, intersections);
+        latencies.push_back(duration_cast<nanoseconds>(bench_clock::now() - start).count() / 1e3);
+
+        all.insert(all.end(), batch.begin(), batch.end());
+
+    }
+
+    //a tree that has not been built yet keeps the delays and builds with them
+    HospitalRouteTree fresh;
+    bench_clock::time_point start = bench_clock::now();
+    fresh.updateCongestion(all, intersections);
+    result.rebuildMilliseconds = duration_cast<nanoseconds>(bench_clock::now() - start).count() / 1e6;
+
+    result.mismatches = 0;
+    for (auto it = intersections.begin(); it != intersections.end(); ++it) {
+        float repaired = tree.distance(it->second);
+        float built = fresh.distance(it->second);
+        if (fabs(repaired - built) > 1e-4 * max(1.0f, built)) {
+            result.mismatches++;
+        }
+    }
+
+    double total = 0;
+    for (double latency : latencies) {
+        total += latency;
+    }
+    sort(latencies.begin(), latencies.end());
+    result.meanMicroseconds = total / latencies.size();
+    result.p99Microseconds = percentile(latencies, 0.99);
+
+    return result;
+
+}
+
+
+/** @fn printTable(const std::vector<MapResult>& maps, const std::vector<RunResult>& results, const std::vector<CongestionResult>& congestion)
+ *  @brief prints the results as tables
+ */
+static void printTable(const vector<MapResult>& maps, const vector<RunResult>& results, const vector<CongestionResult>& congestion) {
+
+    //the headline parse rate is the file alone, on the largest map of each layout. the quick parse next to it also
+    //constructs every Intersection, which is most of its time
+    for (size_t i = 0; i < maps.size(); i++) {
+        const MapResult& m = maps[i];
+        if (i + 1 < maps.size() && maps[i + 1].layout == m.layout) {
+            continue;
+        }
+        double megabytes = m.fileBytes / (1024.0*1024.0);
+        cout << left << setw(10) << m.layout << right << "map file read at " << fixed << setprecision(1) << (m.scanMilliseconds > 0 ? megabytes / (m.scanMilliseconds / 1000) : 0)
+             << " MB/s (" << megabytes << " MB, " << m.intersections << " intersections), quick parse with the intersections "
+             << (m.quickMilliseconds > 0 ? megabytes / (m.quickMilliseconds / 1000) : 0) << " MB/s" << endl;
+    }
+    cout << endl;
+
+    cout << left << setw(10) << "layout" << right << setw(12) << "nodes" << setw(12) << "roads" << setw(12) << "hospitals" << setw(12) << "file MB"
+         << setw(12) << "scan MB/s" << setw(12) << "quick ms" << setw(12) << "quick MB/s" << setw(14) << "explicit ms" << setw(12) << "graph ms" << setw(12) << "graph MB" << setw(12) << "max rss MB" << endl;
+    for (const MapResult& m : maps) {
+        double megabytes = m.fileBytes / (1024.0*1024.0);
+        cout << left << setw(10) << m.layout << right << setw(12) << m.intersections << setw(12) << m.roads << setw(12) << m.hospitals
+             << fixed << setprecision(2) << setw(12) << megabytes << setw(12) << (m.scanMilliseconds > 0 ? megabytes / (m.scanMilliseconds / 1000) : 0) << setw(12) << m.quickMilliseconds << setw(12) << (m.quickMilliseconds > 0 ? megabytes / (m.quickMilliseconds / 1000) : 0)
+             << setw(14) << m.explicitMilliseconds << setw(12) << m.buildMilliseconds << setw(12) << m.bytes / (1024.0*1024.0) << setw(12) << m.maxResidentMegabytes << endl;
+    }
+    cout << endl;
+
+    cout << left << setw(30) << "path finder" << setw(10) << "layout" << right << setw(12) << "nodes" << setw(14) << "prepare ms" << setw(12) << "memory MB"
+         << setw(12) << "mean us" << setw(12) << "p50 us" << setw(12) << "p90 us" << setw(12) << "p99 us" << setw(12) << "max us" << setw(12) << "expanded"
+         << setw(18) << "route sum" << setw(12) << "no route" << setw(12) << "preempted" << setw(12) << "serial/s" << setw(12) << "batch/s" << setw(12) << "batch diff" << setw(12) << "mismatch" << endl;
+
+    for (const RunResult& r : results) {
+        cout << left << setw(30) << r.name << setw(10) << r.layout << right << setw(12) << r.intersections << fixed << setprecision(2) << setw(14) << r.prepareMilliseconds
+             << setw(12) << r.memoryBytes / (1024.0*1024.0) << setw(12) << r.meanMicroseconds << setw(12) << r.p50Microseconds << setw(12) << r.p90Microseconds
+             << setw(12) << r.p99Microseconds << setw(12) << r.maxMicroseconds << setprecision(0) << setw(12) << r.meanExpanded << setw(18) << r.routeLengthSum
+             << setw(12) << r.unreachable << setw(12) << r.preempted << setw(12) << r.serialPerSecond << setw(12) << r.batchPerSecond << setw(12) << r.batchMismatches << setw(12) << r.mismatches << endl;
+    }
+    cout << endl;
+
+    cout << left << setw(30) << "congestion repair" << setw(10) << "layout" << right << setw(12) << "nodes" << setw(12) << "batches" << setw(12) << "scores"
+         << setw(14) << "mean us" << setw(14) << "p99 us" << setw(14) << "rebuild ms" << setw(12) << "mismatch" << endl;
+    for (const CongestionResult& c : congestion) {
+        cout << left << setw(30) << "HospitalRouteTree" << setw(10) << c.layout << right << setw(12) << c.intersections << setw(12) << c.batches << setw(12) << c.batchSize
+             << fixed << setprecision(2) << setw(14) << c.meanMicroseconds << setw(14) << c.p99Microseconds << setw(14) << c.rebuildMilliseconds
+             << setw(12) << c.mismatches << endl;
+    }
+
+}
+
+
+/** @fn writeJson(const std::string& filename, const BenchOptions& options, const std::vector<MapResult>& maps, const std::vector<RunResult>& results, const std::vector<CongestionResult>& congestion)
+ *  @brief writes the options and results to a JSON file
+ *  @return bool false if the file could not be written
+ */
+static bool writeJson(const string& filename, const BenchOptions& options, const vector<MapResult>& maps, const vector<RunResult>& results, const vector<CongestionResult>& congestion) {
+
+    ofstream out(filename);
+    if (!out.is_open()) {
+        return false;
+    }
+
+    out << "{\n  \"alerts\": " << options.alerts << ",\n  \"threads\": " << TaskPool::shared()->size() << ",\n  \"hospitals_per_1000\": " << options.hospitalsPerThousand
+        << ",\n  \"seed\": " << options.seed << ",\n  \"maps\": [\n";
+    for (size_t i = 0; i < maps.size(); i++) {
+        const MapResult& m = maps[i];
+        out << "    { \"layout\": \"" << m.layout << "\", \"intersections\": " << m.intersections << ", \"roads\": " << m.roads << ", \"hospitals\": " << m.hospitals
+            << ", \"file_bytes\": " << m.fileBytes << ", \"scan_ms\": " << m.scanMilliseconds << ", \"scan_mb_per_s\": " << (m.scanMilliseconds > 0 ? m.fileBytes / (1024.0*1024.0) / (m.scanMilliseconds / 1000) : 0) << ", \"quick_parse_ms\": " << m.quickMilliseconds << ", \"explicit_parse_ms\": " << m.explicitMilliseconds
+            << ", \"graph_build_ms\": " << m.buildMilliseconds << ", \"graph_bytes\": " << m.bytes << ", \"max_rss_mb\": " << m.maxResidentMegabytes << " }"
+            << (i + 1 < maps.size() ? ",\n" : "\n");
+    }
+    out << "  ],\n  \"results\": [\n";
+    for (size_t i = 0; i < results.size(); i++) {
+        const RunResult& r = results[i];
+        out << "    { \"path_finder\": \"" << r.name << "\", \"layout\": \"" << r.layout << "\", \"intersections\": " << r.intersections << ", \"prepare_ms\": " << r.prepareMilliseconds
+            << ", \"memory_bytes\": " << r.memoryBytes << ", \"mean_us\": " << r.meanMicroseconds << ", \"p50_us\": " << r.p50Microseconds << ", \"p90_us\": " << r.p90Microseconds
+            << ", \"p99_us\": " << r.p99Microseconds << ", \"max_us\": " << r.maxMicroseconds << ", \"mean_expanded\": " << r.meanExpanded << ", \"route_length_sum\": " << r.routeLengthSum
+            << ", \"unreachable\": " << r.unreachable << ", \"preempted\": " << r.preempted << ", \"serial_per_second\": " << r.serialPerSecond
+            << ", \"batch_per_second\": " << r.batchPerSecond << ", \"batch_mismatches\": " << r.batchMismatches << ", \"mismatches\": " << r.mismatches << " }"
+            << (i + 1 < results.size() ? ",\n" : "\n");
+    }
+    out << "  ],\n  \"congestion\": [\n";
+    for (size_t i = 0; i < congestion.size(); i++) {
+        const CongestionResult& c = congestion[i];
+        out << "    { \"layout\": \"" << c.layout << "\", \"intersections\": " << c.intersections << ", \"batches\": " << c.batches << ", \"scores_per_batch\": " << c.batchSize
+            << ", \"mean_us\": " << c.meanMicroseconds << ", \"p99_us\": " << c.p99Microseconds << ", \"rebuild_ms\": " << c.rebuildMilliseconds
+            << ", \"mismatches\": " << c.mismatches << " }" << (i + 1 < congestion.size() ? ",\n" : "\n");
+    }
+    out << "  ]\n}\n";
+
+    return out.good();
+
+}
+
+
+int main(int argc, const char * argv[]) {
+
+    BenchOptions options;
+    if (!parseOptions(argc, argv, options)) {
+        cerr << "usage: bench_routing [-n max_intersections] [-k grid,radial,planar] [-l lengths] [-q alerts] [-h hospitals_per_1000]" << endl
+             << "                     [-s seed] [-t threads] [-b congestion_batches] [-u scores_per_batch] [-o output.json]" << endl;
+        return 1;
+    }
+
+    TaskPool::configureShared(options.threads);
+
+    vector<MapResult> maps;
+    vector<RunResult> results;
+    vector<CongestionResult> congestion;
+    const string cacheFile = options.output + ".ch";
+
+    //maps of about 100, 400, 1600, ... intersections up to the maximum, in every layout
+    for (const string& layout : options.layouts) {
+        for (int wanted = 100; wanted <= options.maxIntersections; wanted *= 4) {
+
+            unordered_map<IntersectionID, Intersection*> intersections;
+            try {
+                maps.push_back(loadMap(layout, wanted, options, intersections));
+            }
+            catch (BaseException& e) {
+                cerr << e.what() << endl;
+                return 1;
+            }
+
+            mt19937 random(options.seed);
+            uniform_int_distribution<int> pick(0, static_cast<int>(intersections.size()) - 1);
+            vector<Intersection*> sources;
+            for (int i = 0; i < options.alerts; i++) {
+                sources.push_back(intersections[IntersectionID(pick(random))]);
+            }
+
+            vector<pair<string, AbstractPathFinder*>> finders = {
+                { "UniformCostSearch", new UniformCostSearch() },
+                { "AStarSearch", new AStarSearch() },
+                { "HospitalRouteTree", new HospitalRouteTree() },
+                { "ContractionHierarchySearch", new ContractionHierarchySearch(cacheFile) },
+                { "ContractionHierarchy cached", new ContractionHierarchySearch(cacheFile) }
+            };
+            remove(cacheFile.c_str());
+
+            //UniformCostSearch goes first, the routes of the others are checked against it
+            vector<float> reference;
+            for (auto& finder : finders) {
+                results.push_back(runAlerts(finder.first, finder.second, intersections, sources, reference));
+                results.back().layout = layout;
+                delete finder.second;
+            }
+
+            congestion.push_back(runCongestion(intersections, options));
+            congestion.back().layout = layout;
+
+            for (auto it = intersections.begin(); it != intersections.end(); ++it) {
+                delete it->second;
+            }
+
+        }
+    }
+
+    remove(cacheFile.c_str());
+    printTable(maps, results, congestion);
+
+    if (!writeJson(options.output, options, maps, results, congestion)) {
+        cerr << "could not write " << options.output << endl;
+    }
+    else {
+        cout << "results written to " << options.output << endl;
+    }
+
+    return 0;
+
+}
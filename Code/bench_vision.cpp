@@ -0,0 +1,422 @@
+//
+//  bench_vision.cpp
+//  TraffikTrak
+//
+//  Created by Matt Lovick on 2026-10-19.
+//  Copyright © 2026 Matt Lovick. All rights reserved.
+//
+
+/*  Benchmark for the computer vision pipeline. Runs a directory of photos through yolo and ProcessedImage
+ *  headlessly and reports where the time of a frame goes:
+ *
+ *      decode          reading and decoding the jpg (per frame)
+ *      preprocess      converting the frame(s) to a blob (per batch)
+ *      forward         running the network (per batch)
+ *      decode-outputs  turning the network output into candidate boxes (per batch)
+ *      nms             non maximum suppression (per batch)
+ *      counting        counting the vehicles per lane (per frame)
+ *
+ *  every combination of batch size (1, 2, 4, ... max) and thread count (1, 2, 4, ... cores) is run, each thread
+ *  owning its own network. results are printed as a table and written as JSON so two builds can be diffed.
+ *
+ *  usage: bench_vision [-p photo_dir] [-w weights] [-cfg config] [-n names] [-s input_size]
+ *                      [-b max_batch] [-t max_threads] [-f frames_per_run] [-o output.json]
+ */
+
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <iomanip>
+#include <string>
+#include <vector>
+#include <map>
+#include <thread>
+#include <mutex>
+#include <atomic>
+#include <chrono>
+#include <algorithm>
+#include "Yolo.hpp"
+#include "ProcessedImage.hpp"
+
+using namespace cv;
+using namespace std;
+using namespace std::chrono;
+
+typedef steady_clock bench_clock;
+
+
+/** @struct BenchOptions
+ *  @brief command line options of the benchmark
+ */
+struct BenchOptions {
+    string photos = "./photos";
+    string weights = "yolov3.weights";
+    string config = "yolov3.cfg";
+    string names = "coco.names";
+    int inputSize = 416;
+    int maxBatch = 4;
+    int maxThreads = max(1, static_cast<int>(thread::hardware_concurrency()));
+    int framesPerRun = 64;
+    string output = "bench_vision.json";
+};
+
+
+/** @struct Distribution
+ *  @brief summary of a set of latency samples in milliseconds
+ */
+struct Distribution {
+    size_t count = 0;
+    double mean = 0;
+    double p50 = 0;
+    double p95 = 0;
+    double p99 = 0;
+    double max = 0;
+};
+
+
+/** @struct RunResult
+ *  @brief result of running the corpus at one batch size and thread count
+ */
+struct RunResult {
+    int threads;
+    int batch;
+    int frames;
+    int skipped; /**< frames whose photo could not be read, left out of the batches and the fps */
+    double seconds;
+    double fps;
+    map<string, Distribution> stages;
+};
+
+
+static const vector<string> STAGES = { "decode", "preprocess", "forward", "decode-outputs", "nms", "counting" };
+
+
+/** @fn percentile(const vector<double>& sorted, double p)
+ *  @brief nearest rank percentile of sorted samples
+ *  @param sorted the samples in ascending order
+ *  @param p the percentile between 0 and 100
+ *  @return double the sample at the percentile
+ */
+static double percentile(const vector<double>& sorted, double p) {
+
+    if (sorted.empty()) {
+        return 0;
+    }
+    size_t rank = static_cast<size_t>(p / 100.0 * (sorted.size() - 1) + 0.5);
+    return sorted[min(rank, sorted.size() - 1)];
+
+}
+
+
+/** @fn summarize(vector<double> samples)
+ *  @brief builds the distribution of a set of samples
+ *  @param samples latency samples in milliseconds
+ *  @return Distribution
+ */
+static Distribution summarize(vector<double> samples) {
+
+    Distribution d;
+    if (samples.empty()) {
+        return d;
+    }
+
+    sort(samples.begin(), samples.end());
+    double sum = 0;
+    for (double s : samples) {
+        sum += s;
+    }
+
+    d.count = samples.size();
+    d.mean = sum / samples.size();
+    d.p50 = percentile(samples, 50);
+    d.p95 = percentile(samples, 95);
+    d.p99 = percentile(samples, 99);
+    d.max = samples.back();
+    return d;
+
+}
+
+
+/** @fn steps(int maximum)
+ *  @brief the values 1, 2, 4, ... up to and always including maximum
+ *  @param maximum the largest value
+ *  @return vector<int>
+ */
+static vector<int> steps(int maximum) {
+
+    vector<int> values;
+    for (int i = 1; i < maximum; i *= 2) {
+        values.push_back(i);
+    }
+    values.push_back(maximum);
+    return values;
+
+}
+
+
+/** @fn parseOptions(int argc, const char* argv[], BenchOptions& options)
+ *  @brief reads the flag/value pairs from the command line
+ *  @return bool whether or not the arguments were valid
+ */
+static bool parseOptions(int argc, const char* argv[], BenchOptions& options) {
+
+    map<string, string*> strings = {
+        { "-p", &options.photos }, { "-w", &options.weights }, { "-cfg", &options.config },
+        { "-n", &options.names }, { "-o", &options.output }
+    };
+    map<string, int*> integers = {
+        { "-s", &options.inputSize }, { "-b", &options.maxBatch }, { "-t", &options.maxThreads }, { "-f", &options.framesPerRun }
+    };
+
+    for (int i = 1; i + 1 < argc; i += 2) {
+
+        string flag = argv[i];
+        if (strings.find(flag) != strings.end()) {
+            *strings[flag] = argv[i+1];
+        }
+        else if (integers.find(flag) != integers.end()) {
+            istringstream ss(argv[i+1]);
+            if (!(ss >> *integers[flag]) || *integers[flag] <= 0) {
+                cerr << "invalid value for " << flag << endl;
+                return false;
+            }
+        }
+        else {
+            cerr << "invalid argument type: " << flag << endl;
+            return false;
+        }
+
+    }
+
+    return argc % 2 == 1;
+
+}
+
+
+/** @fn runCorpus(vector<yolo*>& models, const vector<String>& corpus, int threads, int batch, int frames)
+ *  @brief pushes frames through the pipeline on the given number of threads, each with its own model
+ *  @param models one network per thread
+ *  @param corpus the photo file names, cycled through until enough frames were processed
+ *  @param threads the number of threads
+ *  @param batch the number of frames per forward pass
+ *  @param frames the total number of frames to process
+ *  @return RunResult the throughput and stage distributions of the run
+ */
+static RunResult runCorpus(vector<yolo*>& models, const vector<String>& corpus, int threads, int batch, int frames) {
+
+    atomic<int> nextFrame(0);
+    atomic<int> skipped(0);
+    mutex samplesMutex;
+    map<string, vector<double>> samples;
+
+    auto worker = [&](yolo* model) {
+
+        map<string, vector<double>> local;
+
+        while (true) {
+
+            int first = nextFrame.fetch_add(batch);
+            if (first >= frames) {
+                break;
+            }
+            int last = min(first + batch, frames);
+
+            vector<Mat> images;
+            for (int i = first; i < last; i++) {
+                bench_clock::time_point start = bench_clock::now();
+                Mat image = imread(corpus[i % corpus.size()]);
+                local["decode"].push_back(duration<double, milli>(bench_clock::now() - start).count());
+
+                //an empty image would make the whole batch fail in blobFromImages
+                if (image.empty()) {
+                    skipped++;
+                    continue;
+                }
+                images.push_back(image);
+            }
+            if (images.empty()) {
+                continue;
+            }
+
+            yolo_timings timings;
+            vector<vector<yolo_obj>> results = model->processImages(images, &timings);
+            local["preprocess"].push_back(timings.preprocess);
+            local["forward"].push_back(timings.forward);
+            local["decode-outputs"].push_back(timings.decode);
+            local["nms"].push_back(timings.nms);
+
+            for (const vector<yolo_obj>& objects : results) {
+                bench_clock::time_point start = bench_clock::now();
+                ProcessedImage::countLanes(objects);
+                local["counting"].push_back(duration<double, milli>(bench_clock::now() - start).count());
+            }
+
+        }
+
+        lock_guard<mutex> guard(samplesMutex);
+        for (auto& stage : local) {
+            vector<double>& all = samples[stage.first];
+            all.insert(all.end(), stage.second.begin(), stage.second.end());
+        }
+
+    };
+
+    bench_clock::time_point start = bench_clock::now();
+
+    vector<thread*> workers;
+    for (int i = 0; i < threads; i++) {
+        workers.push_back(new thread(worker, models[i]));
+    }
+    for (thread* t : workers) {
+        t->join();
+        delete t;
+    }
+
+    RunResult result;
+    result.threads = threads;
+    result.batch = batch;
+    result.frames = frames;
+    result.skipped = skipped.load();
+    result.seconds = duration<double>(bench_clock::now() - start).count();
+    result.fps = result.seconds > 0 ? (frames - result.skipped) / result.seconds : 0;
+    for (const string& stage : STAGES) {
+        result.stages[stage] = summarize(samples[stage]);
+    }
+    return result;
+
+}
+
+
+/** @fn printTable(const vector<RunResult>& results)
+ *  @brief prints the p50/p95 of every stage and the throughput of every run
+ */
+static void printTable(const vector<RunResult>& results) {
+
+    cout << left << setw(8) << "threads" << setw(7) << "batch" << setw(10) << "fps";
+    for (const string& stage : STAGES) {
+        cout << setw(20) << (stage + " p50/p95");
+    }
+    cout << endl;
+
+    cout << fixed << setprecision(2);
+    for (const RunResult& r : results) {
+        cout << left << setw(8) << r.threads << setw(7) << r.batch << setw(10) << r.fps;
+        for (const string& stage : STAGES) {
+            const Distribution& d = r.stages.at(stage);
+            ostringstream cell;
+            cell << fixed << setprecision(2) << d.p50 << "/" << d.p95;
+            cout << setw(20) << cell.str();
+        }
+        cout << endl;
+    }
+
+}
+
+
+/** @fn writeJson(const string& filename, const BenchOptions& options, size_t corpusSize, const vector<RunResult>& results)
+ *  @brief writes the results to a JSON file so runs of different builds can be diffed
+ *  @return bool whether or not the file was written
+ */
+static bool writeJson(const string& filename, const BenchOptions& options, size_t corpusSize, const vector<RunResult>& results) {
+
+    ofstream out(filename);
+    if (!out.is_open()) {
+        return false;
+    }
+
+    out << fixed << setprecision(4);
+    out << "{" << endl;
+    out << "  \"corpus\": \"" << options.photos << "\"," << endl;
+    out << "  \"corpus_size\": " << corpusSize << "," << endl;
+    out << "  \"config\": \"" << options.config << "\"," << endl;
+    out << "  \"input_size\": " << options.inputSize << "," << endl;
+    out << "  \"unit\": \"ms\"," << endl;
+    out << "  \"runs\": [" << endl;
+
+    for (size_t i = 0; i < results.size(); i++) {
+
+        const RunResult& r = results[i];
+        out << "    {" << endl;
+        out << "      \"threads\": " << r.threads << ", \"batch\": " << r.batch << ", \"frames\": " << r.frames << ", \"skipped\": " << r.skipped
+            << ", \"seconds\": " << r.seconds << ", \"fps\": " << r.fps << "," << endl;
+        out << "      \"stages\": {" << endl;
+
+        for (size_t j = 0; j < STAGES.size(); j++) {
+            const Distribution& d = r.stages.at(STAGES[j]);
+            out << "        \"" << STAGES[j] << "\": { \"count\": " << d.count << ", \"mean\": " << d.mean << ", \"p50\": " << d.p50
+                << ", \"p95\": " << d.p95 << ", \"p99\": " << d.p99 << ", \"max\": " << d.max << " }"
+                << (j + 1 < STAGES.size() ? "," : "") << endl;
+        }
+
+        out << "      }" << endl;
+        out << "    }" << (i + 1 < results.size() ? "," : "") << endl;
+
+    }
+
+    out << "  ]" << endl;
+    out << "}" << endl;
+    return true;
+
+}
+
+
+int main(int argc, const char * argv[]) {
+
+    BenchOptions options;
+    if (!parseOptions(argc, argv, options)) {
+        cerr << "usage: bench_vision [-p photo_dir] [-w weights] [-cfg config] [-n names] [-s input_size] [-b max_batch] [-t max_threads] [-f frames_per_run] [-o output.json]" << endl;
+        return 1;
+    }
+
+    vector<String> found;
+    glob(options.photos + "/*.jpg", found, true);
+
+    //photos that cannot be decoded are reported and left out, rather than failing every batch they land in
+    vector<String> corpus;
+    for (const String& photo : found) {
+        if (imread(photo).empty()) {
+            cerr << "skipping unreadable photo " << photo << endl;
+        }
+        else {
+            corpus.push_back(photo);
+        }
+    }
+    if (corpus.empty()) {
+        cerr << "no readable photos found in " << options.photos << endl;
+        return 2;
+    }
+
+    //one network per thread, loaded up front so loading the weights is not part of any measurement
+    vector<yolo*> models;
+    for (int i = 0; i < options.maxThreads; i++) {
+        models.push_back(new yolo(options.weights, options.names, options.config, options.inputSize, options.inputSize, 0.30));
+    }
+
+    cout << "corpus: " << corpus.size() << " photos from " << options.photos << ", " << options.framesPerRun << " frames per run" << endl;
+
+    vector<RunResult> results;
+    for (int threads : steps(options.maxThreads)) {
+        for (int batch : steps(options.maxBatch)) {
+            results.push_back(runCorpus(models, corpus, threads, batch, options.framesPerRun));
+            if (results.back().skipped > 0) {
+                cerr << results.back().skipped << " frames skipped at " << threads << " threads, batch " << batch << ": photos could not be read" << endl;
+            }
+        }
+    }
+
+    printTable(results);
+
+    if (!writeJson(options.output, options, corpus.size(), results)) {
+        cerr << "could not write " << options.output << endl;
+    }
+    else {
+        cout << "results written to " << options.output << endl;
+    }
+
+    for (yolo* model : models) {
+        delete model;
+    }
+
+    return 0;
+
+}
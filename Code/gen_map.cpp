@@ -0,0 +1,107 @@
+//
+//  gen_map.cpp
+//  TraffikTrak
+//
+//  Created by Matt Lovick on 2026-10-19.
+//  Copyright © 2026 Matt Lovick. All rights reserved.
+//
+
+/*  Makes up a city map of any size with MapGenerator and writes it in the format of QuickMapFileParser, of
+ *  ExplicitMapFileParser, or both. the map files end with the positions of the intersections and with the hospitals.
+ *
+ *      -n  about how many intersections, the layouts round it to whole rows or rings (10000)
+ *      -k  grid, radial or planar (grid)
+ *      -b  straight distance between neighboring intersections (50)
+ *      -h  hospitals per 1000 intersections, there is always at least one (2)
+ *      -l  road lengths: straight[:detour], uniform:min:max or exponential:min:mean (straight:1.5)
+ *      -r  planar only, the share of the roads outside the spanning tree that are kept (0.6)
+ *      -s  seed (42)
+ *      -q  file to write in the QuickMapFileParser format
+ *      -e  file to write in the ExplicitMapFileParser format
+ *
+ *  usage: gen_map [-n intersections] [-k layout] [-b block_length] [-h hospitals_per_1000] [-l lengths] [-r kept_roads]
+ *                 [-s seed] [-q quick_map.txt] [-e explicit_map.txt]
+ */
+
+#include <iostream>
+#include <string>
+#include <cstdlib>
+#include <algorithm>
+#include "MapGenerator.hpp"
+
+using namespace std;
+
+
+int main(int argc, const char * argv[]) {
+
+    MapGenerator::Settings settings;
+    string quick, explicitIDs;
+    bool valid = true;
+
+    for (int i = 1; i < argc && valid; i++) {
+
+        string flag = argv[i];
+        if (i + 1 >= argc) {
+            valid = false;
+            break;
+        }
+        string value = argv[++i];
+
+        if (flag == "-n") {
+            settings.intersections = max(4, atoi(value.c_str()));
+        }
+        else if (flag == "-k") {
+            valid = MapGenerator::parseLayout(value, settings.layout);
+        }
+        else if (flag == "-b") {
+            settings.blockLength = static_cast<float>(atof(value.c_str()));
+            valid = settings.blockLength > 0;
+        }
+        else if (flag == "-h") {
+            settings.hospitalsPerThousand = max(0, atoi(value.c_str()));
+        }
+        else if (flag == "-l") {
+            valid = MapGenerator::parseLengths(value, settings);
+        }
+        else if (flag == "-r") {
+            settings.keptRoads = static_cast<float>(atof(value.c_str()));
+            valid = settings.keptRoads >= 0 && settings.keptRoads <= 1;
+        }
+        else if (flag == "-s") {
+            settings.seed = static_cast<unsigned>(atoi(value.c_str()));
+        }
+        else if (flag == "-q") {
+            quick = value;
+        }
+        else if (flag == "-e") {
+            explicitIDs = value;
+        }
+        else {
+            valid = false;
+        }
+
+    }
+
+    if (!valid || (quick.empty() && explicitIDs.empty())) {
+        cerr << "usage: gen_map [-n intersections] [-k grid|radial|planar] [-b block_length] [-h hospitals_per_1000]" << endl
+             << "               [-l straight[:detour]|uniform:min:max|exponential:min:mean] [-r kept_roads] [-s seed]" << endl
+             << "               [-q quick_map.txt] [-e explicit_map.txt]" << endl;
+        return 1;
+    }
+
+    MapGenerator generator(settings);
+    generator.generate();
+
+    if (!quick.empty() && !generator.writeQuick(quick)) {
+        cerr << "could not write " << quick << endl;
+        return 1;
+    }
+    if (!explicitIDs.empty() && !generator.writeExplicit(explicitIDs)) {
+        cerr << "could not write " << explicitIDs << endl;
+        return 1;
+    }
+
+    cout << generator.size() << " intersections, " << generator.roads() << " roads, " << generator.hospitals().size() << " hospitals" << endl;
+    return 0;
+
+}
@@ -47,6 +47,24 @@
 #include <sstream>
 #include <time.h>
 
+//Evaluation mode
+#include "DatasetEvaluator.hpp"
+#include "IOException.hpp"
+
+//Test case 6
+#include <thread>
+#include <atomic>
+#include <algorithm>
+
+//Test case 11
+#include <sys/resource.h>
+#include "IntersectionExecutor.hpp"
+
+//Test case 12
+#include <random>
+#include "FrameQualityGate.hpp"
+#include "FrameQuality.h"
+
 
 using namespace cv;
 using namespace dnn;
@@ -55,9 +73,51 @@ using namespace std::chrono;
 using namespace traffictrack;
 
 
+/** @fn printFrameCounters(const Controller::FrameCounters& frames)
+ *  @brief prints how many camera frames the quality gates checked and why the skipped ones were skipped
+ */
+static void printFrameCounters(const Controller::FrameCounters& frames) {
+    
+    cout << "Frames: " << frames.checked << " checked | " << frames.skipped << " skipped (unreadable " << frames.skippedFor[FrameQuality::UNREADABLE]
+         << ", blank " << frames.skippedFor[FrameQuality::BLANK] << ", dark " << frames.skippedFor[FrameQuality::UNDEREXPOSED]
+         << ", bright " << frames.skippedFor[FrameQuality::OVEREXPOSED] << ", blurry " << frames.skippedFor[FrameQuality::BLURRY]
+         << ", frozen " << frames.skippedFor[FrameQuality::FROZEN] << ")" << endl;
+    
+}
+
+
 int main(int argc, const char * argv[]) {
     
     
+    /*  Evaluation mode: computerVision --evaluate <directory> [output.csv]
+     *  processes every photo in the directory tree on all cores without opening any windows, writes the counts and
+     *  timings of every photo to a CSV file (evaluation.csv by default) and prints the aggregate throughput
+     */
+    if ((argc == 3 || argc == 4) && string(argv[1]) == "--evaluate") {
+        
+        string directory = argv[2];
+        string csvFile = argc == 4 ? argv[3] : "evaluation.csv";
+        
+        try {
+            DatasetEvaluator evaluator;
+            DatasetEvaluator::Summary summary = evaluator.evaluate(directory, csvFile);
+            
+            cout << "Images: " << summary.images << " (" << summary.unreadable << " unreadable)" << endl;
+            cout << "Vehicles: " << summary.vehicles << endl;
+            cout << "Wall time: " << summary.seconds << " s" << endl;
+            cout << "Throughput: " << summary.imagesPerSecond << " images/s" << endl;
+            cout << "Mean latency: " << summary.meanLatency << " ms" << endl;
+            cout << "Results written to " << csvFile << endl;
+        }
+        catch (IOException& e) {
+            cerr << e.what() << endl;
+            exit(3);
+        }
+        
+        return 0;
+        
+    }
+    
     if (argc != 2) {
         cout << "invalid arguments" << endl;
         exit(1);
@@ -264,6 +324,7 @@ int main(int argc, const char * argv[]) {
             if (controller->initialize(11, args)) {
                 controller->run();
                 getchar();
+                printFrameCounters(controller->frameCounters());
                 controller->stop();
             }
             
@@ -371,6 +432,530 @@ int main(int argc, const char * argv[]) {
         k = waitKey(0);
         destroyWindow("Display WestImage");
     }
+
+    /*  Test 6: processes photos for every intersection on map.txt at the same time, one thread per intersection
+     *          build with -DTRAFFICTRACK_TSAN=ON to run it under ThreadSanitizer
+     *
+     *  prints the number of congestion scores that differed from processing the same photos one intersection at a time
+     */
+    else if (testCaseNumber == 6) {
+        
+        cout << "====================================================" << endl;
+        cout << "        Test Case 6: Concurrent Computer Vision" << endl;
+        cout << "====================================================" << endl;
+        
+        /*
+         Expected Results:
+            every intersection is given a fixed set of 4 photos, processed once serially to get the expected scores
+            then all intersections process their photos in parallel for several rounds
+            every parallel score must equal the serial score, and ThreadSanitizer (if enabled) must not report any data race
+         
+         sample output:
+         Intersections: 9 | Rounds: 3 | Mismatched scores: 0
+         PASSED
+         
+         */
+        
+        const int rounds = 3;
+        
+        unordered_map<IntersectionID, Intersection*> intersections;
+        AbstractMapFileParser* parser = new QuickMapFileParser();
+        parser->parse("map.txt", intersections);
+        
+        vector<String> photos;
+        glob("./photos/*.jpg", photos, false);
+        sort(photos.begin(), photos.end());
+        
+        if (photos.empty()) {
+            cout << "no photos found in ./photos" << endl;
+        }
+        else {
+            
+            auto photosFor = [&](IntersectionID id) {
+                vector<String> p;
+                for (int i = 0; i < 4; i++) {
+                    p.push_back(photos[(4*static_cast<int>(id) + i) % photos.size()]);
+                }
+                return p;
+            };
+            
+            auto sameScore = [](const CongestionScore& a, const CongestionScore& b) {
+                return a.getNorth() == b.getNorth() && a.getSouth() == b.getSouth() && a.getEast() == b.getEast() && a.getWest() == b.getWest();
+            };
+            
+            //expected scores, one intersection at a time
+            unordered_map<IntersectionID, CongestionScore> expected;
+            for (auto& element : intersections) {
+                vector<String> p = photosFor(element.first);
+                expected[element.first] = ProcessedImage(p[0], p[1], p[2], p[3]).carCount().second;
+            }
+            
+            //all intersections at once
+            atomic<int> mismatches(0);
+            vector<thread*> threads;
+            for (auto& element : intersections) {
+                IntersectionID id = element.first;
+                threads.push_back(new thread([&, id]() {
+                    vector<String> p = photosFor(id);
+                    for (int round = 0; round < rounds; round++) {
+                        ProcessedImage data(p[0], p[1], p[2], p[3]);
+                        if (!sameScore(data.carCount().second, expected.at(id))) {
+                            mismatches++;
+                        }
+                    }
+                }));
+            }
+            for (thread* t : threads) {
+                t->join();
+                delete t;
+            }
+            
+            cout << "Intersections: " << intersections.size() << " | Rounds: " << rounds << " | Mismatched scores: " << mismatches << endl;
+            cout << (mismatches == 0 ? "PASSED" : "FAILED") << endl;
+            
+        }
+        
+        for (auto& element : intersections) {
+            delete element.second;
+        }
+        delete parser;
+        
+    }
+    
+    /*  Test 7: runs the program and sends emergency vehicle alerts at a steady rate while the controller is otherwise idle
+     *
+     *  prints how long the alerts waited before the controller thread picked them up
+     */
+    else if (testCaseNumber == 7) {
+        
+        cout << "====================================================" << endl;
+        cout << "      Test Case 7: Emergency Alert Wake Latency" << endl;
+        cout << "====================================================" << endl;
+        
+        /*
+         Expected Results:
+            the controller thread sleeps until a request arrives, so every alert is picked up within tens of microseconds
+            (hundreds on a loaded machine) instead of depending on how busy the request loop is
+         
+         sample output:
+         Alerts: 200 | Mean wake latency: 18.4 us | Max wake latency: 97 us
+         
+         */
+        
+        const int alerts = 200;
+        
+        const char** args = (const char**) malloc(sizeof(char*)*11);
+        args[0] = strdup(argv[0]);
+        args[1] = strdup("-c");
+        args[2] = strdup("config.txt");
+        args[3] = strdup("-m");
+        args[4] = strdup("map.txt");
+        args[5] = strdup("-cp");
+        args[6] = strdup("QuickDatabaseConfigParser");
+        args[7] = strdup("-mp");
+        args[8] = strdup("QuickMapFileParser");
+        args[9] = strdup("-sa");
+        args[10] = strdup("UniformCostSearch");
+        
+        Controller* controller = Controller::instance();
+        if (controller != nullptr) {
+            
+            if (controller->initialize(11, args)) {
+                controller->run();
+                
+                //let the controller go idle, then alert at a steady rate
+                //the alerts come from the hospital (intersection 0) so no lights are preempted and only the wake up is measured
+                this_thread::sleep_for(seconds(2));
+                for (int i = 0; i < alerts; i++) {
+                    controller->alertEmergencyVehicle(IntersectionID(0));
+                    this_thread::sleep_for(milliseconds(5));
+                }
+                this_thread::sleep_for(seconds(1));
+                
+                Controller::WakeLatency latency = controller->emergencyWakeLatency();
+                cout << "Alerts: " << latency.alerts << " | Mean wake latency: " << latency.meanMicroseconds << " us | Max wake latency: " << latency.maxMicroseconds << " us" << endl;
+                
+                controller->stop();
+            }
+            
+            delete controller;
+            
+        }
+        
+        for (int i = 0; i < 11; i++) {
+            delete args[i];
+        }
+        delete args;
+        
+    }
+    
+    /*  Test 8: runs the program and floods the controller's request queues from several threads at once
+     *
+     *  prints the queue counters, every alert must be handled even if the alert ring overflowed
+     */
+    else if (testCaseNumber == 8) {
+        
+        cout << "====================================================" << endl;
+        cout << "         Test Case 8: Request Queue Flood" << endl;
+        cout << "====================================================" << endl;
+        
+        /*
+         Expected Results:
+            the producers never wait for the controller thread. scores beyond the capacity of the data queue are dropped and
+            counted. the alert ring holds the whole burst, so no alert is dropped and every one is handled. the scores that were not
+            dropped are written in batches on the shared pool
+         
+         sample output:
+         Producer time: 6.0 ms
+         Scores: 8000 queued | 3635 dropped
+         Alerts: 800 queued | 0 dropped | 800 handled
+         Log batches: 18 | Mean queue wait: 21.3 us | Mean write: 190.4 us | Max write: 402 us | Deepest queue: 2 | Dropped scores: 0
+         
+         */
+        
+        const int producers = 8;
+        const int scoresPerProducer = 1000;
+        const int alertsPerProducer = 100;
+        
+        const char** args = (const char**) malloc(sizeof(char*)*11);
+        args[0] = strdup(argv[0]);
+        args[1] = strdup("-c");
+        args[2] = strdup("config.txt");
+        args[3] = strdup("-m");
+        args[4] = strdup("map.txt");
+        args[5] = strdup("-cp");
+        args[6] = strdup("QuickDatabaseConfigParser");
+        args[7] = strdup("-mp");
+        args[8] = strdup("QuickMapFileParser");
+        args[9] = strdup("-sa");
+        args[10] = strdup("UniformCostSearch");
+        
+        Controller* controller = Controller::instance();
+        if (controller != nullptr) {
+            
+            if (controller->initialize(11, args)) {
+                controller->run();
+                this_thread::sleep_for(seconds(2));
+                
+                CongestionScore score;
+                score.setNorth(1, 1, 1);
+                score.setEast(1, 1, 1);
+                score.setSouth(1, 1, 1);
+                score.setWest(1, 1, 1);
+                time_t now = time(NULL);
+                DateScorePair data(ctime(&now), score);
+                
+                //alerts come from the hospital so no lights are preempted
+                steady_clock::time_point start = steady_clock::now();
+                vector<thread> threads;
+                for (int p = 0; p < producers; p++) {
+                    threads.push_back(thread([&]() {
+                        for (int i = 0; i < scoresPerProducer; i++) {
+                            controller->logScore(IntersectionID(0), data);
+                            if (i % (scoresPerProducer / alertsPerProducer) == 0) {
+                                controller->alertEmergencyVehicle(IntersectionID(0));
+                            }
+                        }
+                    }));
+                }
+                for (thread& t : threads) {
+                    t.join();
+                }
+                double producerTime = duration<double, milli>(steady_clock::now() - start).count();
+                this_thread::sleep_for(seconds(2));
+                
+                MpscQueueCounters scores = controller->dataRequestCounters();
+                MpscQueueCounters alerts = controller->emergencyAlertCounters();
+                cout << "Producer time: " << producerTime << " ms" << endl;
+                cout << "Scores: " << scores.enqueued + scores.dropped << " queued | " << scores.dropped << " dropped" << endl;
+                cout << "Alerts: " << alerts.enqueued + alerts.dropped << " queued | " << alerts.dropped << " dropped | " << controller->emergencyWakeLatency().alerts << " handled" << endl;
+                
+                TaskPool::Metrics logs = controller->logMetrics();
+                cout << "Log batches: " << logs.tasks << " | Mean queue wait: " << logs.meanWaitMicroseconds << " us | Mean write: " << logs.meanRunMicroseconds << " us | Max write: " << logs.maxRunMicroseconds << " us | Deepest queue: " << logs.maxQueued << " | Dropped scores: " << controller->droppedLogScores() << endl;
+                printFrameCounters(controller->frameCounters());
+                
+                controller->stop();
+            }
+            
+            delete controller;
+            
+        }
+        
+        for (int i = 0; i < 11; i++) {
+            delete args[i];
+        }
+        delete args;
+        
+    }
+    
+    /*  Test 9: logs the same congestion scores into the database one at a time and in batches
+     *
+     *  prints the logging throughput of both
+     */
+    else if (testCaseNumber == 9) {
+        
+        cout << "====================================================" << endl;
+        cout << "          Test Case 9: Database Log Batching" << endl;
+        cout << "====================================================" << endl;
+        
+        /*
+         Expected Results:
+            logBatch takes each lock once per batch instead of once per score, and both log well over 100k scores per second
+         
+         sample output:
+         log(): 100000 scores in 97.6 ms (1024108 scores/s)
+         logBatch(): 100000 scores in 78.7 ms (1269977 scores/s)
+         
+         */
+        
+        const int intersectionCount = 8;
+        const int scores = 100000;
+        const size_t batchSize = 256;
+        
+        unordered_map<IntersectionID, Intersection*> intersections;
+        for (int i = 0; i < intersectionCount; i++) {
+            Intersection* intersection = new Intersection(IntersectionID(i));
+            intersections[intersection->ID()] = intersection;
+        }
+        
+        AbstractTrafficDatabase::l_seconds timeBetweenSaves = seconds(20);
+        TimeBlock numberOfTimeBlocks(3);
+        TempFile temp("temp_file");
+        DatabaseLocation location("TestDatabase");
+        PredictionLevel level(1);
+        
+        AbstractTrafficDatabase* database = TrafficDatabase::create(intersections, timeBetweenSaves, numberOfTimeBlocks, temp, location, level);
+        
+        CongestionScore score;
+        score.setNorth(10, 10, 10);
+        score.setEast(10, 10, 10);
+        score.setSouth(10, 10, 10);
+        score.setWest(10, 10, 10);
+        
+        //one score per intersection every few seconds, spread over several time blocks
+        vector<AbstractTrafficDatabase::LogRecord> records;
+        records.reserve(scores);
+        time_t now = time(NULL);
+        char buffer[32];
+        for (int i = 0; i < scores; i++) {
+            time_t stamp = now + (i / intersectionCount) * 3;
+            records.push_back(make_pair(IntersectionID(i % intersectionCount), DateScorePair(ctime_r(&stamp, buffer), score)));
+        }
+        
+        steady_clock::time_point start = steady_clock::now();
+        int logged = 0;
+        for (const AbstractTrafficDatabase::LogRecord& record : records) {
+            if (database->log(record.first, record.second)) {
+                logged++;
+            }
+        }
+        double single = duration<double, milli>(steady_clock::now() - start).count();
+        cout << "log(): " << logged << " scores in " << single << " ms (" << static_cast<long>(logged / (single / 1000)) << " scores/s)" << endl;
+        
+        vector<vector<AbstractTrafficDatabase::LogRecord>> batches;
+        for (size_t i = 0; i < records.size(); i += batchSize) {
+            batches.push_back(vector<AbstractTrafficDatabase::LogRecord>(records.begin() + i, records.begin() + min(records.size(), i + batchSize)));
+        }
+        
+        start = steady_clock::now();
+        logged = 0;
+        for (const vector<AbstractTrafficDatabase::LogRecord>& batch : batches) {
+            logged += database->logBatch(batch);
+        }
+        double batched = duration<double, milli>(steady_clock::now() - start).count();
+        cout << "logBatch(): " << logged << " scores in " << batched << " ms (" << static_cast<long>(logged / (batched / 1000)) << " scores/s)" << endl;
+        
+        delete database;
+        for (auto& element : intersections) {
+            delete element.second;
+        }
+        
+    }
+    
+    /*  Test 10: runs several intersections with short light intervals while their cameras keep the inference workers busy
+     *
+     *  prints a histogram of how late the scheduled light changes started
+     */
+    else if (testCaseNumber == 10) {
+        
+        cout << "====================================================" << endl;
+        cout << "          Test Case 10: Light Phase Jitter" << endl;
+        cout << "====================================================" << endl;
+        
+        /*
+         Expected Results:
+            the light changes run on their own deadlines, independent of the photo processing loop, so they start within a
+            millisecond or two of when they are due
+         
+         sample output:
+         count 63 | mean 830.8 us | p50 512 us | p99 2605 us | max 2605 us
+           [64, 128) us: 11
+           [128, 256) us: 20
+           [256, 512) us: 14
+           [2048, 4096) us: 18
+         
+         */
+        
+        const int intersectionCount = 9;
+        
+        vector<Intersection*> intersections;
+        for (int i = 0; i < intersectionCount; i++) {
+            Intersection* intersection = new Intersection(IntersectionID(i));
+            intersection->updateLightSchedule(seconds(2), seconds(2));
+            intersections.push_back(intersection);
+        }
+        
+        Intersection::phaseJitter().reset();
+        for (Intersection* intersection : intersections) {
+            intersection->run();
+        }
+        
+        this_thread::sleep_for(seconds(40));
+        
+        for (Intersection* intersection : intersections) {
+            intersection->stop();
+        }
+        
+        Intersection::phaseJitter().print(cout);
+        
+        for (Intersection* intersection : intersections) {
+            delete intersection;
+        }
+        
+    }
+    
+    /*  Test 11: runs 10,000 intersections multiplexed onto one shared thread per core instead of a thread each
+     *
+     *  prints how many light changes ran, how late they started and the peak memory of the process
+     */
+    else if (testCaseNumber == 11) {
+        
+        cout << "====================================================" << endl;
+        cout << "        Test Case 11: Sharded Intersections" << endl;
+        cout << "====================================================" << endl;
+        
+        /*
+         Expected Results:
+            the number of threads stays fixed, every intersection changes its lights on time and the memory stays bounded,
+            since each intersection has at most one cycle of photos in flight
+         
+         sample output:
+         Intersections: 10000 on 4 shards
+         Threads:	4
+         count 70000 | mean 10463.6 us | p50 16384 us | p99 35648 us | max 35648 us
+         Peak memory: 64 MB
+         
+            (one core, every intersection starts at the same moment so their changes are due in bursts of 10,000)
+         
+         */
+        
+        const int intersectionCount = 10000;
+        
+        IntersectionExecutor* executor = new IntersectionExecutor();
+        
+        vector<Intersection*> intersections;
+        for (int i = 0; i < intersectionCount; i++) {
+            Intersection* intersection = new Intersection(IntersectionID(i));
+            intersection->updateLightSchedule(seconds(2), seconds(2));
+            intersections.push_back(intersection);
+        }
+        
+        Intersection::phaseJitter().reset();
+        for (Intersection* intersection : intersections) {
+            intersection->runSharded(executor);
+        }
+        
+        this_thread::sleep_for(seconds(20));
+        
+        cout << "Intersections: " << intersectionCount << " on " << executor->shards() << " shards" << endl;
+        ifstream status("/proc/self/status");
+        string line;
+        while (getline(status, line)) {
+            if (line.compare(0, 8, "Threads:") == 0) {
+                cout << line << endl;
+            }
+        }
+        
+        for (Intersection* intersection : intersections) {
+            intersection->stop();
+        }
+        
+        Intersection::phaseJitter().print(cout);
+        
+        struct rusage usage;
+        getrusage(RUSAGE_SELF, &usage);
+        cout << "Peak memory: " << usage.ru_maxrss / 1024 << " MB" << endl;
+        
+        for (Intersection* intersection : intersections) {
+            delete intersection;
+        }
+        delete executor;
+        
+    }
+    
+    /*  Test 12: sends a camera's quality gate the same scene with a little sensor noise, then the exact same frame again and again
+     *
+     *  prints how many frames of each were flagged FROZEN
+     */
+    else if (testCaseNumber == 12) {
+        
+        cout << "====================================================" << endl;
+        cout << "          Test Case 12: Frozen Camera Check" << endl;
+        cout << "====================================================" << endl;
+        
+        /*
+         Expected Results:
+            a working camera on a quiet road sees the same scene every frame, but its sensor noise changes some pixels, so
+            none of its frames are frozen. a camera that resends one frame is frozen from the third frame on
+         
+         sample output:
+         Static scene with sensor noise: 30 frames | 0 frozen
+         Repeated frame: 30 frames | 28 frozen
+         PASSED
+         
+         */
+        
+        const int frames = 30;
+        
+        vector<String> photos;
+        glob("./photos/*.jpg", photos, false);
+        sort(photos.begin(), photos.end());
+        Mat scene = photos.empty() ? Mat() : imread(photos.front());
+        
+        if (scene.empty()) {
+            cout << "no photos found in ./photos" << endl;
+        }
+        else {
+            
+            //noise with a standard deviation of 2 levels, about what a camera sensor adds in daylight
+            mt19937 random(12);
+            normal_distribution<float> sensor(0, 2);
+            FrameQualityGate live;
+            int liveFrozen = 0;
+            for (int i = 0; i < frames; i++) {
+                Mat frame = scene.clone();
+                for (int row = 0; row < frame.rows; row++) {
+                    unsigned char* pixels = frame.ptr<unsigned char>(row);
+                    for (int col = 0; col < frame.cols * frame.channels(); col++) {
+                        pixels[col] = saturate_cast<unsigned char>(pixels[col] + sensor(random));
+                    }
+                }
+                liveFrozen += live.check(frame) == FrameQuality::FROZEN ? 1 : 0;
+            }
+            
+            FrameQualityGate stuck;
+            int stuckFrozen = 0;
+            for (int i = 0; i < frames; i++) {
+                stuckFrozen += stuck.check(scene) == FrameQuality::FROZEN ? 1 : 0;
+            }
+            
+            cout << "Static scene with sensor noise: " << frames << " frames | " << liveFrozen << " frozen" << endl;
+            cout << "Repeated frame: " << frames << " frames | " << stuckFrozen << " frozen" << endl;
+            cout << (liveFrozen == 0 && stuckFrozen == frames - 2 ? "PASSED" : "FAILED") << endl;
+            
+        }
+        
+    }
         
     return 0;
     